@@ -25,6 +25,7 @@
 #ifndef ATOMS_H_
 #define ATOMS_H_
 
+#include <stdint.h>
 #include <string>
 #include <vector>
 
@@ -100,11 +101,13 @@ namespace atoms
 	extern std::vector <int> category_array;
 	extern std::vector <int> grain_array;
 	extern std::vector <int> cell_array;
+	extern std::vector <uint32_t> uniaxial_anisotropy_axis_array; /// Encoded local easy axes (see vmath::encode_unit_vector)
 
 	extern std::vector <double> x_spin_array;
 	extern std::vector <double> y_spin_array;
 	extern std::vector <double> z_spin_array;
    extern std::vector <double> m_spin_array; /// Array of atomic spin moments
+   extern std::vector <double> interleaved_spin_array; /// Interleaved (x,y,z,w) copy of spins for exchange calculation
 
 	extern std::vector <double> x_total_spin_field_array;		/// Total spin dependent fields
 	extern std::vector <double> y_total_spin_field_array;		/// Total spin dependent fields
@@ -68,6 +68,7 @@ namespace cs{
 	extern bool SelectMaterialByGeometry;
 	extern unsigned int total_num_unit_cells[3];
 	extern unsigned int local_num_unit_cells[3];
+	extern std::vector<int> unit_cell_index_array; /// Unit cell coordinates and site of each atom (4 per atom) for spin tiling
 	extern std::string crystal_structure;
 
 	// System Parameters
@@ -447,6 +448,12 @@ void generate_multilayers(std::vector<cs::catom_t> & catom_array);
 
   // unit cell initialisation function
   void unit_cell_set(cs::unit_cell_t &);
+
+  // resource estimator for dry runs
+  void estimate_resources(const int num_ranks);
+
+  // system dimensions for weak scaling benchmark
+  void weak_scaling_dimensions(const int num_processors);
   
 }
 
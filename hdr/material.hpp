@@ -120,6 +120,8 @@ using std::string;
       double Klatt; /// normalised lattice anisotropy
       std::vector<double> KuVec; /// normalised anisotropy tensor
 		std::vector<double> UniaxialAnisotropyUnitVector; /// unit vector for material uniaxial anisotropy
+		double UniaxialAnisotropyDispersion; /// standard deviation of easy axis angle about UniaxialAnisotropyUnitVector (radians)
+		bool UniaxialAnisotropyDispersionPerGrain; /// disperse easy axes per grain (true) or per atom (false)
 		double Kc1_SI;
 		double Kc2_SI;
 		double Kc;
@@ -166,6 +168,14 @@ using std::string;
 		bool fill; /// flag to determine of material fills voided space
       double temperature_rescaling_alpha; // temperature rescaling exponent
       double temperature_rescaling_Tc; // temperaure rescaling Tc
+      double interaction_rescaling_Tc; // Curie temperature of fitted m(T) for rescaled interactions
+      double interaction_rescaling_temperature_exponent; // exponent a in m(T) = (1-(T/Tc)^a)^b
+      double interaction_rescaling_critical_exponent; // exponent b in m(T) = (1-(T/Tc)^a)^b
+      double exchange_rescaling_exponent; // exchange scales as m(T)^exponent
+      double anisotropy_rescaling_exponent; // anisotropy scales as m(T)^exponent
+      double stt_efficiency; // spin transfer torque efficiency (spin polarisation)
+      double stt_field_like_ratio; // ratio of field-like to damping-like torque
+      std::vector<double> stt_polarization_unit_vector; // spin polarisation direction of current
      lattice_anis_t lattice_anisotropy; // class containing lattice anisotropy data
 		
 		materials_t();
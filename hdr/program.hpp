@@ -46,6 +46,9 @@ namespace program
    extern void lagrange_multiplier();
    extern void localised_temperature_pulse();
    extern void effective_damping();
+   extern void scaling_benchmark();
+   extern void forward_flux_sampling();
+   extern void spin_waves();
 
 	// Sundry programs and diagnostics not under general release
 	extern int LLB_Boltzmann();
@@ -28,6 +28,7 @@
 //Headers
 #include <fstream>
 #include <stdint.h>
+#include <string>
 #include <valarray>
 #include <vector>
 
@@ -83,6 +84,8 @@ namespace sim{
 	extern double mc_delta_angle; /// Tuned angle for Monte Carlo trial move
 	enum mc_algorithms { spin_flip, uniform, angle, hinzke_nowak};
    extern mc_algorithms mc_algorithm; /// Selected algorith for Monte Carlo simulations
+   enum mc_sweep_orders { random_sites, random_blocks, checkerboard_blocks};
+   extern mc_sweep_orders mc_sweep_order; /// Order of trial moves in a Monte Carlo step
 
 	extern double head_position[2];
 	extern double head_speed;
@@ -126,6 +129,7 @@ namespace sim{
 	extern bool CubicScalarAnisotropy; // Enables scalar cubic anisotropy
 	extern bool EnableUniaxialAnisotropyUnitVector; /// enables anisotropy tensor if any material has non z-axis K
   extern bool lattice_anisotropy_flag; /// Enables lattice anisotropy
+   extern bool local_anisotropy_axis; /// Enables per-atom uniaxial anisotropy easy axes
 
 	// Local system variables
 	extern bool local_temperature; /// flag to enable material specific temperature
@@ -139,6 +143,103 @@ namespace sim{
    extern bool save_checkpoint_continuous_flag; // save checkpoints during simulations
    extern int save_checkpoint_rate; // Default increment between checkpoints
 
+   // Spin tile flags and variables
+   extern bool save_spin_tile_flag; // Save spin tile at end of simulation
+   extern bool load_spin_tile_flag; // Initialise spins by tiling a saved spin tile
+   extern bool spin_tile_random_shift; // Shift each tile by a random lattice translation
+   extern std::string spin_tile_file; // Name of spin tile file
+
+   extern bool release_creation_arrays; // Release creation-only atomic arrays (coordinates, category) after initialisation
+   extern bool interleaved_spin_layout; // Use interleaved (xyzw) spin data in exchange calculation
+
+   // Double buffered thermal noise
+   extern bool buffered_thermal_noise; // Use precomputed thermal noise buffers
+   extern const std::vector<double>& get_thermal_noise();
+   extern void produce_thermal_noise();
+   extern void advance_thermal_noise();
+
+   // Live run telemetry
+   extern bool telemetry; // Write periodic status file
+   extern int telemetry_rate; // Time steps between status updates
+   extern std::string telemetry_file; // Name of status file
+   extern void set_telemetry_stage(std::string, uint64_t);
+   extern void update_telemetry();
+   extern double wall_time();
+
+   extern bool weak_scaling; // Scale system size with number of processors in scaling benchmark
+
+   // Forward flux sampling parameters
+   extern double ffs_basin_boundary; // Order parameter boundary of initial state A
+   extern double ffs_first_interface; // Order parameter of first interface
+   extern double ffs_last_interface; // Order parameter of last interface (final state B)
+   extern int ffs_num_interfaces; // Number of interfaces including first and last
+   extern int ffs_num_configurations; // Number of configurations stored at first interface
+   extern int ffs_num_trials; // Number of trial trajectories per interface
+   extern uint64_t ffs_maximum_trial_time; // Maximum time steps per trial trajectory
+   extern int ffs_order_parameter_material; // Material for order parameter, -1 = system
+
+   // Spin wave eigenmode parameters
+   extern int spin_wave_num_modes; // Number of lowest frequency modes to calculate
+   extern int spin_wave_lanczos_steps; // Maximum number of Lanczos steps, 0 = automatic
+   extern double spin_wave_tolerance; // Relative residual tolerance of linear solver
+
+   // Graceful checkpoint and exit
+   extern double walltime; // Wall time limit for simulation (s), 0 = no limit
+   extern const int resumable_exit_code; // Exit code for resumable termination
+   extern void initialise_graceful_exit();
+   extern void enable_graceful_exit();
+   extern void check_graceful_exit();
+   extern void poll_graceful_exit();
+
+   // Temperature rescaled exchange and anisotropy
+   extern bool interaction_rescaling; // Enable temperature rescaled exchange and anisotropy
+   extern bool uniform_exchange_rescaling; // Flag if all materials have the same exchange scaling
+   extern std::vector<double> exchange_rescaling; // Exchange scaling factor per material
+   extern std::vector<double> exchange_rescaling_root; // Square root of exchange scaling factor per material
+   extern std::vector<double> anisotropy_rescaling; // Anisotropy scaling factor per material
+   extern void initialise_interaction_rescaling();
+   extern void update_interaction_rescaling();
+
+   // Fused uniaxial anisotropy
+   extern bool fused_uniaxial_anisotropy; // Evaluate all uniaxial anisotropy terms in a single pass
+   extern bool fused_first_order_anisotropy; // Include first order anisotropy in the single pass
+   extern std::vector<double> fused_uniaxial_anisotropy_coefficients; // c1, c3, c5 and easy axis per material
+   extern void initialise_fused_uniaxial_anisotropy();
+   extern void update_fused_uniaxial_anisotropy();
+
+   // Spin transfer torque
+   extern bool spin_transfer_torque; // Flag to enable spin transfer torque in LLG integrators
+   extern double stt_current_density; // Current density (A/m^2)
+   extern std::vector<double> stt_relaxation_torque; // Damping-like coefficient a_j per material (T)
+   extern std::vector<double> stt_precession_torque; // Field-like coefficient b_j per material (T)
+   extern std::vector<double> stt_polarization_unit_vector; // Polarisation direction per material (3 per material)
+   extern void initialise_spin_transfer_torque();
+   extern void update_spin_transfer_torque();
+
+   //-----------------------------------------------------------------------------
+   // Function to add spin transfer torque field a_j (S x p) + b_j p to local field
+   //-----------------------------------------------------------------------------
+   inline void add_stt_field(const int imaterial, const double S[3], double H[3]){
+      const double aj=sim::stt_relaxation_torque[imaterial];
+      const double bj=sim::stt_precession_torque[imaterial];
+      const double* p=&sim::stt_polarization_unit_vector[3*imaterial];
+      H[0]+=aj*(S[1]*p[2]-S[2]*p[1])+bj*p[0];
+      H[1]+=aj*(S[2]*p[0]-S[0]*p[2])+bj*p[1];
+      H[2]+=aj*(S[0]*p[1]-S[1]*p[0])+bj*p[2];
+   }
+
+   // Domain wall tracking and moving frame
+   extern bool domain_wall_tracking; // Track domain wall position along x
+   extern bool domain_wall_moving_frame; // Shift spins to keep domain wall in simulation box
+   extern double domain_wall_position; // Domain wall position in laboratory frame (A)
+   extern int domain_wall_frame_shift; // Total shift of simulation frame (unit cells)
+   extern void update_domain_wall_tracking();
+
+   // Equilibration stage
+   extern int equilibration_integrator; // Integrator for equilibration stage, -1 = same as production
+   extern double equilibration_tolerance; // Magnetisation drift for early stop of equilibration, 0 = disabled
+   extern void equilibrate(const uint64_t n_steps);
+
 	// Wrapper Functions
 	extern int run();
 	extern int initialise();
@@ -172,11 +273,12 @@ namespace sim{
    extern double spin_exchange_energy_vector(const int, const double, const double, const double);
    extern double spin_exchange_energy_tensor(const int, const double, const double, const double);
    extern double spin_scalar_anisotropy_energy(const int, const double);
-   extern double spin_second_order_uniaxial_anisotropy_energy(const int, const double, const double, const double);
-   extern double spin_sixth_order_uniaxial_anisotropy_energy(const int, const double, const double, const double);
-   extern double spin_lattice_anisotropy_energy(const int, const double, const double, const double);
+   extern double spin_second_order_uniaxial_anisotropy_energy(const int, const int, const double, const double, const double);
+   extern double spin_sixth_order_uniaxial_anisotropy_energy(const int, const int, const double, const double, const double);
+   extern double spin_lattice_anisotropy_energy(const int, const int, const double, const double, const double);
    extern double spin_cubic_anisotropy_energy(const int, const double, const double, const double);
    extern double spin_tensor_anisotropy_energy(const int, const double, const double, const double);
+   extern double spin_local_uniaxial_anisotropy_energy(const int, const int, const double, const double, const double);
    extern double spin_surface_anisotropy_energy(const int, const int, const double, const double, const double);
    extern double spin_applied_field_energy(const double, const double, const double);
    extern double spin_magnetostatic_energy(const int, const double, const double, const double);
@@ -189,11 +291,14 @@ namespace sim{
    extern double lagrange_m;
    extern double lagrange_N;
    extern bool   lagrange_multiplier;
+   extern double lagrange_local_moment[4]; ///< Local sum of moments (mx,my,mz,ms) accumulated by integrator
+   extern bool   lagrange_local_moment_set; ///< Flag if local sum of moments is up to date
    extern void   update_lagrange_lambda();
 
    // Monte Carlo statistics counters
    extern double mc_statistics_moves;
    extern double mc_statistics_reject;
+   extern double mc_statistics_time; ///< Wall time spent in Monte Carlo steps (s)
 
 }
 
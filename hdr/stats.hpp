@@ -56,6 +56,7 @@ namespace stats
 
    /// Statistics energy types
    enum energy_t { all=0, exchange=1, anisotropy=2, cubic_anisotropy=3, surface_anisotropy=4,applied_field=5, magnetostatic=6, second_order_anisotropy=7 };
+   const int num_energy_types = 8;
 
    /// Statistics types
    enum stat_t { total=0, mean=1};
@@ -79,8 +80,18 @@ namespace stats
    extern bool calculate_height_magnetization;
    extern bool calculate_material_height_magnetization;
    extern bool calculate_system_susceptibility;
+   extern bool calculate_topological_charge;
+   extern bool calculate_system_energy;
+   extern bool calculate_material_energy;
+   extern bool calculate_height_energy;
+   extern bool calculate_material_height_energy;
 
    class susceptibility_statistic_t;
+   class energy_statistic_t;
+
+   // Function to calculate all energy statistics in a single pass
+   void calculate_energies(const std::vector<energy_statistic_t*>& energy_statistics,
+                           const std::vector<double>& sx, const std::vector<double>& sy, const std::vector<double>& sz);
 
    //----------------------------------
    // Magnetization Class definition
@@ -142,6 +153,71 @@ namespace stats
 
    };
 
+   //----------------------------------
+   // Topological Charge Class definition
+   //----------------------------------
+   class topological_charge_statistic_t{
+
+      public:
+         topological_charge_statistic_t ();
+         bool is_initialized();
+         void set_triangulation(const int num_local_atoms, const std::vector<int>& unit_cell_index, const std::vector<int>& layer_mask,
+                                const unsigned int num_unit_cells[3], const bool periodic[3]);
+         void calculate_topological_charge(const std::vector<double>& sx, const std::vector<double>& sy, const std::vector<double>& sz);
+         void reset_averages();
+         const std::vector<double>& get_topological_charge();
+         std::string output_topological_charge();
+         std::string output_mean_topological_charge();
+
+      private:
+         bool initialized;
+         int num_atoms;
+         int num_remote;
+         int num_layers;
+         double mean_counter;
+         std::vector<int> triangle; // atoms of each triangle (3 per triangle), remote atoms numbered from num_atoms
+         std::vector<int> triangle_layer; // layer of each triangle
+         std::vector<double> normalisation; // 1/(4 pi num_sublattices) for each layer
+         std::vector<double> topological_charge;
+         std::vector<double> mean_topological_charge;
+         std::vector<int> send_atoms; // local atoms sent to other processors
+         std::vector<int> send_counts;
+         std::vector<int> send_displacements;
+         std::vector<int> recv_counts;
+         std::vector<int> recv_displacements;
+         std::vector<int> recv_slot; // remote atom number of each received spin
+
+   };
+
+   //----------------------------------
+   // Energy Class definition
+   //----------------------------------
+   class energy_statistic_t{
+
+      friend void calculate_energies(const std::vector<energy_statistic_t*>& energy_statistics,
+                                     const std::vector<double>& sx, const std::vector<double>& sy, const std::vector<double>& sz);
+
+      public:
+         energy_statistic_t ();
+         bool is_initialized();
+         void set_mask(const int mask_size, std::vector<int> inmask);
+         void reset_averages();
+         std::string output_mean_energy();
+         std::string output_specific_heat(const double temperature);
+
+      private:
+         bool initialized;
+         int num_atoms;
+         int mask_size;
+         double mean_counter;
+         std::vector<int> mask;
+         std::vector<double> energy; // energy of each energy_t term for each mask id
+         std::vector<double> mean_energy;
+         std::vector<double> mean_energy_squared;
+         std::vector<double> num_atoms_in_mask;
+
+   };
+
    // Statistics classes
    extern magnetization_statistic_t system_magnetization;
    extern magnetization_statistic_t material_magnetization;
@@ -149,6 +225,13 @@ namespace stats
    extern magnetization_statistic_t material_height_magnetization;
 
    extern susceptibility_statistic_t system_susceptibility;
+
+   extern topological_charge_statistic_t topological_charge;
+
+   extern energy_statistic_t system_energy_statistic;
+   extern energy_statistic_t material_energy_statistic;
+   extern energy_statistic_t height_energy_statistic;
+   extern energy_statistic_t material_height_energy_statistic;
    //extern susceptibility_statistic_t material_susceptibility;
 
 }
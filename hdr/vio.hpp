@@ -111,6 +111,11 @@ namespace vout{
 	
 	extern bool output_grains_config;
 	extern int output_config_grain_rate;
+
+	extern bool average_atoms_config;
+	extern bool average_cells_config;
+	extern bool output_config_variance;
+	extern int config_average_window;
 	
 	//extern bool output_povray;
 	//extern int output_povray_rate;
@@ -133,4 +138,8 @@ namespace vout{
 void load_checkpoint();
 void save_checkpoint();
 
+// Spin tile load/save functions
+void load_spin_tile();
+void save_spin_tile();
+
 #endif /*VIO_H_*/
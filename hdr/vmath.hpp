@@ -42,6 +42,7 @@
 
 #include<vector>
 #include <cmath>
+#include <stdint.h>
 
 /// @namespace ns
 /// @brief vmath namespace containing sundry math functions for vampire.
@@ -95,6 +96,39 @@ namespace vmath{
 	
    extern double interpolate_m(double,double,double,double);
    extern double interpolate_c(double,double,double,double);
+
+   //-----------------------------------------------------------------------------
+   // Compact encoding of unit vectors in 32 bits (two 16 bit snorm values) using
+   // an octahedral projection. Angular error is below 1e-4 rad and the cartesian
+   // axes are represented exactly.
+   //-----------------------------------------------------------------------------
+   inline uint32_t encode_unit_vector(const double x, const double y, const double z){
+      const double inorm = 1.0/(fabs(x)+fabs(y)+fabs(z));
+      double u = x*inorm;
+      double v = y*inorm;
+      // fold lower hemisphere onto the outer triangles of the octahedron
+      if(z < 0.0){
+         const double tu = u;
+         u = (1.0-fabs(v))*(tu >= 0.0 ? 1.0 : -1.0);
+         v = (1.0-fabs(tu))*(v >= 0.0 ? 1.0 : -1.0);
+      }
+      const uint16_t iu = static_cast<uint16_t>(static_cast<int16_t>(iround(u*32767.0)));
+      const uint16_t iv = static_cast<uint16_t>(static_cast<int16_t>(iround(v*32767.0)));
+      return (static_cast<uint32_t>(iu) << 16) | static_cast<uint32_t>(iv);
+   }
+
+   inline void decode_unit_vector(const uint32_t code, double& x, double& y, double& z){
+      const double u = static_cast<double>(static_cast<int16_t>(code >> 16))*(1.0/32767.0);
+      const double v = static_cast<double>(static_cast<int16_t>(code & 0xFFFF))*(1.0/32767.0);
+      z = 1.0 - fabs(u) - fabs(v);
+      const double t = z < 0.0 ? -z : 0.0;
+      x = u + (u >= 0.0 ? -t : t);
+      y = v + (v >= 0.0 ? -t : t);
+      const double inorm = 1.0/sqrt(x*x + y*y + z*z);
+      x *= inorm;
+      y *= inorm;
+      z *= inorm;
+   }
 	
 }
 
@@ -54,6 +54,8 @@ namespace vmpi{
 	extern char hostname[20];			///< Hostname of local CPU
 	extern double min_dimensions[3]; 	///< Minimum coordinates of system on local cpu
 	extern double max_dimensions[3]; 	///< Maximum coordinates of system on local cpu
+	extern int decomposition_grid[3];	///< Number of cpus in x,y,z for geometric decomposition
+	extern double decomposition_cell_size[3]; ///< Size of local cpu domain in x,y,z
 
 	// Timing variables
 	extern double start_time;			///< Simulation start time on local CPU
@@ -66,8 +68,6 @@ namespace vmpi{
 	extern double AverageWaitTime;
 	extern double MaximumComputeTime;
 	extern double MaximumWaitTime;
-	extern std::vector<double> ComputeTimeArray;
-	extern std::vector<double> WaitTimeArray;
 	extern bool DetailedMPITiming; /// flag to control logging of compute and wait times
 	
 	extern std::vector<int> send_atom_translation_array;
@@ -96,6 +96,8 @@ namespace vmpi{
 	extern int identify_boundary_atoms(std::vector<cs::catom_t> &, std::vector<std::vector <cs::neighbour_t> > &);
 	extern int init_mpi_comms(std::vector<cs::catom_t> & catom_array);
 	extern double SwapTimer(double, double&);
+	extern void update_timing_statistics();
+	extern void output_timing_statistics();
 
 }
 
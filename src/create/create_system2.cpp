@@ -45,6 +45,7 @@
 ///=====================================================================================
 ///
 // Standard Headers
+#include <cmath>
 #include <iostream>
 #include <fstream>
 
@@ -80,6 +81,7 @@ namespace cs{
 	bool SelectMaterialByGeometry=false;					/// Toggle override of input material type by geometry
 	unsigned int total_num_unit_cells[3]={0,0,0};	/// Unit cells for entire system (x,y,z)
 	unsigned int local_num_unit_cells[3]={0,0,0};	/// Unit cells on local processor (x,y,z)
+	std::vector<int> unit_cell_index_array(0);		/// Unit cell coordinates and site of each atom (4 per atom) for spin tiling
 	std::string crystal_structure="sc";
 	
 	// System Parameters
@@ -146,6 +148,9 @@ int create(){
 	cs::unit_cell_size[1]=unit_cell.dimensions[1];
 	cs::unit_cell_size[2]=unit_cell.dimensions[2];
 	
+   // Scale system size with number of processors for weak scaling benchmark
+   if(sim::program==15 && sim::weak_scaling==true) cs::weak_scaling_dimensions(vmpi::num_processors);
+
    // Calculate number of global and local unit cells required (rounding up)
    // Must be set before rounding up system dimensions for periodic boundary conditions
    cs::total_num_unit_cells[0]=int(vmath::iceil(cs::system_dimensions[0]/unit_cell.dimensions[0]));
@@ -333,4 +338,55 @@ int create(){
 	return EXIT_SUCCESS;
 }
 
+//------------------------------------------------------------------------------
+// Function to scale the system dimensions for the weak scaling benchmark. The
+// input system is repeated by integer factors whose product is the number of
+// processors along the periodic dimensions only (or along all dimensions if
+// none are periodic), so that thin films and wires keep their thickness and
+// the number of atoms per processor is that of the input system. Periodic
+// dimensions are first rounded to whole unit cells so that the repeats are
+// exact, and the factors are chosen to keep the system as compact as possible.
+//------------------------------------------------------------------------------
+void weak_scaling_dimensions(const int num_processors){
+
+   bool extend[3]={cs::pbc[0],cs::pbc[1],cs::pbc[2]};
+   if(!extend[0] && !extend[1] && !extend[2]) extend[0]=extend[1]=extend[2]=true;
+
+   double dim[3];
+   for(int i=0;i<3;i++){
+      dim[i]=cs::system_dimensions[i];
+      if(cs::pbc[i]==true) dim[i]=cs::unit_cell_size[i]*(int(vmath::iceil(dim[i]/cs::unit_cell_size[i])));
+   }
+
+   // find factors minimising the surface to volume ratio of the scaled system
+   int repeat[3]={1,1,1};
+   double min_surface_volume=0.0;
+   for(int a=1;a<=num_processors;a++){
+      if(num_processors%a!=0) continue;
+      for(int b=1;b<=num_processors/a;b++){
+         if((num_processors/a)%b!=0) continue;
+         const int r[3]={a,b,num_processors/a/b};
+         bool valid=true;
+         double surface_volume=0.0;
+         for(int i=0;i<3;i++){
+            if(r[i]>1 && !extend[i]) valid=false;
+            surface_volume+=1.0/(dim[i]*double(r[i]));
+         }
+         if(!valid) continue;
+         if(min_surface_volume==0.0 || surface_volume<min_surface_volume){
+            min_surface_volume=surface_volume;
+            for(int i=0;i<3;i++) repeat[i]=r[i];
+         }
+      }
+   }
+
+   for(int i=0;i<3;i++) cs::system_dimensions[i]=dim[i]*double(repeat[i]);
+
+   zlog << zTs() << "Weak scaling benchmark: system repeated " << repeat[0] << " x " << repeat[1] << " x " << repeat[2] << " times to "
+        << cs::system_dimensions[0] << "\t" << cs::system_dimensions[1] << "\t" << cs::system_dimensions[2] << " A" << std::endl;
+
+   return;
+
+}
+
 }
@@ -29,6 +29,8 @@
 //
 //==================================================================== 
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 
@@ -41,6 +43,7 @@
 #include "sim.hpp"
 #include "stats.hpp"
 #include "vio.hpp"
+#include "vmath.hpp"
 #include "vmpi.hpp"
 
 
@@ -48,6 +51,84 @@
 //using namespace material_parameters;
 	
 namespace cs{
+
+//-----------------------------------------------------------------------------
+//
+//   Function to set per-atom uniaxial anisotropy easy axes, dispersed about
+//   the material easy axis by a gaussian polar angle and a uniform azimuth.
+//   Grain axes are generated from a common seed so that atoms belonging to
+//   the same grain share an axis on all processors. Axes are stored as
+//   32-bit octahedral encoded unit vectors.
+//
+//-----------------------------------------------------------------------------
+void set_local_anisotropy_axes(){
+
+   zlog << zTs() << "Memory required for local anisotropy axes on rank " << vmpi::my_rank << ": " << double(atoms::num_atoms)*4.0/1.0e6 << " MB RAM" << std::endl;
+
+   atoms::uniaxial_anisotropy_axis_array.resize(atoms::num_atoms);
+
+   // determine global number of grains
+   int max_grain=0;
+   for(int atom=0;atom<atoms::num_atoms;atom++) max_grain=std::max(max_grain,atoms::grain_array[atom]);
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &max_grain, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+   #endif
+
+   // Generate reduced polar (gaussian) and azimuthal angles for each grain
+   MTRand random_axis_rng;
+   random_axis_rng.seed(mtrandom::voronoi_seed+1);
+   std::vector<double> grain_theta(max_grain+1);
+   std::vector<double> grain_phi(max_grain+1);
+   for(int grain=0;grain<=max_grain;grain++){
+      grain_theta[grain]=mtrandom::gaussianc(random_axis_rng);
+      grain_phi[grain]=2.0*M_PI*random_axis_rng();
+   }
+
+   // Per-atom dispersion is seeded by rank like the initial spin directions
+   random_axis_rng.seed(234567+vmpi::my_rank);
+
+   for(int atom=0;atom<atoms::num_atoms;atom++){
+
+      const int mat=atoms::type_array[atom];
+      const double ex=mp::material[mat].UniaxialAnisotropyUnitVector[0];
+      const double ey=mp::material[mat].UniaxialAnisotropyUnitVector[1];
+      const double ez=mp::material[mat].UniaxialAnisotropyUnitVector[2];
+
+      double theta, phi;
+      if(mp::material[mat].UniaxialAnisotropyDispersionPerGrain){
+         theta=mp::material[mat].UniaxialAnisotropyDispersion*grain_theta[atoms::grain_array[atom]];
+         phi=grain_phi[atoms::grain_array[atom]];
+      }
+      else{
+         theta=mp::material[mat].UniaxialAnisotropyDispersion*mtrandom::gaussianc(random_axis_rng);
+         phi=2.0*M_PI*random_axis_rng();
+      }
+
+      // orthonormal basis (u,v) perpendicular to e
+      double ux, uy, uz;
+      if(fabs(ez)<0.9){ ux=-ey; uy=ex; uz=0.0; }
+      else{ ux=0.0; uy=-ez; uz=ey; }
+      const double imu=1.0/sqrt(ux*ux+uy*uy+uz*uz);
+      ux*=imu; uy*=imu; uz*=imu;
+      const double vx=ey*uz-ez*uy;
+      const double vy=ez*ux-ex*uz;
+      const double vz=ex*uy-ey*ux;
+
+      // rotate e by theta towards direction phi in the (u,v) plane
+      const double ct=cos(theta);
+      const double st=sin(theta);
+      const double cp=cos(phi);
+      const double sp=sin(phi);
+
+      atoms::uniaxial_anisotropy_axis_array[atom]=vmath::encode_unit_vector(ct*ex+st*(cp*ux+sp*vx),
+                                                                            ct*ey+st*(cp*uy+sp*vy),
+                                                                            ct*ez+st*(cp*uz+sp*vz));
+   }
+
+   return;
+
+}
+
 int set_atom_vars(std::vector<cs::catom_t> & catom_array, std::vector<std::vector <neighbour_t> > & cneighbourlist){
 
 	// check calling of routine if error checking is activated
@@ -87,6 +168,11 @@ int set_atom_vars(std::vector<cs::catom_t> & catom_array, std::vector<std::vecto
 	atoms::y_dipolar_field_array.resize(atoms::num_atoms,0.0);	
 	atoms::z_dipolar_field_array.resize(atoms::num_atoms,0.0);	
 
+   // Retain unit cell coordinates of atoms for spin tiles, domain wall tracking and topological charge
+   const bool retain_unit_cell_index=(sim::save_spin_tile_flag || sim::load_spin_tile_flag || sim::domain_wall_tracking ||
+                                      stats::calculate_topological_charge);
+   if(retain_unit_cell_index) cs::unit_cell_index_array.resize(4*atoms::num_atoms);
+
    // Set custom RNG for spin initialisation
    MTRand random_spin_rng;
    random_spin_rng.seed(123456+vmpi::my_rank);
@@ -102,6 +188,13 @@ int set_atom_vars(std::vector<cs::catom_t> & catom_array, std::vector<std::vecto
 		//std::cout << atom << " grain: " << catom_array[atom].grain << std::endl;
 		atoms::grain_array[atom] = catom_array[atom].grain;
 
+		if(retain_unit_cell_index){
+			cs::unit_cell_index_array[4*atom+0]=catom_array[atom].scx;
+			cs::unit_cell_index_array[4*atom+1]=catom_array[atom].scy;
+			cs::unit_cell_index_array[4*atom+2]=catom_array[atom].scz;
+			cs::unit_cell_index_array[4*atom+3]=catom_array[atom].uc_id;
+		}
+
 		// initialise atomic spin positions
       // Use a normalised gaussian for uniform distribution on a unit sphere
 		int mat=atoms::type_array[atom];
@@ -124,6 +217,9 @@ int set_atom_vars(std::vector<cs::catom_t> & catom_array, std::vector<std::vecto
       atoms::m_spin_array[atom]=mp::material[mat].mu_s_SI/9.27400915e-24;
 	}
 
+	// Set local easy axes if required
+	if(sim::local_anisotropy_axis==true) set_local_anisotropy_axes();
+
 	//===========================================================
 	// Create 1-D neighbourlist
 	//===========================================================
@@ -0,0 +1,605 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Resource and runtime estimator for dry runs (vampire --dry-run [n]).
+//
+//   After the input and material files have been read and the unit cell has
+//   been initialised, the system size is estimated analytically without
+//   generating any atoms:
+//
+//      - the number of atoms is counted exactly for the bulk lattice and
+//        material heights, and scaled by the volume fraction of the
+//        particle shape or particle array
+//      - the number of neighbours per atom is determined from the unit
+//        cell interactions, corrected for open surfaces
+//      - local and halo atoms per rank are determined for the same
+//        geometric decomposition as vmpi::geometric_decomposition
+//      - the number of macrocells and demagnetisation memory and cost
+//      - the size of output files
+//
+//   The peak memory per rank is estimated from the sizes of the data
+//   structures used during system creation and simulation, and the time
+//   per step from kernel costs calibrated on a reference x86-64 core
+//   (gcc -O3). Estimates for particles, Voronoi films and interfacial
+//   roughness are approximate.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "cells.hpp"
+#include "create.hpp"
+#include "demag.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmath.hpp"
+#include "vmpi.hpp"
+
+namespace cs{
+
+   namespace internal{
+
+      //-----------------------------------------------------------------------
+      // Calibrated kernel costs (seconds)
+      //-----------------------------------------------------------------------
+      const double atom_field_cost=2.0e-8; // non-exchange fields per atom
+      const double neighbour_cost=2.3e-9; // exchange field per neighbour
+      const double heun_integration_cost=2.2e-8; // Heun integration per atom per step
+      const double midpoint_integration_cost=2.5e-8; // Midpoint integration per atom per step
+      const double monte_carlo_move_cost=4.2e-8; // Monte Carlo trial move per atom
+      const double monte_carlo_neighbour_cost=1.4e-8; // Monte Carlo energy per neighbour
+      const double demag_pair_cost=3.0e-9; // precalculated demag cell-cell interaction
+      const double demag_direct_pair_cost=1.5e-8; // direct demag cell-cell interaction
+
+      // assumed interconnect performance for halo exchange
+      const double mpi_latency=2.0e-6; // seconds per message
+      const double mpi_bandwidth=5.0e9; // bytes per second
+
+      // approximate output sizes per item (bytes)
+      const double output_bytes_per_column=16.0;
+      const double coord_bytes_per_atom=56.0;
+      const double spin_bytes_per_atom=40.0;
+      const double cell_bytes_per_cell=72.0;
+
+      //-----------------------------------------------------------------------
+      // Function to format a number of bytes in human readable units
+      //-----------------------------------------------------------------------
+      std::string bytes_to_string(const double bytes){
+
+         const char* units[5]={"B","kB","MB","GB","TB"};
+         double value=bytes;
+         int unit=0;
+         while(value>=1000.0 && unit<4){
+            value/=1000.0;
+            unit++;
+         }
+
+         std::stringstream ss;
+         ss << std::setprecision(3) << value << " " << units[unit];
+         return ss.str();
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine the number of cpus in x,y,z using the same
+      // minimum surface criterion as vmpi::geometric_decomposition
+      //-----------------------------------------------------------------------
+      bool decomposition_grid(const int num_cpus, const double dimensions[3], int grid[3]){
+
+         std::vector<int> factors;
+         for(int i=1;i<num_cpus+1;i++) if(num_cpus%i==0) factors.push_back(i);
+
+         if(factors.size()==2 && num_cpus>10) return false;
+
+         double compare_sv=10000000.0;
+         grid[0]=grid[1]=grid[2]=1;
+         for(unsigned int i=0;i<factors.size();i++){
+            for(unsigned int j=0;j<factors.size();j++){
+               for(unsigned int k=0;k<factors.size();k++){
+                  if(factors[i]*factors[j]*factors[k]==num_cpus){
+                     const double sv=2.0*(double(factors[i])/dimensions[0]+double(factors[j])/dimensions[1]+double(factors[k])/dimensions[2]);
+                     if(sv < compare_sv){
+                        compare_sv=sv;
+                        grid[0]=factors[i];
+                        grid[1]=factors[j];
+                        grid[2]=factors[k];
+                     }
+                  }
+               }
+            }
+         }
+
+         return true;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine the number of lattice points along an axis
+      // for a unit cell atom at fractional coordinate f, consistent with
+      // cs::create_crystal_structure
+      //-----------------------------------------------------------------------
+      double lattice_points(const int axis, const double f){
+
+         const int n=cs::total_num_unit_cells[axis];
+         const double d=cs::unit_cell.dimensions[axis];
+         int count=0;
+         for(int c=0;c<n;c++) if((double(c)+f)*d<cs::system_dimensions[axis]) count++;
+         return double(count);
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine the material of an atom at height cz
+      // assigned by height, consistent with cs::create_crystal_structure and
+      // cs::generate_multilayers. Returns -1 if no atom is generated.
+      //-----------------------------------------------------------------------
+      int material_at_height(const double cz){
+
+         int material=-1;
+         const int num_layers = cs::multilayers ? cs::num_multilayers : 1;
+         const double layer_height=cs::system_dimensions[2]/double(num_layers);
+
+         for(int multi=0;multi<num_layers;multi++){
+            for(int mat=0;mat<mp::num_materials;mat++){
+               double max=mp::material[mat].max;
+               if(max<0.0000001) max=-0.1;
+               const double min_z=(mp::material[mat].min+double(multi))*layer_height;
+               const double max_z=(max+double(multi))*layer_height;
+               if((cz>=min_z) && (cz<max_z) && (mp::material[mat].fill==false)) material=mat;
+            }
+         }
+
+         return material;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine the fill material at height cz, or -1
+      //-----------------------------------------------------------------------
+      int fill_material_at_height(const double cz){
+
+         for(int mat=0;mat<mp::num_materials;mat++){
+            if(mp::material[mat].fill){
+               if((cz<mp::material[mat].max*cs::system_dimensions[2]) && (cz>=mp::material[mat].min*cs::system_dimensions[2])) return mat;
+            }
+         }
+
+         return -1;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine the volume of a single particle, clipped to
+      // the system dimensions
+      //-----------------------------------------------------------------------
+      double particle_volume(){
+
+         const double s=cs::particle_scale;
+         const double pi=M_PI;
+         const double lx=cs::system_dimensions[0];
+         const double ly=cs::system_dimensions[1];
+         const double lz=cs::system_dimensions[2];
+
+         // extent of particle along each axis
+         double ex=s*cs::particle_shape_factor_x;
+         double ey=s*cs::particle_shape_factor_y;
+         double ez=s*cs::particle_shape_factor_z;
+         if(ex>lx) ex=lx;
+         if(ey>ly) ey=ly;
+         if(ez>lz) ez=lz;
+         const double sx = s<lx ? s : lx;
+         const double sy = s<ly ? s : ly;
+         const double sz = s<lz ? s : lz;
+
+         switch(cs::system_creation_flags[1]){
+            case 0: // Bulk
+               return lx*ly*lz;
+            case 1: // Cube (prism along z)
+               return sx*sy*lz;
+            case 2: // Cylinder
+            case 6: // Teardrop (approximated as cylinder)
+               return pi*0.25*sx*sy*lz;
+            case 3: // Ellipsoid
+               return pi/6.0*ex*ey*ez;
+            case 4: // Sphere
+               return pi/6.0*sx*sy*sz;
+            case 5: // Truncated Octahedron (|x|+|y|+|z| <= 3s/4, |x_i| <= s/2)
+               return 0.5*sx*sy*sz;
+            default:
+               return lx*ly*lz;
+         }
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine the fraction of the system volume occupied by
+      // the particle shape or particle array, and the number of particles
+      //-----------------------------------------------------------------------
+      double shape_fraction(int& num_particles){
+
+         const double lx=cs::system_dimensions[0];
+         const double ly=cs::system_dimensions[1];
+         const double system_volume=lx*ly*cs::system_dimensions[2];
+         const double repeat_size = cs::particle_scale+cs::particle_spacing;
+
+         double fraction=1.0;
+         num_particles=1;
+
+         switch(cs::system_creation_flags[2]){
+            case 0: // Isolated particle
+               fraction=particle_volume()/system_volume;
+               break;
+            case 1:{ // Cubic particle array, consistent with cs::particle_array
+               const int nx=vmath::iceil(lx/repeat_size);
+               const int ny=vmath::iceil(ly/repeat_size);
+               int px=0, py=0;
+               for(int x=0;x<nx;x++) if(double(x)*repeat_size + cs::particle_scale*0.5 + cs::particle_array_offset_x <= lx-cs::particle_scale*0.5) px++;
+               for(int y=0;y<ny;y++) if(double(y)*repeat_size + cs::particle_scale*0.5 + cs::particle_array_offset_y <= ly-cs::particle_scale*0.5) py++;
+               num_particles=px*py;
+               fraction=double(num_particles)*particle_volume()/system_volume;
+               break;
+            }
+            case 2: // Hexagonal particle array (not implemented)
+               num_particles=0;
+               fraction=0.0;
+               break;
+            case 3: // Voronoi film, grains separated by particle spacing
+               num_particles=int(lx*ly/(repeat_size*repeat_size))+1;
+               fraction=(cs::particle_scale*cs::particle_scale)/(repeat_size*repeat_size);
+               break;
+            default:
+               break;
+         }
+
+         if(fraction>1.0) fraction=1.0;
+         return fraction;
+
+      }
+
+   } // end of internal namespace
+
+   //--------------------------------------------------------------------------
+   // Function to estimate memory and run time requirements for the system
+   // on num_ranks processors without generating the system
+   //--------------------------------------------------------------------------
+   void estimate_resources(const int num_ranks){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "cs::estimate_resources has been called" << std::endl;
+
+      //-------------------------------------------------------------------------
+      // Initialise unit cell and system dimensions as in cs::create
+      //-------------------------------------------------------------------------
+      unit_cell_set(cs::unit_cell);
+      for(int i=0;i<3;i++) cs::unit_cell_size[i]=unit_cell.dimensions[i];
+
+      if(sim::program==15 && sim::weak_scaling==true) cs::weak_scaling_dimensions(num_ranks);
+
+      for(int i=0;i<3;i++){
+         cs::total_num_unit_cells[i]=int(vmath::iceil(cs::system_dimensions[i]/unit_cell.dimensions[i]));
+         if(cs::pbc[i]==true) cs::system_dimensions[i]=cs::unit_cell_size[i]*(int(vmath::iceil(cs::system_dimensions[i]/cs::unit_cell_size[i])));
+      }
+
+      const double system_volume=cs::system_dimensions[0]*cs::system_dimensions[1]*cs::system_dimensions[2];
+      const unsigned int num_uc_atoms=unit_cell.atom.size();
+
+      //-------------------------------------------------------------------------
+      // Count atoms in bulk lattice, material height ranges and particle shape
+      //-------------------------------------------------------------------------
+      int num_particles=1;
+      const double fraction=internal::shape_fraction(num_particles);
+
+      double bulk_atoms=0.0; // atoms in lattice (before height selection)
+      double num_atoms=0.0; // atoms in system
+      for(unsigned int uca=0;uca<num_uc_atoms;uca++){
+
+         const double nxy=internal::lattice_points(0,unit_cell.atom[uca].x)*internal::lattice_points(1,unit_cell.atom[uca].y);
+
+         // loop over layers in z
+         for(unsigned int z=0;z<cs::total_num_unit_cells[2];z++){
+            const double cz=(double(z)+unit_cell.atom[uca].z)*unit_cell.dimensions[2];
+            if(cz>=cs::system_dimensions[2]) continue;
+            bulk_atoms+=nxy;
+
+            int mat=unit_cell.atom[uca].mat;
+            if(cs::SelectMaterialByZHeight==true){
+               mat=internal::material_at_height(cz);
+               if(mat<0) continue;
+            }
+            if(mat>=mp::num_materials) mat=0;
+
+            // atoms within particle shape
+            double layer_atoms=fraction*nxy*mp::material[mat].density;
+
+            // remaining atoms replaced by fill material
+            const int fill_mat=internal::fill_material_at_height(cz);
+            if(fill_mat>=0) layer_atoms+=(1.0-fraction)*nxy*mp::material[fill_mat].density;
+
+            num_atoms+=layer_atoms;
+         }
+      }
+
+      if(cs::single_spin==true) num_atoms=1.0;
+
+      const double atom_density = system_volume > 0.0 ? num_atoms/system_volume : 0.0; // atoms/A^3
+
+      //-------------------------------------------------------------------------
+      // Determine average number of neighbours per atom with surface
+      // correction for open boundaries
+      //-------------------------------------------------------------------------
+      double extent[3]; // extent of magnetic material in unit cells
+      for(int i=0;i<3;i++) extent[i]=double(cs::total_num_unit_cells[i]);
+      if(cs::system_creation_flags[1]!=0){
+         const double scale[3]={cs::particle_scale*cs::particle_shape_factor_x,
+                                cs::particle_scale*cs::particle_shape_factor_y,
+                                cs::particle_scale*cs::particle_shape_factor_z};
+         for(int i=0;i<3;i++){
+            // prisms extend through the whole system height
+            if(i==2 && (cs::system_creation_flags[1]==1 || cs::system_creation_flags[1]==2 || cs::system_creation_flags[1]==6)) continue;
+            const double e=scale[i]/unit_cell.dimensions[i];
+            if(e<extent[i]) extent[i]=e;
+         }
+      }
+
+      double bulk_neighbours=0.0;
+      double neighbours=0.0;
+      for(unsigned int i=0;i<unit_cell.interaction.size();i++){
+         const int d[3]={unit_cell.interaction[i].dx, unit_cell.interaction[i].dy, unit_cell.interaction[i].dz};
+         double p=1.0;
+         for(int j=0;j<3;j++){
+            const bool periodic = cs::pbc[j]==true && cs::system_creation_flags[1]==0;
+            if(!periodic){
+               const double f=1.0-fabs(double(d[j]))/(extent[j] > 1.0 ? extent[j] : 1.0);
+               p*= f > 0.0 ? f : 0.0;
+            }
+         }
+         bulk_neighbours+=1.0;
+         neighbours+=p;
+      }
+      if(num_uc_atoms>0){
+         bulk_neighbours/=double(num_uc_atoms);
+         neighbours/=double(num_uc_atoms);
+      }
+
+      //-------------------------------------------------------------------------
+      // Determine local and halo atoms per rank for geometric decomposition
+      //-------------------------------------------------------------------------
+      int grid[3]={1,1,1};
+      bool decomposition_valid=true;
+      double min_local=num_atoms, max_local=num_atoms;
+      double min_halo=0.0, max_halo=0.0, total_halo=0.0;
+      int max_neighbour_ranks=0;
+
+      if(num_ranks>1){
+
+         decomposition_valid=internal::decomposition_grid(num_ranks, cs::system_dimensions, grid);
+
+         double d[3], range[3];
+         int reach[3];
+         for(int i=0;i<3;i++){
+            d[i]=cs::system_dimensions[i]/double(grid[i]);
+            range[i]=double(unit_cell.interaction_range)*unit_cell.dimensions[i]+0.01;
+            reach[i]=int(ceil(range[i]/d[i]))+1;
+         }
+
+         // number of neighbouring cpus for halo exchange (including periodic images)
+         max_neighbour_ranks=1;
+         for(int i=0;i<3;i++){
+            int n=2*reach[i]+1;
+            if(n>grid[i]) n=grid[i];
+            max_neighbour_ranks*=n;
+         }
+         max_neighbour_ranks-=1;
+
+         // loop over ranks and determine local and halo volumes
+         min_local=min_halo=1.0e300;
+         max_local=max_halo=0.0;
+         for(int gx=0;gx<grid[0];gx++){
+            for(int gy=0;gy<grid[1];gy++){
+               for(int gz=0;gz<grid[2];gz++){
+                  const int g[3]={gx,gy,gz};
+                  double local_volume=1.0;
+                  double halo_volume=1.0;
+                  for(int i=0;i<3;i++){
+                     const double min=double(g[i])*d[i];
+                     const double max=min+d[i];
+                     double hmin=min-range[i];
+                     double hmax=max+range[i];
+                     if(cs::pbc[i]==false){
+                        if(hmin<0.0) hmin=0.0;
+                        if(hmax>cs::system_dimensions[i]) hmax=cs::system_dimensions[i];
+                     }
+                     local_volume*=d[i];
+                     halo_volume*=(hmax-hmin);
+                  }
+                  const double local_atoms=atom_density*local_volume;
+                  const double halo_atoms=atom_density*(halo_volume-local_volume);
+                  if(local_atoms<min_local) min_local=local_atoms;
+                  if(local_atoms>max_local) max_local=local_atoms;
+                  if(halo_atoms<min_halo) min_halo=halo_atoms;
+                  if(halo_atoms>max_halo) max_halo=halo_atoms;
+                  total_halo+=halo_atoms;
+               }
+            }
+         }
+
+      }
+
+      const double mean_local=num_atoms/double(num_ranks);
+      const double mean_halo=total_halo/double(num_ranks);
+
+      //-------------------------------------------------------------------------
+      // Determine number of macrocells, consistent with cells::initialise
+      //-------------------------------------------------------------------------
+      double num_cells=1.0;
+      for(int i=0;i<3;i++) num_cells*=ceil((cs::system_dimensions[i]+0.01)/cells::size);
+      double num_local_cells=ceil(num_cells/double(num_ranks));
+      if(num_ranks>1){
+         // include cells partially occupied by halo
+         double local_cells=1.0;
+         for(int i=0;i<3;i++) local_cells*=ceil(cs::system_dimensions[i]/double(grid[i])/cells::size)+1.0;
+         if(local_cells<num_cells) num_local_cells=local_cells;
+         else num_local_cells=num_cells;
+      }
+      const bool demag_enabled = sim::hamiltonian_simulation_flags[4]==1;
+
+      //-------------------------------------------------------------------------
+      // Estimate peak memory per rank
+      //-------------------------------------------------------------------------
+      const double max_atoms=max_local+max_halo; // atoms on busiest rank
+
+      // system creation (catom_array and neighbour list, including halo)
+      const double creation_bytes = max_atoms*(double(sizeof(cs::catom_t)) + double(sizeof(std::vector<cs::neighbour_t>)))
+                                  + max_atoms*bulk_neighbours*double(sizeof(cs::neighbour_t));
+
+      // atomic data: coordinates (3), spins (3+1+4), fields (9)
+      double atom_bytes_per_atom=20.0*sizeof(double) + 7.0*sizeof(int);
+      // integrator storage
+      if(sim::integrator==0 || sim::integrator==2) atom_bytes_per_atom+=12.0*sizeof(double);
+      else atom_bytes_per_atom+=3.0*sizeof(double);
+      const double atom_bytes = max_atoms*atom_bytes_per_atom + max_atoms*neighbours*2.0*sizeof(int);
+
+      // macrocell data: coordinates, magnetisation, fields, volume and atoms per cell
+      double cell_bytes = num_cells*(10.0*sizeof(double)+sizeof(int));
+      if(demag_enabled && demag::fast==true) cell_bytes+=num_cells*num_local_cells*6.0*sizeof(double);
+
+      const double peak_bytes=creation_bytes+atom_bytes+cell_bytes;
+
+      //-------------------------------------------------------------------------
+      // Estimate time per step on busiest rank
+      //-------------------------------------------------------------------------
+      const double field_time = max_local*(internal::atom_field_cost + neighbours*internal::neighbour_cost);
+      double step_time=0.0;
+      int halo_exchanges=0; // halo exchanges per step
+      std::string integrator_name;
+      switch(sim::integrator){
+         case 0:
+            integrator_name="LLG Heun";
+            step_time=2.0*field_time + max_local*internal::heun_integration_cost;
+            halo_exchanges=2;
+            break;
+         case 2:
+            integrator_name="LLG Midpoint";
+            step_time=2.0*field_time + max_local*internal::midpoint_integration_cost;
+            halo_exchanges=2;
+            break;
+         case 1:
+            integrator_name="Monte Carlo";
+            step_time=max_local*(internal::monte_carlo_move_cost + 2.0*neighbours*internal::monte_carlo_neighbour_cost);
+            halo_exchanges=8;
+            break;
+         default:
+            integrator_name="Constrained Monte Carlo";
+            step_time=max_local*(2.0*internal::monte_carlo_move_cost + 4.0*neighbours*internal::monte_carlo_neighbour_cost);
+            halo_exchanges=1;
+            break;
+      }
+
+      // halo exchange of spins (3 doubles per atom)
+      double mpi_time=0.0;
+      if(num_ranks>1) mpi_time=double(halo_exchanges)*(double(max_neighbour_ranks)*internal::mpi_latency + max_halo*3.0*sizeof(double)/internal::mpi_bandwidth);
+
+      // demagnetisation field update
+      double demag_time=0.0;
+      if(demag_enabled){
+         const double pair_cost = demag::fast ? internal::demag_pair_cost : internal::demag_direct_pair_cost;
+         demag_time=num_local_cells*num_cells*pair_cost/double(demag::update_rate > 0 ? demag::update_rate : 1);
+      }
+
+      const double total_step_time=step_time+mpi_time+demag_time;
+      const double steps_per_run=double(sim::equilibration_time)+double(sim::total_time);
+
+      //-------------------------------------------------------------------------
+      // Estimate output volume
+      //-------------------------------------------------------------------------
+      const double line_bytes=double(vout::file_output_list.size())*4.0*internal::output_bytes_per_column+1.0;
+      const double output_interval = sim::partial_time > vout::output_rate ? sim::partial_time : vout::output_rate;
+      const double output_lines = output_interval > 0 ? double(sim::total_time)/double(output_interval) : 0.0;
+
+      double config_atoms_fraction=1.0;
+      for(int i=0;i<3;i++) config_atoms_fraction*=(vout::atoms_output_max[i]-vout::atoms_output_min[i]);
+      const double coord_bytes = vout::output_atoms_config ? config_atoms_fraction*num_atoms*internal::coord_bytes_per_atom : 0.0;
+      const double spin_bytes = vout::output_atoms_config ? config_atoms_fraction*num_atoms*internal::spin_bytes_per_atom : 0.0;
+      const double cells_bytes = vout::output_cells_config ? num_cells*internal::cell_bytes_per_cell : 0.0;
+
+      //-------------------------------------------------------------------------
+      // Output estimates to screen and log file
+      //-------------------------------------------------------------------------
+      std::stringstream report;
+      report << "--------------------------------------------------------------------------------" << std::endl;
+      report << " Dry run resource estimate" << std::endl;
+      report << "--------------------------------------------------------------------------------" << std::endl;
+      report << " System dimensions:            " << cs::system_dimensions[0] << " x " << cs::system_dimensions[1] << " x " << cs::system_dimensions[2] << " A" << std::endl;
+      report << " Unit cells:                   " << cs::total_num_unit_cells[0] << " x " << cs::total_num_unit_cells[1] << " x " << cs::total_num_unit_cells[2]
+             << " (" << num_uc_atoms << " atoms per unit cell)" << std::endl;
+      report << " Lattice sites:                " << std::setprecision(6) << bulk_atoms << std::endl;
+      report << " Volume fraction of shape:     " << fraction << " (" << num_particles << " particles)" << std::endl;
+      report << " Estimated number of atoms:    " << std::setprecision(6) << num_atoms << std::endl;
+      report << " Neighbours per atom:          " << neighbours << " (bulk " << bulk_neighbours << ", range " << unit_cell.interaction_range << " unit cells)" << std::endl;
+      report << " Processors:                   " << num_ranks;
+      if(num_ranks>1) report << " (" << grid[0] << " x " << grid[1] << " x " << grid[2] << ")";
+      report << std::endl;
+      if(!decomposition_valid) report << " Warning: " << num_ranks << " cpus cannot be decomposed efficiently and will exit" << std::endl;
+      if(num_ranks>1){
+         if(vmpi::mpi_mode!=0) report << " Note: estimates assume geometric decomposition (mpi-mode 0)" << std::endl;
+         report << " Local atoms per rank:         " << min_local << " / " << mean_local << " / " << max_local << " (min/mean/max)" << std::endl;
+         report << " Halo atoms per rank:          " << min_halo << " / " << mean_halo << " / " << max_halo << " (min/mean/max)" << std::endl;
+         report << " Neighbouring ranks:           " << max_neighbour_ranks << std::endl;
+      }
+      report << " Macrocells:                   " << num_cells << " (" << num_local_cells << " per rank, size " << cells::size << " A)" << std::endl;
+      report << " Demagnetisation fields:       ";
+      if(demag_enabled) report << (demag::fast ? "fast" : "direct") << ", update every " << demag::update_rate << " steps" << std::endl;
+      else report << "disabled" << std::endl;
+      report << "--------------------------------------------------------------------------------" << std::endl;
+      report << " Peak memory per rank:         " << internal::bytes_to_string(peak_bytes) << std::endl;
+      report << "    system creation:           " << internal::bytes_to_string(creation_bytes) << std::endl;
+      report << "    atomic data:               " << internal::bytes_to_string(atom_bytes) << std::endl;
+      report << "    macrocells and demag:      " << internal::bytes_to_string(cell_bytes) << std::endl;
+      report << " Total memory (all ranks):     " << internal::bytes_to_string(peak_bytes*double(num_ranks)) << std::endl;
+      report << "--------------------------------------------------------------------------------" << std::endl;
+      report << " Integrator:                   " << integrator_name << std::endl;
+      report << " Time per step:                " << total_step_time << " s" << std::endl;
+      report << "    spin dynamics:             " << step_time << " s" << std::endl;
+      if(num_ranks>1) report << "    halo exchange:             " << mpi_time << " s" << std::endl;
+      if(demag_enabled) report << "    demagnetisation:           " << demag_time << " s" << std::endl;
+      report << " Time steps per run:           " << steps_per_run << " (equilibration + total time steps)" << std::endl;
+      report << " Time per run:                 " << total_step_time*steps_per_run << " s (" << total_step_time*steps_per_run*double(num_ranks)/3600.0 << " core hours)" << std::endl;
+      report << "--------------------------------------------------------------------------------" << std::endl;
+      report << " Output per data line:         " << internal::bytes_to_string(line_bytes) << " (" << vout::file_output_list.size() << " output quantities)" << std::endl;
+      report << " Output per run:               " << internal::bytes_to_string(line_bytes*output_lines) << " (" << output_lines << " lines)" << std::endl;
+      if(vout::output_atoms_config){
+         report << " Atomic coordinate file:       " << internal::bytes_to_string(coord_bytes) << std::endl;
+         report << " Atomic spin snapshot:         " << internal::bytes_to_string(spin_bytes) << " per snapshot" << std::endl;
+      }
+      if(vout::output_cells_config) report << " Cell snapshot:                " << internal::bytes_to_string(cells_bytes) << " per snapshot" << std::endl;
+      report << "--------------------------------------------------------------------------------" << std::endl;
+      if(cs::interfacial_roughness || cs::system_creation_flags[2]==3 || cs::system_creation_flags[1]==6)
+         report << " Note: atom counts for roughness, Voronoi films and tear drops are approximate" << std::endl;
+      if(num_particles==0) report << " Warning: no particles will be generated for requested system" << std::endl;
+
+      // only root process prints report to screen
+      if(vmpi::my_rank==0) std::cout << report.str();
+
+      // write report to log file line by line with time stamps
+      std::string line;
+      while(std::getline(report, line)) zlog << zTs() << line << std::endl;
+
+      return;
+
+   }
+
+} // end of namespace cs
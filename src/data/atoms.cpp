@@ -52,11 +52,13 @@ namespace atoms{
 	std::vector <int> category_array(0);
 	std::vector <int> grain_array(0);
 	std::vector <int> cell_array(0);
+	std::vector <uint32_t> uniaxial_anisotropy_axis_array(0);
 
 	std::vector <double> x_spin_array(0);
 	std::vector <double> y_spin_array(0);
 	std::vector <double> z_spin_array(0);
    std::vector <double> m_spin_array(0);
+   std::vector <double> interleaved_spin_array(0);
 
 	std::vector <double> x_total_spin_field_array(0);		/// Total spin dependent fields
 	std::vector <double> y_total_spin_field_array(0);		/// Total spin dependent fields
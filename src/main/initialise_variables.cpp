@@ -554,6 +554,22 @@ int set_derived_parameters(){
 
 			}
 		}
+      // Per-atom easy axes: evaluate the uniaxial term along the local axis of each atom
+      if(sim::local_anisotropy_axis==true && sim::AnisotropyType!=2){
+         for(int mat=0;mat<mp::num_materials; mat++){
+            if(mp::material[mat].KuVec_SI.size()!=0){
+               terminaltextcolor(RED);
+               std::cerr << "Error - material[" << mat+1 << "]:uniaxial-anisotropy-tensor cannot be combined with uniaxial-anisotropy-direction-dispersion. Exiting." << std::endl;
+               terminaltextcolor(WHITE);
+               zlog << zTs() << "Error - material[" << mat+1 << "]:uniaxial-anisotropy-tensor cannot be combined with uniaxial-anisotropy-direction-dispersion. Exiting." << std::endl;
+               err::vexit();
+            }
+         }
+         zlog << zTs() << "Setting local uniaxial anisotropy with per-atom easy axes." << std::endl;
+         sim::AnisotropyType=3;
+         MaterialScalarAnisotropyArray.resize(mp::num_materials);
+         for(int mat=0;mat<mp::num_materials; mat++) MaterialScalarAnisotropyArray[mat].K=mp::material[mat].Ku;
+      }
       // Unroll second order uniaxial anisotropy values for speed
       if(sim::second_order_uniaxial_anisotropy==true){
          zlog << zTs() << "Setting scalar second order uniaxial anisotropy." << std::endl;
@@ -561,7 +577,7 @@ int set_derived_parameters(){
          for(int mat=0;mat<mp::num_materials; mat++) mp::material_second_order_anisotropy_constant_array.at(mat)=mp::material[mat].Ku2;
       }
 	  // Unroll sixth order uniaxial anisotropy values for speed
-      if(sim::second_order_uniaxial_anisotropy==true){
+      if(sim::sixth_order_uniaxial_anisotropy==true){
          zlog << zTs() << "Setting scalar sixth order uniaxial anisotropy." << std::endl;
          mp::material_sixth_order_anisotropy_constant_array.resize(mp::num_materials);
          for(int mat=0;mat<mp::num_materials; mat++) mp::material_sixth_order_anisotropy_constant_array.at(mat)=mp::material[mat].Ku3;
@@ -583,6 +599,15 @@ int set_derived_parameters(){
 			for(int mat=0;mat<mp::num_materials; mat++) MaterialCubicAnisotropyArray.at(mat)=mp::material[mat].Kc;
 		}
 
+      // Initialise temperature rescaling of exchange and anisotropy
+      sim::initialise_interaction_rescaling();
+
+      // Initialise coefficients for single pass uniaxial anisotropy fields
+      sim::initialise_fused_uniaxial_anisotropy();
+
+      // Initialise spin transfer torque coefficients
+      sim::initialise_spin_transfer_torque();
+
 		// Loop over materials to check for invalid input and warn appropriately
 		for(int mat=0;mat<mp::num_materials;mat++){
 			const double lmin=material[mat].min;
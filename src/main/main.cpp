@@ -22,6 +22,7 @@
 //
 // ----------------------------------------------------------------------------
 //
+#include <cstdlib>
 #include <iostream>
 #include <vector>
 #include <sstream>
@@ -43,6 +44,8 @@ int main(int argc, char* argv[]){
    // Check for valid command-line arguments
    //=============================================================
    std::string infile="input";
+   bool dry_run=false; // estimate resources without creating system
+   int dry_run_ranks=0; // number of processors for resource estimate
 
    for(int arg = 1; arg < argc; arg++){
       std::string sw=argv[arg];
@@ -60,6 +63,15 @@ int main(int argc, char* argv[]){
             return EXIT_FAILURE;
          }
       }
+      // estimate resources without creating system
+      else if(sw=="--dry-run"){
+         dry_run=true;
+         // optional number of processors
+         if(arg+1 < argc && atoi(argv[arg+1]) > 0){
+            arg++;
+            dry_run_ranks=atoi(argv[arg]);
+         }
+      }
       else{
          terminaltextcolor(RED);
          std::cerr << "Error - unknown command line parameter \'" << sw << "\'" << std::endl;
@@ -76,6 +88,9 @@ int main(int argc, char* argv[]){
    // Initialise log file
    vout::zLogTsInit(std::string(argv[0]));
 
+   // Start wall time clock and install handlers for checkpoint and exit
+   sim::initialise_graceful_exit();
+
    // Output Program Header
    if(vmpi::my_rank==0){
       std::cout << "                                                _          " << std::endl;
@@ -134,11 +149,20 @@ int main(int argc, char* argv[]){
    // Initialise system
    mp::initialise(infile);
 
-   // Create system
-   cs::create();
+   // Estimate resources for dry run, or create and simulate system
+   if(dry_run){
+      if(dry_run_ranks==0) dry_run_ranks=vmpi::num_processors;
+      cs::estimate_resources(dry_run_ranks);
+   }
+   else{
+
+      // Create system
+      cs::create();
 
-   // Simulate system
-   sim::run();
+      // Simulate system
+      sim::run();
+
+   }
 
    // Finalise MPI
    #ifdef MPICF
@@ -46,6 +46,8 @@ materials_t::materials_t ():
    Klatt(0.0),
 	KuVec(0),
 	UniaxialAnisotropyUnitVector(3),
+	UniaxialAnisotropyDispersion(0.0),
+	UniaxialAnisotropyDispersionPerGrain(true),
 	Kc1_SI(0.0),
 	Kc2_SI(0.0),
 	Ks_SI(0.0),
@@ -77,7 +79,15 @@ materials_t::materials_t ():
 	fmr_field_unit_vector(3,0.0),
    fill(false),
    temperature_rescaling_alpha(1.0),
-   temperature_rescaling_Tc(0.0)
+   temperature_rescaling_Tc(0.0),
+   interaction_rescaling_Tc(0.0),
+   interaction_rescaling_temperature_exponent(1.0),
+   interaction_rescaling_critical_exponent(0.34),
+   exchange_rescaling_exponent(2.0),
+   anisotropy_rescaling_exponent(3.0),
+   stt_efficiency(0.0),
+   stt_field_like_ratio(0.0),
+   stt_polarization_unit_vector(3,0.0)
 	
 	{
 
@@ -110,6 +120,11 @@ materials_t::materials_t ():
 	fmr_field_unit_vector.at(0)=0.0;
 	fmr_field_unit_vector.at(1)=0.0;
 	fmr_field_unit_vector.at(2)=1.0;
+
+	// Spin transfer torque polarisation default initialisation
+	stt_polarization_unit_vector.at(0)=0.0;
+	stt_polarization_unit_vector.at(1)=0.0;
+	stt_polarization_unit_vector.at(2)=1.0;
 }
 
 int materials_t::print(){
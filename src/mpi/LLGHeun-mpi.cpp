@@ -33,6 +33,7 @@
 #include <cmath>
 
 int calculate_spin_fields(const int,const int);
+void pack_interleaved_spins(const int,const int);
 int calculate_external_fields(const int,const int);
 int set_LLG();
 int mpi_init_halo_swap();
@@ -56,6 +57,9 @@ int LLG_Heun_mpi(){
 	// Check for initialisation of LLG integration arrays
 	if(LLG_set==false) sim::LLGinit();
 
+	// Spin transfer torque flag
+	const bool stt=sim::spin_transfer_torque;
+
 	//----------------------------------------
 	// Local variables for system generation
 	//----------------------------------------
@@ -88,6 +92,7 @@ int LLG_Heun_mpi(){
 		// Calculate fields (core)
 		//----------------------------------------	
 		
+		pack_interleaved_spins(0,post_comm_ei);
 		calculate_spin_fields(pre_comm_si,pre_comm_ei);
 		calculate_external_fields(pre_comm_si,pre_comm_ei);
 
@@ -103,10 +108,13 @@ int LLG_Heun_mpi(){
 
 			// Store local spin in Sand local field in H
 			const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-			const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+			double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 										atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 										atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+			// Add spin transfer torque field
+			if(stt) sim::add_stt_field(imaterial, S, H);
+
 			// Calculate Delta S
 			xyz[0]=(one_oneplusalpha_sq)*(S[1]*H[2]-S[2]*H[1]) + (alpha_oneplusalpha_sq)*(S[1]*(S[0]*H[1]-S[1]*H[0])-S[2]*(S[2]*H[0]-S[0]*H[2]));
 			xyz[1]=(one_oneplusalpha_sq)*(S[2]*H[0]-S[0]*H[2]) + (alpha_oneplusalpha_sq)*(S[2]*(S[1]*H[2]-S[2]*H[1])-S[0]*(S[0]*H[1]-S[1]*H[0]));
@@ -144,6 +152,7 @@ int LLG_Heun_mpi(){
 		// Calculate fields (boundary)
 		//----------------------------------------	
 		
+		pack_interleaved_spins(post_comm_ei,atoms::num_atoms);
 		calculate_spin_fields(post_comm_si,post_comm_ei);
 		calculate_external_fields(post_comm_si,post_comm_ei);
 
@@ -159,10 +168,13 @@ int LLG_Heun_mpi(){
 
 			// Store local spin in Sand local field in H
 			const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-			const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+			double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 										atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 										atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+			// Add spin transfer torque field
+			if(stt) sim::add_stt_field(imaterial, S, H);
+
 			// Calculate Delta S
 			xyz[0]=(one_oneplusalpha_sq)*(S[1]*H[2]-S[2]*H[1]) + (alpha_oneplusalpha_sq)*(S[1]*(S[0]*H[1]-S[1]*H[0])-S[2]*(S[2]*H[0]-S[0]*H[2]));
 			xyz[1]=(one_oneplusalpha_sq)*(S[2]*H[0]-S[0]*H[2]) + (alpha_oneplusalpha_sq)*(S[2]*(S[1]*H[2]-S[2]*H[1])-S[0]*(S[0]*H[1]-S[1]*H[0]));
@@ -209,6 +221,7 @@ int LLG_Heun_mpi(){
 		// Recalculate spin dependent fields (core)
 		//------------------------------------------
 
+		pack_interleaved_spins(0,post_comm_ei);
 		calculate_spin_fields(pre_comm_si,pre_comm_ei);
 
 		//----------------------------------------
@@ -223,10 +236,13 @@ int LLG_Heun_mpi(){
 
 			// Store local spin in Sand local field in H
 			const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-			const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+			double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 										atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 										atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+			// Add spin transfer torque field
+			if(stt) sim::add_stt_field(imaterial, S, H);
+
 			// Calculate Delta S
 			xyz[0]=(one_oneplusalpha_sq)*(S[1]*H[2]-S[2]*H[1]) + (alpha_oneplusalpha_sq)*(S[1]*(S[0]*H[1]-S[1]*H[0])-S[2]*(S[2]*H[0]-S[0]*H[2]));
 			xyz[1]=(one_oneplusalpha_sq)*(S[2]*H[0]-S[0]*H[2]) + (alpha_oneplusalpha_sq)*(S[2]*(S[1]*H[2]-S[2]*H[1])-S[0]*(S[0]*H[1]-S[1]*H[0]));
@@ -238,6 +254,12 @@ int LLG_Heun_mpi(){
 			z_heun_array[atom]=xyz[2];
 		}
 
+		//------------------------------------------
+		// Produce next thermal noise while halo
+		// data is in transit
+		//------------------------------------------
+		sim::produce_thermal_noise();
+
 		//------------------------------------------
 		// Complete second halo swap
 		//------------------------------------------
@@ -247,6 +269,7 @@ int LLG_Heun_mpi(){
 		// Recalculate spin dependent fields (boundary)
 		//------------------------------------------
 
+		pack_interleaved_spins(post_comm_ei,atoms::num_atoms);
 		calculate_spin_fields(post_comm_si,post_comm_ei);
 
 		//----------------------------------------
@@ -261,10 +284,13 @@ int LLG_Heun_mpi(){
 
 			// Store local spin in Sand local field in H
 			const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-			const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+			double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 										atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 										atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+			// Add spin transfer torque field
+			if(stt) sim::add_stt_field(imaterial, S, H);
+
 			// Calculate Delta S
 			xyz[0]=(one_oneplusalpha_sq)*(S[1]*H[2]-S[2]*H[1]) + (alpha_oneplusalpha_sq)*(S[1]*(S[0]*H[1]-S[1]*H[0])-S[2]*(S[2]*H[0]-S[0]*H[2]));
 			xyz[1]=(one_oneplusalpha_sq)*(S[2]*H[0]-S[0]*H[2]) + (alpha_oneplusalpha_sq)*(S[2]*(S[1]*H[2]-S[2]*H[1])-S[0]*(S[0]*H[1]-S[1]*H[0]));
@@ -280,6 +306,10 @@ int LLG_Heun_mpi(){
 		// Calculate Heun Step
 		//----------------------------------------	
 
+		// Sum of moments for LaGrange multiplier
+		const bool lagrange=sim::lagrange_multiplier;
+		double lm[4]={0.0,0.0,0.0,0.0};
+
 		for(int atom=pre_comm_si;atom<post_comm_ei;atom++){
 			S_new[0]=x_initial_spin_array[atom]+material_parameters::half_dt*(x_euler_array[atom]+x_heun_array[atom]);
 			S_new[1]=y_initial_spin_array[atom]+material_parameters::half_dt*(y_euler_array[atom]+y_heun_array[atom]);
@@ -298,6 +328,21 @@ int LLG_Heun_mpi(){
 			atoms::x_spin_array[atom]=S_new[0];
 			atoms::y_spin_array[atom]=S_new[1];
 			atoms::z_spin_array[atom]=S_new[2];
+
+			// Add moment to system magnetisation
+			if(lagrange){
+				const double mu=atoms::m_spin_array[atom];
+				lm[0]+=S_new[0]*mu;
+				lm[1]+=S_new[1]*mu;
+				lm[2]+=S_new[2]*mu;
+				lm[3]+=mu;
+			}
+		}
+
+		// Save sum of moments for LaGrange multiplier update
+		if(lagrange){
+			for(int i=0;i<4;i++) sim::lagrange_local_moment[i]=lm[i];
+			sim::lagrange_local_moment_set=true;
 		}
 
 	// Swap timers compute -> wait
@@ -35,6 +35,7 @@
 #include <cmath>
 
 int calculate_spin_fields(const int,const int);
+void pack_interleaved_spins(const int,const int);
 int calculate_external_fields(const int,const int);
 int set_LLG();
 int mpi_init_halo_swap();
@@ -52,6 +53,9 @@ int LLG_Midpoint_mpi(){
 	// Check for initialisation of LLG integration arrays
 	if(LLG_set==false) sim::LLGinit();
 
+	// Spin transfer torque flag
+	const bool stt=sim::spin_transfer_torque;
+
 	// Local variables for core / boundary integration
 	const int pre_comm_si = 0;
 	const int pre_comm_ei = vmpi::num_core_atoms;
@@ -69,6 +73,7 @@ int LLG_Midpoint_mpi(){
 		}
 		
 	// Calculate fields (core)	
+	pack_interleaved_spins(0,post_comm_ei);
 	calculate_spin_fields(pre_comm_si,pre_comm_ei);
 	calculate_external_fields(pre_comm_si,pre_comm_ei);
 
@@ -82,10 +87,13 @@ int LLG_Midpoint_mpi(){
 		
 		// Store local spin in S and local field in H
 		const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field
+		if(stt) sim::add_stt_field(imaterial, S, H);
+
 		// Calculate F = [H + alpha* (S x H)]
 		const double F[3] = {H[0] + alpha*(S[1]*H[2]-S[2]*H[1]),
 									H[1] + alpha*(S[2]*H[0]-S[0]*H[2]),
@@ -108,6 +116,7 @@ int LLG_Midpoint_mpi(){
 	mpi_complete_halo_swap();
 
 	// Calculate fields (boundary)
+	pack_interleaved_spins(post_comm_ei,atoms::num_atoms);
 	calculate_spin_fields(post_comm_si,post_comm_ei);
 	calculate_external_fields(post_comm_si,post_comm_ei);
 
@@ -121,10 +130,13 @@ int LLG_Midpoint_mpi(){
 		
 		// Store local spin in S and local field in H
 		const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field
+		if(stt) sim::add_stt_field(imaterial, S, H);
+
 		// Calculate F = [H + alpha* (S x H)]
 		const double F[3] = {H[0] + alpha*(S[1]*H[2]-S[2]*H[1]),
 									H[1] + alpha*(S[2]*H[0]-S[0]*H[2]),
@@ -153,6 +165,7 @@ int LLG_Midpoint_mpi(){
 	mpi_init_halo_swap();
 
 	// Recalculate spin dependent fields (core)
+	pack_interleaved_spins(0,post_comm_ei);
 	calculate_spin_fields(pre_comm_si,pre_comm_ei);
 
 	// Calculate Corrector Step (core)
@@ -166,10 +179,13 @@ int LLG_Midpoint_mpi(){
 		// Store local spin in S and local field in H
 		const double M[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
 		const double S[3] = {x_initial_spin_array[atom],y_initial_spin_array[atom],z_initial_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field a_j (M x p) + b_j p
+		if(stt) sim::add_stt_field(imaterial, M, H);
+
 		// Calculate F = [H + alpha* (M x H)]
 		const double F[3] = {H[0] + alpha*(M[1]*H[2]-M[2]*H[1]),
 									H[1] + alpha*(M[2]*H[0]-M[0]*H[2]),
@@ -186,10 +202,14 @@ int LLG_Midpoint_mpi(){
 		z_spin_storage_array[atom] = one_o_one_plus_beta2FdotF*(S[2]*one_minus_beta2FdotF + 2.0*(beta*(F[0]*S[1]-F[1]*S[0]) + F[2]*beta2FdotS));
 	}
 
+	// Produce next thermal noise while halo data is in transit
+	sim::produce_thermal_noise();
+
 	// Complete second halo swap
 	mpi_complete_halo_swap();
 
 	// Recalculate spin dependent fields (boundary)
+	pack_interleaved_spins(post_comm_ei,atoms::num_atoms);
 	calculate_spin_fields(post_comm_si,post_comm_ei);
 
 	// Calculate Corrector Step (boundary)
@@ -203,10 +223,13 @@ int LLG_Midpoint_mpi(){
 		// Store local spin in S and local field in H
 		const double M[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
 		const double S[3] = {x_initial_spin_array[atom],y_initial_spin_array[atom],z_initial_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field a_j (M x p) + b_j p
+		if(stt) sim::add_stt_field(imaterial, M, H);
+
 		// Calculate F = [H + alpha* (M x H)]
 		const double F[3] = {H[0] + alpha*(M[1]*H[2]-M[2]*H[1]),
 									H[1] + alpha*(M[2]*H[0]-M[0]*H[2]),
@@ -223,11 +246,30 @@ int LLG_Midpoint_mpi(){
 		z_spin_storage_array[atom] = one_o_one_plus_beta2FdotF*(S[2]*one_minus_beta2FdotF + 2.0*(beta*(F[0]*S[1]-F[1]*S[0]) + F[2]*beta2FdotS));
 	}
 	
+	// Sum of moments for LaGrange multiplier
+	const bool lagrange=sim::lagrange_multiplier;
+	double lm[4]={0.0,0.0,0.0,0.0};
+
 	// Copy new spins to spin array (all)
 	for(int atom=pre_comm_si;atom<post_comm_ei;atom++){
 		atoms::x_spin_array[atom]=x_spin_storage_array[atom];
 		atoms::y_spin_array[atom]=y_spin_storage_array[atom];
 		atoms::z_spin_array[atom]=z_spin_storage_array[atom];
+
+		// Add moment to system magnetisation
+		if(lagrange){
+			const double mu=atoms::m_spin_array[atom];
+			lm[0]+=x_spin_storage_array[atom]*mu;
+			lm[1]+=y_spin_storage_array[atom]*mu;
+			lm[2]+=z_spin_storage_array[atom]*mu;
+			lm[3]+=mu;
+		}
+	}
+
+	// Save sum of moments for LaGrange multiplier update
+	if(lagrange){
+		for(int i=0;i<4;i++) sim::lagrange_local_moment[i]=lm[i];
+		sim::lagrange_local_moment_set=true;
 	}
 
 	// Wait for other processors
@@ -30,6 +30,8 @@
 #include "errors.hpp"
 #include "vio.hpp"
 #include "vmpi.hpp"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <list>
 #include <vector>
@@ -60,11 +62,11 @@ namespace vmpi{
 	double MaximumComputeTime;
 	double MaximumWaitTime;
 	bool DetailedMPITiming=false;
-	std::vector<double> ComputeTimeArray(0);
-	std::vector<double> WaitTimeArray(0);
 
 	double min_dimensions[3]; ///< Minimum coordinates of system on local cpu
 	double max_dimensions[3]; ///< Maximum coordinates of system on local cpu
+	int decomposition_grid[3]={1,1,1}; ///< Number of cpus in x,y,z for geometric decomposition
+	double decomposition_cell_size[3]={0.0,0.0,0.0}; ///< Size of local cpu domain in x,y,z
 	
 	std::vector<int> send_atom_translation_array;
 	std::vector<int> send_start_index_array;
@@ -95,7 +97,7 @@ namespace vmpi{
 
 	// set local variables
 	int x=num_cpus;
-	int nx,ny,nz;	/// Number of cpus in x,y,z
+	int nx=1,ny=1,nz=1;	/// Number of cpus in x,y,z
 	std::vector<int> factor_array; /// to store the factors of each given n_cpu
 	factor_array.reserve(50);
 	int counter_factor=0; /// to count the number of factors
@@ -198,6 +200,14 @@ namespace vmpi{
 	vmpi::max_dimensions[0]=x2;
 	vmpi::max_dimensions[1]=y2;
 	vmpi::max_dimensions[2]=z2;
+
+	// save decomposition grid for calculation of remote cpu ranges
+	vmpi::decomposition_grid[0]=nx;
+	vmpi::decomposition_grid[1]=ny;
+	vmpi::decomposition_grid[2]=nz;
+	vmpi::decomposition_cell_size[0]=dx;
+	vmpi::decomposition_cell_size[1]=dy;
+	vmpi::decomposition_cell_size[2]=dz;
 	
 	return EXIT_SUCCESS;
 
@@ -418,7 +428,7 @@ void atom_needed_by_remote_cpu(int atom, // atom number
                                int scz_offset,
                                std::vector<cs::catom_t> & catom_array,
                                std::vector<std::vector<virtual_particle_t> >& virtual_particle_array, 
-                               std::vector<double> minimax,
+                               const double minimax[6],
                                bool self_interaction
                               ){
 
@@ -473,46 +483,80 @@ int copy_halo_atoms(std::vector<cs::catom_t> & catom_array){
 		catom_array[atom].mpi_cpuid = vmpi::my_rank;
 	}
 
-	// Array to store all interaction ranges
-	std::vector<double> cpu_range_array(6*vmpi::num_processors,0.0); // Linear Memory for MPI comms
-	
-	// Determine range+interaction range of all CPU's
-	double max_interaction_range=double(cs::unit_cell.interaction_range);
-	
-	// Populate local ranges
-	cpu_range_array[6*vmpi::my_rank+0]=vmpi::min_dimensions[0] - max_interaction_range*cs::unit_cell.dimensions[0]-0.01;
-	cpu_range_array[6*vmpi::my_rank+1]=vmpi::min_dimensions[1] - max_interaction_range*cs::unit_cell.dimensions[1]-0.01;
-	cpu_range_array[6*vmpi::my_rank+2]=vmpi::min_dimensions[2] - max_interaction_range*cs::unit_cell.dimensions[2]-0.01;
-	cpu_range_array[6*vmpi::my_rank+3]=vmpi::max_dimensions[0] + max_interaction_range*cs::unit_cell.dimensions[0]+0.01;
-	cpu_range_array[6*vmpi::my_rank+4]=vmpi::max_dimensions[1] + max_interaction_range*cs::unit_cell.dimensions[1]+0.01;
-	cpu_range_array[6*vmpi::my_rank+5]=vmpi::max_dimensions[2] + max_interaction_range*cs::unit_cell.dimensions[2]+0.01;
-	
-	// Reduce data on all CPUs
-	MPI::COMM_WORLD.Allreduce(MPI_IN_PLACE, &cpu_range_array[0],6*vmpi::num_processors, MPI_DOUBLE,MPI_SUM);
-	
-   // Copy ranges to 2D array
-   std::vector<std::vector<double> > cpu_range_array2D(vmpi::num_processors);
-   for(int cpu=0; cpu< vmpi::num_processors; cpu++){
-      cpu_range_array2D[cpu].resize(6);
-      cpu_range_array2D[cpu][0]=cpu_range_array[6*cpu+0];
-      cpu_range_array2D[cpu][1]=cpu_range_array[6*cpu+1];
-      cpu_range_array2D[cpu][2]=cpu_range_array[6*cpu+2];
-      cpu_range_array2D[cpu][3]=cpu_range_array[6*cpu+3];
-      cpu_range_array2D[cpu][4]=cpu_range_array[6*cpu+4];
-      cpu_range_array2D[cpu][5]=cpu_range_array[6*cpu+5];
+   // Determine range+interaction range of all CPU's
+   const double max_interaction_range=double(cs::unit_cell.interaction_range);
+
+   //----------------------------------------------------------------------------
+   // The range of each cpu follows from the decomposition grid, so that the
+   // ranges of remote cpus can be calculated locally rather than reduced
+   // across all cpus. The ranges are stored per axis as the range of a cpu is
+   // the product of the ranges of its grid coordinates.
+   //----------------------------------------------------------------------------
+   const int grid[3] = {vmpi::decomposition_grid[0], vmpi::decomposition_grid[1], vmpi::decomposition_grid[2]};
+   std::vector<std::vector<double> > grid_min(3);
+   std::vector<std::vector<double> > grid_max(3);
+   for(int i=0; i<3; i++){
+      const double d = vmpi::decomposition_cell_size[i];
+      grid_min[i].resize(grid[i]);
+      grid_max[i].resize(grid[i]);
+      for(int g=0; g<grid[i]; g++){
+         // same arithmetic as geometric_decomposition for consistent ranges
+         const double cpu_min=double(g)*d;
+         const double cpu_max=double(cpu_min)+d;
+         grid_min[i][g]=cpu_min - max_interaction_range*cs::unit_cell.dimensions[i]-0.01;
+         grid_max[i][g]=cpu_max + max_interaction_range*cs::unit_cell.dimensions[i]+0.01;
+      }
+   }
+
+   // Calculate grid coordinates of local cpu
+   const int my_grid[3] = { (vmpi::my_rank%(grid[0]*grid[1]))/grid[1],
+                            (vmpi::my_rank%(grid[0]*grid[1]))%grid[1],
+                             vmpi::my_rank/(grid[0]*grid[1]) };
+
+   //----------------------------------------------------------------------------
+   // Determine neighbouring cpus which may share halo atoms with the local
+   // cpu, including periodic images. Cpus are neighbours if they are within
+   // the interaction range (plus a safety margin of one cpu) along all
+   // three axes. The relation is symmetric and so the same list is used for
+   // sending and receiving. The list includes the local cpu which may need
+   // its own atoms as periodic images.
+   //----------------------------------------------------------------------------
+   std::vector<std::vector<int> > grid_neighbours(3);
+   for(int i=0; i<3; i++){
+      const double range=max_interaction_range*cs::unit_cell.dimensions[i]+0.01;
+      const int reach=int(ceil(range/vmpi::decomposition_cell_size[i]))+1;
+      std::vector<bool> axis_neighbour(grid[i],false);
+      for(int offset=-reach; offset<=reach; offset++){
+         int g=my_grid[i]+offset;
+         if(cs::pbc[i]==true) g=((g%grid[i])+grid[i])%grid[i];
+         if(g>=0 && g<grid[i]) axis_neighbour[g]=true;
+      }
+      for(int g=0; g<grid[i]; g++) if(axis_neighbour[g]) grid_neighbours[i].push_back(g);
+   }
+
+   std::vector<int> neighbours;
+   for(unsigned int gz=0; gz<grid_neighbours[2].size(); gz++){
+      for(unsigned int gx=0; gx<grid_neighbours[0].size(); gx++){
+         for(unsigned int gy=0; gy<grid_neighbours[1].size(); gy++){
+            neighbours.push_back(grid_neighbours[2][gz]*grid[0]*grid[1]+grid_neighbours[0][gx]*grid[1]+grid_neighbours[1][gy]);
+         }
+      }
    }
+   // sort list so that data are packed in order of cpu
+   std::sort(neighbours.begin(),neighbours.end());
+
+   // Mark neighbouring cpus to check for atoms needed by other cpus
+   std::vector<bool> is_neighbour(vmpi::num_processors,false);
+   for(unsigned int n=0; n<neighbours.size(); n++) is_neighbour[neighbours[n]]=true;
 
-	// Determine number of atoms on local CPU needed by other CPUs
-	std::vector<int> num_send_atoms(vmpi::num_processors,0);
-	std::vector<int> num_recv_atoms(vmpi::num_processors,0);
+   // Determine number of atoms on local CPU needed by other CPUs
+   std::vector<int> num_send_atoms(vmpi::num_processors,0);
+   std::vector<int> num_recv_atoms(vmpi::num_processors,0);
 
    // Declare array of virtual particles
    std::vector<std::vector<virtual_particle_t> >virtual_particle_array;
    virtual_particle_array.resize(vmpi::num_processors);
 
-   // Array of minima, maxima
-   std::vector<double> minimax;
-
    // Real offsets for periodic boundary calculations
    const double dx = cs::system_dimensions[0];
    const double dy = cs::system_dimensions[1];
@@ -523,79 +567,74 @@ int copy_halo_atoms(std::vector<cs::catom_t> & catom_array){
    const int sy = cs::total_num_unit_cells[1];
    const int sz = cs::total_num_unit_cells[2];
 
-   for(unsigned int atom=0;atom<catom_array.size();atom++){
-      const double x = catom_array[atom].x;
-      const double y = catom_array[atom].y;
-      const double z = catom_array[atom].z;
-      for(int cpu=0;cpu<vmpi::num_processors;cpu++){
-
-         // Copy minima/maxima
-         minimax=cpu_range_array2D[cpu];
+   // Periodic image shifts in order of original search
+   const int num_shifts=27;
+   const int shifts[num_shifts][3]={ { 0, 0, 0},
+                                     { 1, 0, 0}, {-1, 0, 0}, { 0, 1, 0}, { 0,-1, 0}, { 0, 0, 1}, { 0, 0,-1},
+                                     { 1, 1, 0}, {-1, 1, 0}, { 1,-1, 0}, {-1,-1, 0},
+                                     { 1, 0, 1}, {-1, 0, 1}, { 1, 0,-1}, {-1, 0,-1},
+                                     { 0, 1, 1}, { 0,-1, 1}, { 0, 1,-1}, { 0,-1,-1},
+                                     {-1,-1,-1}, { 1,-1,-1}, {-1, 1,-1}, { 1, 1,-1},
+                                     {-1,-1, 1}, { 1,-1, 1}, {-1, 1, 1}, { 1, 1, 1} };
 
-         // Populate virtual particles
-         atom_needed_by_remote_cpu(atom, cpu, x, y, z, 0, 0, 0, catom_array, virtual_particle_array, minimax, false);
-
-         // Move atoms by +/- unit cell dimensions in different directions to calculate periodic boundaries
-         if(cs::pbc[0]==true){
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y, z, sx, 0, 0, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y, z,-sx, 0, 0, catom_array, virtual_particle_array, minimax, true);
-         }
-
-         if(cs::pbc[1]==true){
-            atom_needed_by_remote_cpu(atom, cpu, x, y+dy, z, 0, sy, 0, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x, y-dy, z, 0,-sy, 0, catom_array, virtual_particle_array, minimax, true);
-         }
-
-         if(cs::pbc[2]==true){
-            atom_needed_by_remote_cpu(atom, cpu, x, y, z+dz, 0, 0, sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x, y, z-dz, 0, 0, -sz, catom_array, virtual_particle_array, minimax, true);
-         }
-
-         if( cs::pbc[0]==true && cs::pbc[1]==true ){
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y+dy, z, sx, sy, 0, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y+dy, z,-sx, sy, 0, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y-dy, z, sx,-sy, 0, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y-dy, z,-sx,-sy, 0, catom_array, virtual_particle_array, minimax, true);
-         }
-
-         if( cs::pbc[0]==true && cs::pbc[2]==true ){
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y, z+dz, sx, 0, sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y, z+dz,-sx, 0, sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y, z-dz, sx, 0,-sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y, z-dz,-sx, 0,-sz, catom_array, virtual_particle_array, minimax, true);
-         }
-
-         if( cs::pbc[1]==true && cs::pbc[2]==true ){
-            atom_needed_by_remote_cpu(atom, cpu, x, y+dy, z+dz, 0, sy, sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x, y-dy, z+dz, 0,-sy, sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x, y+dy, z-dz, 0, sy,-sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x, y-dy, z-dz, 0,-sy,-sz, catom_array, virtual_particle_array, minimax, true);
+   for(unsigned int atom=0;atom<catom_array.size();atom++){
+      for(int shift=0; shift<num_shifts; shift++){
+
+         // Skip periodic images along non-periodic directions
+         if( (shifts[shift][0]!=0 && cs::pbc[0]==false) ||
+             (shifts[shift][1]!=0 && cs::pbc[1]==false) ||
+             (shifts[shift][2]!=0 && cs::pbc[2]==false) ) continue;
+
+         // Move atoms by +/- system dimensions in different directions to calculate periodic boundaries
+         const double x = catom_array[atom].x+double(shifts[shift][0])*dx;
+         const double y = catom_array[atom].y+double(shifts[shift][1])*dy;
+         const double z = catom_array[atom].z+double(shifts[shift][2])*dz;
+         const double r[3] = {x, y, z};
+
+         // Determine range of grid coordinates of cpus which may need atom
+         int min_grid[3];
+         int max_grid[3];
+         for(int i=0; i<3; i++){
+            const double d = vmpi::decomposition_cell_size[i];
+            const double range=max_interaction_range*cs::unit_cell.dimensions[i]+0.01;
+            min_grid[i] = int(floor((r[i]-range)/d))-1;
+            max_grid[i] = int(floor((r[i]+range)/d))+1;
+            if(min_grid[i]<0) min_grid[i]=0;
+            if(max_grid[i]>grid[i]-1) max_grid[i]=grid[i]-1;
          }
 
-         if( cs::pbc[0]==true && cs::pbc[1]==true && cs::pbc[2]==true){
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y-dy, z-dz, -sx, -sy, -sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y-dy, z-dz, +sx, -sy, -sz, catom_array, virtual_particle_array, minimax, true);
-
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y+dy, z-dz, -sx, +sy, -sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y+dy, z-dz, +sx, +sy, -sz, catom_array, virtual_particle_array, minimax, true);
-
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y-dy, z+dz, -sx, -sy, +sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y-dy, z+dz, +sx, -sy, +sz, catom_array, virtual_particle_array, minimax, true);
-
-            atom_needed_by_remote_cpu(atom, cpu, x-dx, y+dy, z+dz, -sx, +sy, +sz, catom_array, virtual_particle_array, minimax, true);
-            atom_needed_by_remote_cpu(atom, cpu, x+dx, y+dy, z+dz, +sx, +sy, +sz, catom_array, virtual_particle_array, minimax, true);
+         // Populate virtual particles
+         for(int gz=min_grid[2]; gz<=max_grid[2]; gz++){
+            for(int gx=min_grid[0]; gx<=max_grid[0]; gx++){
+               for(int gy=min_grid[1]; gy<=max_grid[1]; gy++){
+                  const int cpu = gz*grid[0]*grid[1]+gx*grid[1]+gy;
+                  const double minimax[6]={grid_min[0][gx], grid_min[1][gy], grid_min[2][gz], grid_max[0][gx], grid_max[1][gy], grid_max[2][gz]};
+                  atom_needed_by_remote_cpu(atom, cpu, x, y, z, shifts[shift][0]*sx, shifts[shift][1]*sy, shifts[shift][2]*sz,
+                                            catom_array, virtual_particle_array, minimax, shift!=0);
+               }
+            }
          }
       }
    }
 
    // Calulate number of virtual particles for each cpu
-   for(int cpu=0;cpu<vmpi::num_processors;cpu++) num_send_atoms[cpu]=virtual_particle_array[cpu].size();
+   for(int cpu=0;cpu<vmpi::num_processors;cpu++){
+      num_send_atoms[cpu]=virtual_particle_array[cpu].size();
+      // Check that atoms are only needed by neighbouring cpus
+      if(num_send_atoms[cpu]>0 && is_neighbour[cpu]==false){
+         terminaltextcolor(RED);
+         std::cerr << "Error - atoms on cpu " << vmpi::my_rank << " needed by non-neighbouring cpu " << cpu << " in halo calculation" << std::endl;
+         terminaltextcolor(WHITE);
+         err::vexit();
+      }
+   }
 
    std::vector<MPI::Request> requests(0);
    std::vector<MPI::Status> stati(0);
 
-   // Send/receive number of boundary/halo atoms
-   for(int cpu=0;cpu<vmpi::num_processors;cpu++){
+   // Send/receive number of boundary/halo atoms with neighbouring cpus only
+   for(unsigned int n=0;n<neighbours.size();n++){
+      const int cpu=neighbours[n];
       requests.push_back(MPI::COMM_WORLD.Isend(&num_send_atoms[cpu],1,MPI_INT,cpu,35));
       requests.push_back(MPI::COMM_WORLD.Irecv(&num_recv_atoms[cpu],1,MPI_INT,cpu,35));
    }
@@ -606,7 +645,8 @@ int copy_halo_atoms(std::vector<cs::catom_t> & catom_array){
    // Calculate total number of boundary and halo atoms on local CPU
    int num_halo_atoms=0;
    int num_bdry_atoms=0;
-   for(int cpu=0;cpu<vmpi::num_processors;cpu++){
+   for(unsigned int n=0;n<neighbours.size();n++){
+      const int cpu=neighbours[n];
       num_halo_atoms += num_recv_atoms[cpu];
       num_bdry_atoms += num_send_atoms[cpu];
    }
@@ -653,7 +693,8 @@ int copy_halo_atoms(std::vector<cs::catom_t> & catom_array){
          }
    }*/
 
-   for(int cpu=0;cpu<vmpi::num_processors;cpu++){
+   for(unsigned int n=0;n<neighbours.size();n++){
+      const int cpu=neighbours[n];
       for(int vpidx=0; vpidx<virtual_particle_array[cpu].size(); vpidx++){
          send_mpi_atom_num_array[counter]           = virtual_particle_array[cpu][vpidx].atom;
          send_coord_array[3*counter+0]              = virtual_particle_array[cpu][vpidx].x;
@@ -673,7 +714,8 @@ int copy_halo_atoms(std::vector<cs::catom_t> & catom_array){
    int recv_index=0;
 
    // Exchange boundary/halo data
-   for(int cpu=0;cpu<vmpi::num_processors;cpu++){
+   for(unsigned int n=0;n<neighbours.size();n++){
+      const int cpu=neighbours[n];
       if(num_send_atoms[cpu]>0){
          requests.push_back(MPI::COMM_WORLD.Isend(&send_coord_array[3*send_index],3*num_send_atoms[cpu],MPI_DOUBLE,cpu,50));
          requests.push_back(MPI::COMM_WORLD.Isend(&send_mpi_atom_supercell_array[3*send_index],3*num_send_atoms[cpu],MPI_INT,cpu,54));
@@ -130,56 +130,8 @@ int finalise(){
    MPI::COMM_WORLD.Barrier();
 
 	
-	// Output MPI Timings to disk
-	// Get sizes of arrays
-	//std::vector<int> sizes(vmpi::num_processors);
-	//int MPITimingDataSize = ComputeTimeArray.size();
-	
-	// MPI_Gather (&sendbuf,sendcnt,sendtype,&recvbuf, recvcount,recvtype,root,comm)
-	//MPI_Gather(&MPITimingDataSize,1,MPI_INT,&sizes[0],1,MPI_INT,0,MPI_COMM_WORLD); 
-	//for(int p=0; p<vmpi::num_processors;p++){
-	//	std::cout << "node01:" << p << " " << sizes.at(p) << std::endl;
-	//}
-	
-	// Gather timings
-	if(DetailedMPITiming){
-		std::vector<double> AllTimes(0);
-		if(my_rank==0) AllTimes.resize(num_processors*WaitTimeArray.size());
-		
-		MPI_Gather(&WaitTimeArray[0],WaitTimeArray.size(),MPI_DOUBLE,&AllTimes[0],WaitTimeArray.size(),MPI_DOUBLE,0,MPI_COMM_WORLD); 
-
-		if(my_rank==0){
-			std::ofstream WaitTimesOFS;
-			WaitTimesOFS.open("MPI-wait-times");
-		
-			// Column Row format
-			for(int idx=0;idx<WaitTimeArray.size();idx++){
-				WaitTimesOFS << idx << "\t";
-				for(int p=0;p<vmpi::num_processors;p++){
-					WaitTimesOFS << AllTimes.at(idx+p*WaitTimeArray.size()) << "\t";
-				}
-				WaitTimesOFS << std::endl;
-			}
-			WaitTimesOFS.close();
-		}
-		
-		MPI_Gather(&ComputeTimeArray[0],ComputeTimeArray.size(),MPI_DOUBLE,&AllTimes[0],ComputeTimeArray.size(),MPI_DOUBLE,0,MPI_COMM_WORLD); 
-
-		if(my_rank==0){
-			std::ofstream ComputeTimesOFS;
-			ComputeTimesOFS.open("MPI-compute-times");
-		
-			// Column Row format
-			for(int idx=0;idx<ComputeTimeArray.size();idx++){
-				ComputeTimesOFS << idx << "\t";
-				for(int p=0;p<vmpi::num_processors;p++){
-					ComputeTimesOFS << AllTimes.at(idx+p*ComputeTimeArray.size()) << "\t";
-				}
-				ComputeTimesOFS << std::endl;
-			}
-			ComputeTimesOFS.close();
-		}
-	}
+	// Output MPI timing report to disk
+	if(DetailedMPITiming) vmpi::output_timing_statistics();
 	
 	// Stop MPI Timer and output to screen
 	vmpi::end_time=MPI_Wtime();
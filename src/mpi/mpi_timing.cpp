@@ -0,0 +1,311 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Bounded memory statistics of MPI compute and wait times.
+//
+//   At every data output step the compute and wait times of each processor
+//   since the last output are added to fixed size streaming summaries:
+//
+//      - per processor count, minimum, maximum and total time
+//      - per processor logarithmically binned histograms of times
+//      - a decimated time series of the minimum, mean and maximum times
+//        across processors, stored on the root process
+//
+//   The memory used is independent of the length of the simulation, so that
+//   detailed timing can be left on for production runs. The summaries are
+//   reduced periodically (and at the end of the simulation) to write a
+//   compact load imbalance report to the file mpi-timings.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <vector>
+
+// Vampire Header files
+#include "errors.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+#ifdef MPICF
+namespace vmpi{
+
+   namespace internal{
+
+      //-----------------------------------------------------------------------
+      // Histogram parameters: 4 bins per decade from 1 us to 10^5 s plus
+      // underflow and overflow bins
+      //-----------------------------------------------------------------------
+      const int bins_per_decade=4;
+      const double histogram_min_time=1.0e-6;
+      const int num_decades=11;
+      const int num_bins=num_decades*bins_per_decade+2;
+
+      const int max_series_length=512; // maximum number of time series points
+      const int report_rate=100; // number of samples between reports
+
+      //-----------------------------------------------------------------------
+      // Streaming summary of a timing quantity on the local processor
+      //-----------------------------------------------------------------------
+      class timing_summary_t{
+
+      public:
+
+         double count; // number of samples
+         double min; // minimum time
+         double max; // maximum time
+         double total; // total time
+         std::vector<double> histogram; // log binned histogram
+
+         timing_summary_t(): count(0.0), min(0.0), max(0.0), total(0.0), histogram(num_bins,0.0) {}
+
+         // Function to add a sample to the summary
+         void add(const double time){
+            if(count==0.0 || time<min) min=time;
+            if(count==0.0 || time>max) max=time;
+            count+=1.0;
+            total+=time;
+            histogram[bin(time)]+=1.0;
+         }
+
+         // Function to determine histogram bin of a time
+         static int bin(const double time){
+            if(time<histogram_min_time) return 0;
+            const int b=1+int(floor(double(bins_per_decade)*log10(time/histogram_min_time)));
+            if(b>num_bins-1) return num_bins-1;
+            return b;
+         }
+
+      };
+
+      //-----------------------------------------------------------------------
+      // Point in the decimated time series of times across processors
+      //-----------------------------------------------------------------------
+      struct series_point_t{
+
+         uint64_t time; // last time step in point
+         double samples; // number of samples in point
+         double compute[3]; // min, mean, max compute time per sample
+         double wait[3]; // min, mean, max wait time per sample
+
+      };
+
+      timing_summary_t compute_summary;
+      timing_summary_t wait_summary;
+
+      std::vector<series_point_t> series; // decimated time series (root only)
+      series_point_t series_accumulator; // point being accumulated
+      int series_stride=1; // number of samples per time series point
+      int num_samples=0; // total number of samples
+
+      //-----------------------------------------------------------------------
+      // Function to merge two time series points
+      //-----------------------------------------------------------------------
+      series_point_t merge(const series_point_t& a, const series_point_t& b){
+
+         series_point_t result;
+         result.time=b.time;
+         result.samples=a.samples+b.samples;
+         result.compute[0]=a.compute[0] < b.compute[0] ? a.compute[0] : b.compute[0];
+         result.compute[1]=(a.compute[1]*a.samples+b.compute[1]*b.samples)/result.samples;
+         result.compute[2]=a.compute[2] > b.compute[2] ? a.compute[2] : b.compute[2];
+         result.wait[0]=a.wait[0] < b.wait[0] ? a.wait[0] : b.wait[0];
+         result.wait[1]=(a.wait[1]*a.samples+b.wait[1]*b.samples)/result.samples;
+         result.wait[2]=a.wait[2] > b.wait[2] ? a.wait[2] : b.wait[2];
+
+         return result;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to add a point to the time series, halving the resolution
+      // when the maximum length is reached
+      //-----------------------------------------------------------------------
+      void add_series_point(const series_point_t& point){
+
+         if(series_accumulator.samples==0.0) series_accumulator=point;
+         else series_accumulator=merge(series_accumulator,point);
+
+         if(series_accumulator.samples<double(series_stride)) return;
+
+         series.push_back(series_accumulator);
+         series_accumulator.samples=0.0;
+
+         // decimate series by merging pairs of points
+         if(int(series.size())>=max_series_length){
+            for(unsigned int i=0; i<series.size()/2; i++) series[i]=merge(series[2*i],series[2*i+1]);
+            series.resize(series.size()/2);
+            series_stride*=2;
+         }
+
+         return;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to reduce summaries of a quantity to the root process
+      //-----------------------------------------------------------------------
+      void reduce_summary(const timing_summary_t& summary, double global[6], std::vector<double>& histogram){
+
+         // min and max of sample times, and min and max of total time per processor
+         double local_max[4]={summary.max, -summary.min, summary.total, -summary.total};
+         double global_max[4];
+         MPI_Reduce(local_max,global_max,4,MPI_DOUBLE,MPI_MAX,0,MPI_COMM_WORLD);
+
+         // total time and number of samples
+         double local_sum[2]={summary.total, summary.count};
+         double global_sum[2];
+         MPI_Reduce(local_sum,global_sum,2,MPI_DOUBLE,MPI_SUM,0,MPI_COMM_WORLD);
+
+         histogram.resize(num_bins);
+         MPI_Reduce(const_cast<double*>(&summary.histogram[0]),&histogram[0],num_bins,MPI_DOUBLE,MPI_SUM,0,MPI_COMM_WORLD);
+
+         global[0]=-global_max[1]; // minimum sample
+         global[1]=global_sum[1] > 0.0 ? global_sum[0]/global_sum[1] : 0.0; // mean sample
+         global[2]=global_max[0]; // maximum sample
+         global[3]=-global_max[3]; // minimum total
+         global[4]=global_sum[0]/double(vmpi::num_processors); // mean total
+         global[5]=global_max[2]; // maximum total
+
+         return;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to write the load imbalance report. Must be called by all
+      // processors.
+      //-----------------------------------------------------------------------
+      void write_timing_report(){
+
+         double compute[6], wait[6];
+         std::vector<double> compute_histogram, wait_histogram;
+         reduce_summary(compute_summary, compute, compute_histogram);
+         reduce_summary(wait_summary, wait, wait_histogram);
+
+         if(vmpi::my_rank!=0) return;
+
+         std::ofstream report("mpi-timings");
+
+         report << "#-----------------------------------------------------------" << std::endl;
+         report << "# MPI timing report" << std::endl;
+         report << "#-----------------------------------------------------------" << std::endl;
+         report << "# processors:  " << vmpi::num_processors << std::endl;
+         report << "# samples:     " << num_samples << std::endl;
+         report << "# time step:   " << sim::time << std::endl;
+         report << "#" << std::endl;
+         report << "# time per sample (s)      min\tmean\tmax" << std::endl;
+         report << "#   compute:               " << compute[0] << "\t" << compute[1] << "\t" << compute[2] << std::endl;
+         report << "#   wait:                  " << wait[0] << "\t" << wait[1] << "\t" << wait[2] << std::endl;
+         report << "# total per processor (s)  min\tmean\tmax" << std::endl;
+         report << "#   compute:               " << compute[3] << "\t" << compute[4] << "\t" << compute[5] << std::endl;
+         report << "#   wait:                  " << wait[3] << "\t" << wait[4] << "\t" << wait[5] << std::endl;
+         report << "#" << std::endl;
+         report << "# load imbalance (max/mean compute - 1): " << (compute[4] > 0.0 ? compute[5]/compute[4]-1.0 : 0.0) << std::endl;
+         report << "# wait fraction (total wait/total time): " << (compute[4]+wait[4] > 0.0 ? wait[4]/(compute[4]+wait[4]) : 0.0) << std::endl;
+         report << std::endl;
+
+         // histograms
+         report << "# histogram of time per sample over all processors" << std::endl;
+         report << "# bin_min(s)\tbin_max(s)\tcompute_count\twait_count" << std::endl;
+         for(int b=0; b<num_bins; b++){
+            const double bin_min = b==0 ? 0.0 : histogram_min_time*pow(10.0,double(b-1)/double(bins_per_decade));
+            const double bin_max = histogram_min_time*pow(10.0,double(b)/double(bins_per_decade));
+            report << bin_min << "\t";
+            if(b==num_bins-1) report << "inf\t";
+            else report << bin_max << "\t";
+            report << compute_histogram[b] << "\t" << wait_histogram[b] << std::endl;
+         }
+         report << std::endl;
+
+         // decimated time series
+         report << "# time series of time per sample across processors (" << series_stride << " samples per point)" << std::endl;
+         report << "# time_step\tsamples\tcompute_min\tcompute_mean\tcompute_max\twait_min\twait_mean\twait_max" << std::endl;
+         std::vector<series_point_t> points(series);
+         if(series_accumulator.samples>0.0) points.push_back(series_accumulator);
+         for(unsigned int p=0; p<points.size(); p++){
+            report << points[p].time << "\t" << points[p].samples << "\t";
+            report << points[p].compute[0] << "\t" << points[p].compute[1] << "\t" << points[p].compute[2] << "\t";
+            report << points[p].wait[0] << "\t" << points[p].wait[1] << "\t" << points[p].wait[2] << std::endl;
+         }
+
+         report.close();
+
+         return;
+
+      }
+
+   } // end of internal namespace
+
+   //--------------------------------------------------------------------------
+   // Function to add compute and wait times since the last call to timing
+   // statistics. Must be called by all processors.
+   //--------------------------------------------------------------------------
+   void update_timing_statistics(){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "vmpi::update_timing_statistics has been called" << std::endl;
+
+      // Update local summaries
+      internal::compute_summary.add(vmpi::TotalComputeTime);
+      internal::wait_summary.add(vmpi::TotalWaitTime);
+
+      // Calculate minimum, average and maximum times
+      double local_max[4]={vmpi::TotalComputeTime, vmpi::TotalWaitTime, -vmpi::TotalComputeTime, -vmpi::TotalWaitTime};
+      double global_max[4];
+      MPI_Reduce(local_max,global_max,4,MPI_DOUBLE,MPI_MAX,0,MPI_COMM_WORLD);
+
+      double local_sum[2]={vmpi::TotalComputeTime, vmpi::TotalWaitTime};
+      double global_sum[2];
+      MPI_Reduce(local_sum,global_sum,2,MPI_DOUBLE,MPI_SUM,0,MPI_COMM_WORLD);
+
+      vmpi::AverageComputeTime=global_sum[0]/double(vmpi::num_processors);
+      vmpi::AverageWaitTime=global_sum[1]/double(vmpi::num_processors);
+      vmpi::MaximumComputeTime=global_max[0];
+      vmpi::MaximumWaitTime=global_max[1];
+
+      // Add point to time series on root process
+      if(vmpi::my_rank==0){
+         internal::series_point_t point;
+         point.time=sim::time;
+         point.samples=1.0;
+         point.compute[0]=-global_max[2];
+         point.compute[1]=vmpi::AverageComputeTime;
+         point.compute[2]=vmpi::MaximumComputeTime;
+         point.wait[0]=-global_max[3];
+         point.wait[1]=vmpi::AverageWaitTime;
+         point.wait[2]=vmpi::MaximumWaitTime;
+         internal::add_series_point(point);
+      }
+
+      internal::num_samples++;
+
+      // Write report periodically
+      if(internal::num_samples%internal::report_rate==0) internal::write_timing_report();
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to write final timing report. Must be called by all processors.
+   //--------------------------------------------------------------------------
+   void output_timing_statistics(){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "vmpi::output_timing_statistics has been called" << std::endl;
+
+      internal::write_timing_report();
+
+      return;
+
+   }
+
+} // end of namespace vmpi
+#endif
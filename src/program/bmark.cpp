@@ -61,6 +61,7 @@ int bmark(){
 	if(err::check==true){std::cout << "program::bmark has been called" << std::endl;}
 
 	// Simulate system
+	sim::set_telemetry_stage("benchmark", sim::total_time);
 	while(sim::time<sim::total_time){
 		sim::integrate(sim::partial_time);
 
@@ -99,8 +99,11 @@ int curie_temperature(){
 	// Perform Temperature Loop
 	while(sim::temperature<=sim::Tmax){
 
+		// Set stage for run telemetry
+		sim::set_telemetry_stage("curie-temperature", sim::time+sim::equilibration_time+sim::loop_time);
+
 		// Equilibrate system
-		sim::integrate(sim::equilibration_time);
+		sim::equilibrate(sim::equilibration_time);
 		
 		// Reset mean magnetisation counters
 		stats::mag_m_reset();
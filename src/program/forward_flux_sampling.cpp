@@ -0,0 +1,327 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "program.hpp"
+#include "sim.hpp"
+#include "stats.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace program{
+
+   namespace internal{
+
+      //-----------------------------------------------------------------------
+      // Function to calculate the order parameter (reduced m_z of the system
+      // or of a single material). Calculated directly so that the mean values
+      // of the statistics are not affected.
+      //-----------------------------------------------------------------------
+      double ffs_order_parameter(){
+
+         const int mat=sim::ffs_order_parameter_material;
+         const int num_local_atoms=stats::num_atoms;
+
+         // sum of mu_s S_z and mu_s
+         double m[2]={0.0,0.0};
+         for(int atom=0; atom<num_local_atoms; atom++){
+            if(mat>=0 && atoms::type_array[atom]!=mat) continue;
+            m[0]+=atoms::m_spin_array[atom]*atoms::z_spin_array[atom];
+            m[1]+=atoms::m_spin_array[atom];
+         }
+
+         #ifdef MPICF
+            MPI_Allreduce(MPI_IN_PLACE, &m[0], 2, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+         #endif
+
+         return m[1]>0.0 ? m[0]/m[1] : 0.0;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to save spin configuration of local atoms
+      //-----------------------------------------------------------------------
+      void save_configuration(std::vector<double>& configuration){
+
+         const int num_local_atoms=stats::num_atoms;
+         configuration.resize(3*num_local_atoms);
+
+         for(int atom=0; atom<num_local_atoms; atom++){
+            configuration[3*atom+0]=atoms::x_spin_array[atom];
+            configuration[3*atom+1]=atoms::y_spin_array[atom];
+            configuration[3*atom+2]=atoms::z_spin_array[atom];
+         }
+
+         return;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to load spin configuration of local atoms (halo spins are
+      // updated by the integrator)
+      //-----------------------------------------------------------------------
+      void load_configuration(const std::vector<double>& configuration){
+
+         const int num_local_atoms=configuration.size()/3;
+
+         for(int atom=0; atom<num_local_atoms; atom++){
+            atoms::x_spin_array[atom]=configuration[3*atom+0];
+            atoms::y_spin_array[atom]=configuration[3*atom+1];
+            atoms::z_spin_array[atom]=configuration[3*atom+2];
+         }
+
+         return;
+
+      }
+
+   } // end of internal namespace
+
+//-----------------------------------------------------------------------------
+//
+//   Program to calculate the rate of rare thermal switching events with
+//   forward flux sampling (Allen, Warren and ten Wolde, PRL 94 018104 2005).
+//
+//   The order parameter lambda is the reduced m_z of the system (or of
+//   material sim:forward-flux-material). The initial state A is lambda >
+//   lambda_A and the final state B is lambda < lambda_n, with interfaces
+//   lambda_A > lambda_0 > lambda_1 > ... > lambda_n evenly spaced between
+//   the first and last interfaces. The order parameter is evaluated every
+//   sim:partial-time-steps.
+//
+//   1) The system is equilibrated in A and integrated for up to
+//      sim:total-time-steps, storing a configuration each time the
+//      trajectory crosses lambda_0 coming from A, giving the flux out of A.
+//      Only time since the last visit to A is counted in the flux.
+//
+//   2) From each interface lambda_i, trial trajectories are started from the
+//      stored configurations in turn and integrated until they reach
+//      lambda_i+1 (success, configuration stored) or return to A (failure),
+//      giving the probability P(lambda_i+1 | lambda_i).
+//
+//   The rate is k_AB = flux * prod P(lambda_i+1 | lambda_i). Trajectories are
+//   run one after another, each with the (parallel) production integrator.
+//   Results are written to the file forward-flux-sampling.
+//
+//-----------------------------------------------------------------------------
+void forward_flux_sampling(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true) std::cout << "program::forward_flux_sampling has been called" << std::endl;
+
+   //---------------------------------------------------------------------------
+   // Set up interfaces
+   //---------------------------------------------------------------------------
+   const double lambda_A=sim::ffs_basin_boundary;
+   const int num_interfaces=sim::ffs_num_interfaces;
+   std::vector<double> lambda(num_interfaces);
+   for(int i=0; i<num_interfaces; i++){
+      lambda[i]=sim::ffs_first_interface+(sim::ffs_last_interface-sim::ffs_first_interface)*double(i)/double(num_interfaces-1);
+   }
+
+   if(lambda_A<=lambda[0] || lambda[0]<=lambda[num_interfaces-1]){
+      terminaltextcolor(RED);
+      std::cerr << "Error - forward flux sampling interfaces must satisfy basin-boundary > first-interface > last-interface" << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - forward flux sampling interfaces must satisfy basin-boundary > first-interface > last-interface" << std::endl;
+      err::vexit();
+   }
+
+   if(sim::ffs_order_parameter_material>=mp::num_materials){
+      terminaltextcolor(RED);
+      std::cerr << "Error - forward flux sampling material " << sim::ffs_order_parameter_material+1 << " is greater than the number of materials" << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - forward flux sampling material " << sim::ffs_order_parameter_material+1 << " is greater than the number of materials" << std::endl;
+      err::vexit();
+   }
+
+   const uint64_t check_steps = sim::partial_time > 0 ? sim::partial_time : 1;
+   const int num_configurations=sim::ffs_num_configurations;
+   const int num_trials=sim::ffs_num_trials;
+
+   //---------------------------------------------------------------------------
+   // Equilibrate system in A, integrating for up to a further equilibration
+   // time if the system is not yet in A
+   //---------------------------------------------------------------------------
+   sim::equilibrate(sim::equilibration_time);
+
+   double initial_order_parameter=internal::ffs_order_parameter();
+   const uint64_t settle_start_time=sim::time;
+   while(initial_order_parameter<lambda_A && sim::time-settle_start_time<sim::equilibration_time){
+      sim::integrate(check_steps);
+      initial_order_parameter=internal::ffs_order_parameter();
+   }
+
+   if(initial_order_parameter<lambda_A){
+      terminaltextcolor(RED);
+      std::cerr << "Error - forward flux sampling requires the equilibrated system to be in A, but order parameter " << initial_order_parameter
+                << " is less than basin-boundary " << lambda_A << ". Check initial spin direction, field and temperature." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error - forward flux sampling requires the equilibrated system to be in A, but order parameter " << initial_order_parameter
+           << " is less than basin-boundary " << lambda_A << ". Check initial spin direction, field and temperature." << std::endl;
+      err::vexit();
+   }
+
+   std::vector<double> initial_configuration;
+   internal::save_configuration(initial_configuration);
+
+   //---------------------------------------------------------------------------
+   // Calculate flux through first interface
+   //---------------------------------------------------------------------------
+   std::vector< std::vector<double> > configurations;
+   configurations.reserve(num_configurations);
+
+   const uint64_t flux_start_time=sim::time;
+   uint64_t steps_in_A=0;
+   int num_crossings=0;
+   int num_spontaneous_switches=0;
+   bool from_A=(initial_order_parameter>=lambda_A);
+
+   while(num_crossings<num_configurations && sim::time-flux_start_time<sim::total_time){
+
+      // only time since the last visit to A counts towards the flux
+      sim::integrate(check_steps);
+      if(from_A) steps_in_A+=check_steps;
+
+      const double order_parameter=internal::ffs_order_parameter();
+
+      // restart from A if system switches during flux calculation
+      if(order_parameter<=lambda[num_interfaces-1]){
+         num_spontaneous_switches++;
+         internal::load_configuration(initial_configuration);
+         from_A=true;
+         continue;
+      }
+
+      if(order_parameter>=lambda_A) from_A=true;
+      else if(from_A && order_parameter<lambda[0]){
+         configurations.push_back(std::vector<double>());
+         internal::save_configuration(configurations.back());
+         num_crossings++;
+         from_A=false;
+      }
+
+   }
+
+   const double time_in_A=double(steps_in_A)*mp::dt_SI;
+   const double flux = time_in_A > 0.0 ? double(num_crossings)/time_in_A : 0.0;
+
+   zlog << zTs() << "Forward flux sampling: " << num_crossings << " crossings of first interface in " << time_in_A << " s, flux = " << flux << " /s" << std::endl;
+   if(num_spontaneous_switches>0) zlog << zTs() << "Forward flux sampling: " << num_spontaneous_switches << " spontaneous switching events during flux calculation" << std::endl;
+
+   //---------------------------------------------------------------------------
+   // Calculate probabilities to reach each interface from the previous one
+   //---------------------------------------------------------------------------
+   std::vector<int> trials(num_interfaces,0);
+   std::vector<int> successes(num_interfaces,0);
+   std::vector<double> probability(num_interfaces,0.0);
+
+   int last_interface=0; // last interface reached
+   for(int i=0; i<num_interfaces-1 && configurations.size()>0; i++){
+
+      std::vector< std::vector<double> > next_configurations;
+      next_configurations.reserve(num_trials);
+
+      for(int trial=0; trial<num_trials; trial++){
+
+         // start trials from stored configurations in turn
+         internal::load_configuration(configurations[trial%configurations.size()]);
+
+         const uint64_t trial_start_time=sim::time;
+         while(sim::time-trial_start_time<sim::ffs_maximum_trial_time){
+
+            sim::integrate(check_steps);
+            const double order_parameter=internal::ffs_order_parameter();
+
+            if(order_parameter<=lambda[i+1]){
+               next_configurations.push_back(std::vector<double>());
+               internal::save_configuration(next_configurations.back());
+               successes[i]++;
+               break;
+            }
+            if(order_parameter>=lambda_A) break;
+
+         }
+
+         trials[i]++;
+
+      }
+
+      probability[i]=double(successes[i])/double(trials[i]);
+
+      zlog << zTs() << "Forward flux sampling: interface " << i << " -> " << i+1 << " (" << lambda[i] << " -> " << lambda[i+1] << "): "
+           << successes[i] << " of " << trials[i] << " trials successful, P = " << probability[i] << std::endl;
+
+      configurations.swap(next_configurations);
+      if(configurations.size()>0) last_interface=i+1;
+
+   }
+
+   //---------------------------------------------------------------------------
+   // Calculate rate and relative error assuming independent binomial
+   // statistics at each interface
+   //---------------------------------------------------------------------------
+   double rate=flux;
+   double relative_variance = num_crossings > 0 ? 1.0/double(num_crossings) : 0.0;
+   for(int i=0; i<num_interfaces-1; i++){
+      rate*=probability[i];
+      if(probability[i]>0.0) relative_variance+=(1.0-probability[i])/(probability[i]*double(trials[i]));
+   }
+   const bool complete=(last_interface==num_interfaces-1 && num_crossings>0);
+
+   zlog << zTs() << "Forward flux sampling: rate = " << rate << " /s, relative error = " << sqrt(relative_variance) << std::endl;
+   if(!complete) zlog << zTs() << "Forward flux sampling: final interface not reached, increase number of trials or interfaces" << std::endl;
+
+   //---------------------------------------------------------------------------
+   // Output results
+   //---------------------------------------------------------------------------
+   if(vmpi::my_rank==0){
+
+      std::ofstream ffs_file("forward-flux-sampling");
+
+      ffs_file << "#-----------------------------------------------------------" << std::endl;
+      ffs_file << "# Forward flux sampling" << std::endl;
+      ffs_file << "#-----------------------------------------------------------" << std::endl;
+      ffs_file << "# temperature (K):         " << sim::temperature << std::endl;
+      ffs_file << "# applied field (T):       " << sim::H_applied << std::endl;
+      if(sim::ffs_order_parameter_material<0) ffs_file << "# order parameter:         system m_z" << std::endl;
+      else ffs_file << "# order parameter:         material " << sim::ffs_order_parameter_material+1 << " m_z" << std::endl;
+      ffs_file << "# basin boundary:          " << lambda_A << std::endl;
+      ffs_file << "# time in A (s):           " << time_in_A << std::endl;
+      ffs_file << "# first interface crossings: " << num_crossings << std::endl;
+      ffs_file << "# flux (1/s):              " << flux << std::endl;
+      ffs_file << "# rate (1/s):              " << rate << std::endl;
+      ffs_file << "# relative error:          " << sqrt(relative_variance) << std::endl;
+      if(rate>0.0) ffs_file << "# mean switching time (s): " << 1.0/rate << std::endl;
+      if(!complete) ffs_file << "# final interface not reached" << std::endl;
+      ffs_file << "#" << std::endl;
+      ffs_file << "# interface\tlambda\ttrials\tsuccesses\tP(next|this)\tP(this|first)" << std::endl;
+
+      double cumulative_probability=1.0;
+      for(int i=0; i<num_interfaces-1; i++){
+         ffs_file << i << "\t" << lambda[i] << "\t" << trials[i] << "\t" << successes[i] << "\t" << probability[i] << "\t" << cumulative_probability << std::endl;
+         cumulative_probability*=probability[i];
+      }
+      ffs_file << num_interfaces-1 << "\t" << lambda[num_interfaces-1] << "\t-\t-\t-\t" << cumulative_probability << std::endl;
+
+      ffs_file.close();
+
+   }
+
+   return;
+
+}
+
+}//end of namespace program
@@ -86,7 +86,7 @@ int hysteresis(){
 	
 	// Equilibrate system in saturation field
 	sim::H_applied=sim::Heq;
-	sim::integrate(sim::equilibration_time);
+	sim::equilibrate(sim::equilibration_time);
 		
 	// Setup min and max fields and increment (uT)
 	int iHmax=vmath::iround(double(sim::Hmax)*1.0E6);
@@ -24,6 +24,7 @@
 //
 
 // Standard Libraries
+#include <cmath>
 #include <iostream>
 
 // Vampire Header files
@@ -40,7 +41,17 @@
 
 namespace sim{
 
-/// Function to update lagrange lambda
+//-----------------------------------------------------------
+///  Function to update lagrange lambda
+//
+///  The magnetisation of the system is calculated from the
+///  sum of moments accumulated by the integrator in its final
+///  spin update, or directly from the spins if the integrator
+///  does not provide it, with a single reduction of four
+///  values. The statistics module is not used so that output
+///  averages are not changed by the constraint.
+//
+//-----------------------------------------------------------
 void update_lagrange_lambda(){
 
    // Save initial value of lambda
@@ -48,18 +59,38 @@ void update_lagrange_lambda(){
    const double lamda_old_y = sim::lagrange_lambda_y;
    const double lamda_old_z = sim::lagrange_lambda_z;
 
-   // Calculate magnetisation
-   stats::mag_m();
-
-   //std::cout << "xx " << sim::lagrange_m << std::endl;
-
-   const std::vector<double> mm = stats::system_magnetization.get_magnetization();
+   // Calculate local sum of moments if not calculated by integrator
+   double mm[4]={0.0,0.0,0.0,0.0};
+   if(sim::lagrange_local_moment_set){
+      for(int i=0;i<4;i++) mm[i]=sim::lagrange_local_moment[i];
+   }
+   else{
+      #ifdef MPICF
+         const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+      #else
+         const int num_local_atoms = atoms::num_atoms;
+      #endif
+      for(int atom=0;atom<num_local_atoms;atom++){
+         const double mu=atoms::m_spin_array[atom];
+         mm[0]+=atoms::x_spin_array[atom]*mu;
+         mm[1]+=atoms::y_spin_array[atom]*mu;
+         mm[2]+=atoms::z_spin_array[atom]*mu;
+         mm[3]+=mu;
+      }
+   }
+   sim::lagrange_local_moment_set=false;
+
+   // Reduce on all CPUs
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, mm, 4, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   #endif
 
    // Calculate unit vector of magnetisation
-   const double mx = mm[0];
-   const double my = mm[1];
-   const double mz = mm[2];
-   sim::lagrange_m = mm[3];
+   const double magm = sqrt(mm[0]*mm[0] + mm[1]*mm[1] + mm[2]*mm[2]);
+   const double mx = mm[0]/magm;
+   const double my = mm[1]/magm;
+   const double mz = mm[2]/magm;
+   sim::lagrange_m = magm/mm[3];
 
    // Constraint vector
    const double nu_x=cos(sim::constraint_theta*M_PI/180.0)*sin(sim::constraint_phi*M_PI/180.0);
@@ -0,0 +1,165 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "program.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace program{
+
+//-----------------------------------------------------------------------------
+//
+//   Program to measure parallel scaling of the integrators.
+//
+//   The system is first integrated for sim::equilibration_time steps to warm
+//   up caches and communication, then sim::total_time steps of the selected
+//   integrator are timed. In weak scaling mode the system is repeated at
+//   creation along its periodic dimensions (see cs::weak_scaling_dimensions)
+//   so that the number of atoms per processor is the same as the input system.
+//
+//   One row of results is appended to the file scaling-benchmark.txt per
+//   run, so that running the same input on different numbers of processors
+//   builds a single table. The parallel efficiency is the ratio of
+//   processor-seconds per atom-step to that of a reference run, which is
+//   valid for both weak and strong scaling. The reference is the row with
+//   the fewest processors for the same scaling mode, build and integrator
+//   and the same system size (total atoms for strong scaling, atoms per
+//   processor for weak scaling); if there is none the run is its own
+//   reference. The processor count of the reference run is recorded in
+//   each row.
+//
+//-----------------------------------------------------------------------------
+void scaling_benchmark(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true) std::cout << "program::scaling_benchmark has been called" << std::endl;
+
+   const std::string mode = sim::weak_scaling ? "weak" : "strong";
+   const std::string table_file = "scaling-benchmark.txt";
+   #ifdef MPICF
+      const std::string build = "parallel";
+   #else
+      const std::string build = "serial";
+   #endif
+
+   // Determine atoms and halo data volume
+   #ifdef MPICF
+      const double local_atoms = double(vmpi::num_core_atoms+vmpi::num_bdry_atoms);
+      double local_halo_bytes = 0.0;
+      for(unsigned int p=0; p<vmpi::send_num_array.size(); p++) local_halo_bytes += 3.0*double(vmpi::send_num_array[p])*sizeof(double);
+      double total_atoms = 0.0;
+      double max_atoms = 0.0;
+      double halo_bytes = 0.0;
+      MPI_Allreduce(&local_atoms, &total_atoms, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      MPI_Allreduce(&local_atoms, &max_atoms, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+      MPI_Allreduce(&local_halo_bytes, &halo_bytes, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      // Heun and midpoint integrators perform two halo swaps per step
+      halo_bytes *= 2.0;
+   #else
+      const double total_atoms = double(atoms::num_atoms);
+      const double max_atoms = total_atoms;
+      const double halo_bytes = 0.0;
+   #endif
+
+   const double processors = double(vmpi::num_processors);
+
+   // Warm up integrator
+   sim::integrate(sim::equilibration_time);
+
+   // Time integration
+   #ifdef MPICF
+      MPI_Barrier(MPI_COMM_WORLD);
+   #endif
+   const uint64_t start_step = sim::time;
+   const double start_time = sim::wall_time();
+
+   while(sim::time < start_step+sim::total_time){
+      sim::integrate(sim::partial_time);
+   }
+
+   #ifdef MPICF
+      MPI_Barrier(MPI_COMM_WORLD);
+   #endif
+   const double wall_time = sim::wall_time()-start_time;
+   const double steps = double(sim::time-start_step);
+
+   // Calculate timings
+   const double time_per_step = wall_time/steps;
+   const double time_per_atom_step = time_per_step/total_atoms;
+   const double processor_time_per_atom_step = time_per_atom_step*processors;
+
+   // Output results on root process
+   if(vmpi::my_rank==0){
+
+      const std::string header = "# mode\tbuild\tprocessors\tatoms\tatoms_per_proc_max\tintegrator\tsteps\twall_time(s)\ttime_per_step(s)\t"
+                                 "time_per_atom_step(s)\tproc_time_per_atom_step(s)\thalo_bytes_per_step\treference_processors\tefficiency";
+
+      // Find reference run with the same mode, build, integrator and system size in existing table
+      double reference = processor_time_per_atom_step;
+      int reference_processors = vmpi::num_processors;
+      bool header_found = false;
+      std::ifstream table_in(table_file.c_str());
+      std::string line;
+      while(getline(table_in, line)){
+         if(line==header) header_found = true;
+         if(line.size()==0 || line[0]=='#') continue;
+         std::stringstream line_stream(line);
+         std::string row_mode, row_build;
+         int row_processors, row_integrator;
+         double row_atoms, row_data[7];
+         line_stream >> row_mode >> row_build >> row_processors >> row_atoms >> row_data[0] >> row_integrator;
+         for(int i=1; i<7; i++) line_stream >> row_data[i];
+         // skip rows in a different format
+         if(line_stream.fail() || row_processors<1) continue;
+         if(row_mode!=mode || row_build!=build || row_integrator!=sim::integrator) continue;
+         const bool same_size = sim::weak_scaling ? std::abs(row_atoms/double(row_processors)-total_atoms/processors) <= 0.01*total_atoms/processors
+                                                  : row_atoms==total_atoms;
+         if(same_size && row_processors<reference_processors){
+            reference = row_data[5];
+            reference_processors = row_processors;
+         }
+      }
+      table_in.close();
+
+      const double efficiency = reference/processor_time_per_atom_step;
+
+      std::ofstream table(table_file.c_str(), std::ios::app);
+      if(!header_found) table << header << std::endl;
+      table << mode << "\t" << build << "\t" << vmpi::num_processors << "\t" << total_atoms << "\t" << max_atoms << "\t" << sim::integrator << "\t";
+      table << steps << "\t" << wall_time << "\t" << time_per_step << "\t" << time_per_atom_step << "\t";
+      table << processor_time_per_atom_step << "\t" << halo_bytes << "\t" << reference_processors << "\t" << efficiency << std::endl;
+      table.close();
+
+      std::cout << "Scaling benchmark (" << mode << "): " << vmpi::num_processors << " processors, " << total_atoms << " atoms" << std::endl;
+      std::cout << "\tTime per atom-step:           " << time_per_atom_step << " s" << std::endl;
+      std::cout << "\tProcessor time per atom-step: " << processor_time_per_atom_step << " s" << std::endl;
+      std::cout << "\tHalo data per step:           " << halo_bytes << " bytes" << std::endl;
+      std::cout << "\tParallel efficiency:          " << efficiency << " (relative to " << reference_processors << " processors)" << std::endl;
+
+      zlog << zTs() << "Scaling benchmark (" << mode << "): " << vmpi::num_processors << " processors, " << total_atoms << " atoms, ";
+      zlog << time_per_atom_step << " s per atom-step, " << processor_time_per_atom_step << " processor-s per atom-step, ";
+      zlog << halo_bytes << " halo bytes per step, efficiency " << efficiency << " relative to " << reference_processors << " processors" << std::endl;
+
+   }
+
+   return;
+
+}
+
+} // end of namespace program
@@ -0,0 +1,692 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "program.hpp"
+#include "random.hpp"
+#include "sim.hpp"
+#include "stats.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+int calculate_spin_fields(const int,const int);
+void pack_interleaved_spins(const int,const int);
+int calculate_external_fields(const int,const int);
+#ifdef MPICF
+int mpi_init_halo_swap();
+int mpi_complete_halo_swap();
+#endif
+
+namespace program{
+
+   namespace internal{
+
+      //-----------------------------------------------------------------------
+      // Linearised spin Hamiltonian about the ground state S0 in local
+      // tangent frames (e1, e2). A deviation of atom i is
+      //
+      //    dS_i = (y_2i e1_i + y_2i+1 e2_i) / sqrt(mu_i)
+      //
+      // and the mass weighted Hessian is applied matrix-free using the field
+      // kernels
+      //
+      //    (G y)_i = -sqrt(mu_i) P_i dH_i + (S0_i . H0_i) y_i
+      //
+      // where dH is the change in spin dependent field for the deviation dS
+      // and P_i projects onto the tangent frame.
+      //-----------------------------------------------------------------------
+      class linear_spin_system_t{
+
+      public:
+
+         int num_atoms; // number of local atoms
+         int size; // number of local degrees of freedom
+         int num_operations; // number of applications of G
+         std::vector<double> s0; // ground state spin directions
+         std::vector<double> e1; // first tangent vector
+         std::vector<double> e2; // second tangent vector
+         std::vector<double> h0; // longitudinal field at ground state
+         std::vector<double> root_mu; // square root of atomic moments
+         double field_scale; // largest longitudinal field at ground state
+
+         //--------------------------------------------------------------------
+         // Function to set up tangent frames and fields at ground state
+         //--------------------------------------------------------------------
+         void initialise(){
+
+            num_atoms=stats::num_atoms;
+            size=2*num_atoms;
+            num_operations=0;
+
+            s0.resize(3*num_atoms);
+            e1.resize(3*num_atoms);
+            e2.resize(3*num_atoms);
+            h0.resize(num_atoms);
+            root_mu.resize(num_atoms);
+
+            update_halo();
+            pack_interleaved_spins(0,atoms::num_atoms);
+            calculate_spin_fields(0,num_atoms);
+            calculate_external_fields(0,num_atoms);
+
+            for(int atom=0; atom<num_atoms; atom++){
+
+               const double s[3]={atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
+
+               // choose first tangent vector perpendicular to s along smallest component
+               double a[3]={0.0,0.0,0.0};
+               if(fabs(s[0])<=fabs(s[1]) && fabs(s[0])<=fabs(s[2])) a[0]=1.0;
+               else if(fabs(s[1])<=fabs(s[2])) a[1]=1.0;
+               else a[2]=1.0;
+
+               const double sdota=s[0]*a[0]+s[1]*a[1]+s[2]*a[2];
+               double t1[3]={a[0]-sdota*s[0],a[1]-sdota*s[1],a[2]-sdota*s[2]};
+               const double t1l=sqrt(t1[0]*t1[0]+t1[1]*t1[1]+t1[2]*t1[2]);
+               t1[0]/=t1l; t1[1]/=t1l; t1[2]/=t1l;
+               const double t2[3]={s[1]*t1[2]-s[2]*t1[1], s[2]*t1[0]-s[0]*t1[2], s[0]*t1[1]-s[1]*t1[0]};
+
+               for(int i=0;i<3;i++){
+                  s0[3*atom+i]=s[i];
+                  e1[3*atom+i]=t1[i];
+                  e2[3*atom+i]=t2[i];
+               }
+
+               const double H[3]={atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+                                  atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
+                                  atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
+
+               h0[atom]=s[0]*H[0]+s[1]*H[1]+s[2]*H[2];
+               root_mu[atom]=sqrt(atoms::m_spin_array[atom]);
+
+            }
+
+            field_scale=0.0;
+            for(int atom=0; atom<num_atoms; atom++) if(fabs(h0[atom])>field_scale) field_scale=fabs(h0[atom]);
+            #ifdef MPICF
+               MPI_Allreduce(MPI_IN_PLACE, &field_scale, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            #endif
+
+            return;
+
+         }
+
+         //--------------------------------------------------------------------
+         // Function to update halo spins after a change of local spins
+         //--------------------------------------------------------------------
+         void update_halo(){
+            #ifdef MPICF
+               mpi_init_halo_swap();
+               mpi_complete_halo_swap();
+            #endif
+            return;
+         }
+
+         //--------------------------------------------------------------------
+         // Function to set spins to S0 + scale*dS(y)
+         //--------------------------------------------------------------------
+         void set_spins(const std::vector<double>& y, const double scale){
+            for(int atom=0; atom<num_atoms; atom++){
+               const double u=scale*y[2*atom]/root_mu[atom];
+               const double v=scale*y[2*atom+1]/root_mu[atom];
+               atoms::x_spin_array[atom]=s0[3*atom+0]+u*e1[3*atom+0]+v*e2[3*atom+0];
+               atoms::y_spin_array[atom]=s0[3*atom+1]+u*e1[3*atom+1]+v*e2[3*atom+1];
+               atoms::z_spin_array[atom]=s0[3*atom+2]+u*e1[3*atom+2]+v*e2[3*atom+2];
+            }
+            update_halo();
+            return;
+         }
+
+         //--------------------------------------------------------------------
+         // Function to restore ground state spins
+         //--------------------------------------------------------------------
+         void restore_spins(){
+            for(int atom=0; atom<num_atoms; atom++){
+               atoms::x_spin_array[atom]=s0[3*atom+0];
+               atoms::y_spin_array[atom]=s0[3*atom+1];
+               atoms::z_spin_array[atom]=s0[3*atom+2];
+            }
+            update_halo();
+            return;
+         }
+
+         //--------------------------------------------------------------------
+         // Function to apply G to y using central differences of the spin
+         // dependent fields (exact for fields linear in S)
+         //--------------------------------------------------------------------
+         void apply_G(const std::vector<double>& y, std::vector<double>& Gy){
+
+            num_operations++;
+
+            // scale deviation so that the largest spin change is small
+            double max_dS=0.0;
+            for(int atom=0; atom<num_atoms; atom++){
+               const double dS=sqrt(y[2*atom]*y[2*atom]+y[2*atom+1]*y[2*atom+1])/root_mu[atom];
+               if(dS>max_dS) max_dS=dS;
+            }
+            #ifdef MPICF
+               MPI_Allreduce(MPI_IN_PLACE, &max_dS, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+            #endif
+
+            Gy.assign(size,0.0);
+            if(max_dS==0.0) return;
+            const double epsilon=1.0e-4/max_dS;
+
+            std::vector<double> Hp(3*num_atoms);
+
+            set_spins(y,epsilon);
+            pack_interleaved_spins(0,atoms::num_atoms);
+            calculate_spin_fields(0,num_atoms);
+            for(int atom=0; atom<num_atoms; atom++){
+               Hp[3*atom+0]=atoms::x_total_spin_field_array[atom];
+               Hp[3*atom+1]=atoms::y_total_spin_field_array[atom];
+               Hp[3*atom+2]=atoms::z_total_spin_field_array[atom];
+            }
+
+            set_spins(y,-epsilon);
+            pack_interleaved_spins(0,atoms::num_atoms);
+            calculate_spin_fields(0,num_atoms);
+
+            const double inv_2epsilon=0.5/epsilon;
+            for(int atom=0; atom<num_atoms; atom++){
+               const double dH[3]={(Hp[3*atom+0]-atoms::x_total_spin_field_array[atom])*inv_2epsilon,
+                                   (Hp[3*atom+1]-atoms::y_total_spin_field_array[atom])*inv_2epsilon,
+                                   (Hp[3*atom+2]-atoms::z_total_spin_field_array[atom])*inv_2epsilon};
+               const double dH1=dH[0]*e1[3*atom+0]+dH[1]*e1[3*atom+1]+dH[2]*e1[3*atom+2];
+               const double dH2=dH[0]*e2[3*atom+0]+dH[1]*e2[3*atom+1]+dH[2]*e2[3*atom+2];
+               Gy[2*atom]  =-root_mu[atom]*dH1+h0[atom]*y[2*atom];
+               Gy[2*atom+1]=-root_mu[atom]*dH2+h0[atom]*y[2*atom+1];
+            }
+
+            restore_spins();
+
+            return;
+
+         }
+
+         //--------------------------------------------------------------------
+         // Function to apply K = J^T G J, where J is the local 90 degree
+         // rotation (u,v) -> (v,-u)
+         //--------------------------------------------------------------------
+         void apply_K(const std::vector<double>& y, std::vector<double>& Ky){
+            std::vector<double> Jy(size);
+            for(int atom=0; atom<num_atoms; atom++){
+               Jy[2*atom]=y[2*atom+1];
+               Jy[2*atom+1]=-y[2*atom];
+            }
+            std::vector<double> GJy;
+            apply_G(Jy,GJy);
+            Ky.resize(size);
+            for(int atom=0; atom<num_atoms; atom++){
+               Ky[2*atom]=-GJy[2*atom+1];
+               Ky[2*atom+1]=GJy[2*atom];
+            }
+            return;
+         }
+
+      };
+
+      //-----------------------------------------------------------------------
+      // Function to calculate global dot product of distributed vectors
+      //-----------------------------------------------------------------------
+      double dot(const std::vector<double>& a, const std::vector<double>& b){
+         double sum=0.0;
+         for(unsigned int i=0; i<a.size(); i++) sum+=a[i]*b[i];
+         #ifdef MPICF
+            MPI_Allreduce(MPI_IN_PLACE, &sum, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+         #endif
+         return sum;
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to solve G x = b (use_K=false) or K x = b (use_K=true) with
+      // the conjugate gradient method. G must be positive definite, ie the
+      // ground state must be a stable minimum.
+      //-----------------------------------------------------------------------
+      void conjugate_gradient(linear_spin_system_t& system, const bool use_K, const std::vector<double>& b, std::vector<double>& x){
+
+         const int n=system.size;
+         x.assign(n,0.0);
+         std::vector<double> r(b);
+         std::vector<double> p(b);
+         std::vector<double> Ap;
+
+         const double b_norm2=dot(b,b);
+         if(b_norm2==0.0) return;
+         const double tolerance2=sim::spin_wave_tolerance*sim::spin_wave_tolerance*b_norm2;
+         double r_norm2=b_norm2;
+
+         const int max_iterations=100000;
+         for(int iteration=0; iteration<max_iterations && r_norm2>tolerance2; iteration++){
+
+            if(use_K) system.apply_K(p,Ap);
+            else system.apply_G(p,Ap);
+
+            // zero or negative curvature (to within rounding of the largest field)
+            const double pAp=dot(p,Ap);
+            if(pAp<=1.0e-10*system.field_scale*dot(p,p)){
+               terminaltextcolor(RED);
+               std::cerr << "Error - linearised spin Hamiltonian is not positive definite. The relaxed state is not a stable minimum or has a zero energy mode." << std::endl;
+               std::cerr << "        An applied field or anisotropy is needed to fix the ground state direction." << std::endl;
+               terminaltextcolor(WHITE);
+               zlog << zTs() << "Error - linearised spin Hamiltonian is not positive definite. The relaxed state is not a stable minimum or has a zero energy mode." << std::endl;
+               err::vexit();
+            }
+
+            const double alpha=r_norm2/pAp;
+            for(int i=0; i<n; i++){
+               x[i]+=alpha*p[i];
+               r[i]-=alpha*Ap[i];
+            }
+
+            const double r_norm2_new=dot(r,r);
+            const double beta=r_norm2_new/r_norm2;
+            r_norm2=r_norm2_new;
+            for(int i=0; i<n; i++) p[i]=r[i]+beta*p[i];
+
+         }
+
+         if(r_norm2>tolerance2) zlog << zTs() << "Spin waves: warning - linear solver not converged after " << max_iterations << " iterations" << std::endl;
+
+         return;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to calculate eigenvalues and eigenvectors of a small dense
+      // symmetric matrix with the cyclic Jacobi method. Eigenvectors are
+      // stored in the columns of v.
+      //-----------------------------------------------------------------------
+      void jacobi_eigensystem(std::vector<double> a, const int n, std::vector<double>& eigenvalues, std::vector<double>& v){
+
+         v.assign(n*n,0.0);
+         for(int i=0; i<n; i++) v[i*n+i]=1.0;
+
+         for(int sweep=0; sweep<100; sweep++){
+
+            double off=0.0;
+            for(int p=0; p<n; p++) for(int q=p+1; q<n; q++) off+=a[p*n+q]*a[p*n+q];
+            if(off<1.0e-30) break;
+
+            for(int p=0; p<n; p++){
+               for(int q=p+1; q<n; q++){
+
+                  if(fabs(a[p*n+q])<1.0e-300) continue;
+
+                  const double theta=(a[q*n+q]-a[p*n+p])/(2.0*a[p*n+q]);
+                  const double t=(theta >= 0.0 ? 1.0 : -1.0)/(fabs(theta)+sqrt(theta*theta+1.0));
+                  const double c=1.0/sqrt(t*t+1.0);
+                  const double s=t*c;
+
+                  for(int k=0; k<n; k++){
+                     const double akp=a[k*n+p];
+                     const double akq=a[k*n+q];
+                     a[k*n+p]=c*akp-s*akq;
+                     a[k*n+q]=s*akp+c*akq;
+                  }
+                  for(int k=0; k<n; k++){
+                     const double apk=a[p*n+k];
+                     const double aqk=a[q*n+k];
+                     a[p*n+k]=c*apk-s*aqk;
+                     a[q*n+k]=s*apk+c*aqk;
+                  }
+                  for(int k=0; k<n; k++){
+                     const double vkp=v[k*n+p];
+                     const double vkq=v[k*n+q];
+                     v[k*n+p]=c*vkp-s*vkq;
+                     v[k*n+q]=s*vkp+c*vkq;
+                  }
+
+               }
+            }
+         }
+
+         eigenvalues.resize(n);
+         for(int i=0; i<n; i++) eigenvalues[i]=a[i*n+i];
+
+         return;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to add a vector to a basis which is orthonormal in the G
+      // inner product
+      //-----------------------------------------------------------------------
+      void add_to_basis(std::vector< std::vector<double> >& B, std::vector< std::vector<double> >& GB,
+                        std::vector<double> x, std::vector<double> Gx){
+
+         for(unsigned int j=0; j<B.size(); j++){
+            const double c=dot(GB[j],x);
+            for(unsigned int i=0; i<x.size(); i++){
+               x[i]-=c*B[j][i];
+               Gx[i]-=c*GB[j][i];
+            }
+         }
+
+         const double norm=sqrt(fabs(dot(x,Gx)));
+         if(norm==0.0) return;
+         for(unsigned int i=0; i<x.size(); i++){
+            x[i]/=norm;
+            Gx[i]/=norm;
+         }
+
+         B.push_back(x);
+         GB.push_back(Gx);
+
+         return;
+
+      }
+
+   } // end of internal namespace
+
+//-----------------------------------------------------------------------------
+//
+//   Program to calculate the lowest frequency spin wave eigenmodes of the
+//   system from the linearised LLG equation.
+//
+//   The system is relaxed at zero temperature for sim:equilibration-time-steps
+//   with the selected integrator. For small deviations y (mass weighted, in
+//   local tangent frames) the undamped LLG equation is dy/dt = gamma J G y,
+//   where G is the Hessian of the energy (applied matrix-free with the
+//   field kernels) and J the local 90 degree rotation. The eigenvalues of
+//   T = J^T G J G are omega^2, and T is self adjoint in the inner product
+//   <x,y>_G = x^T G y.
+//
+//   The lowest modes are found with the Lanczos method (with full
+//   reorthogonalisation) on the inverse operator T^-1 = G^-1 K^-1, where
+//   K = J^T G J, so that the low frequency end of the spectrum converges
+//   first. The inverses are applied with conjugate gradients. Each mode is
+//   a two fold degenerate eigenvalue of T (the in and out of phase
+//   components of the precession) and is reported once.
+//
+//   Mode frequencies and the fraction of each mode on each material are
+//   written to the file spin-wave-modes, and the precession amplitude of
+//   each atom in each mode to the file(s) spin-wave-mode-profiles.
+//
+//   Dipolar fields are included in the ground state field but are not
+//   linearised. A stable ground state with no zero energy modes (ie with
+//   anisotropy or applied field) is required.
+//
+//-----------------------------------------------------------------------------
+void spin_waves(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true) std::cout << "program::spin_waves has been called" << std::endl;
+
+   //---------------------------------------------------------------------------
+   // Relax system at zero temperature
+   //---------------------------------------------------------------------------
+   const double temperature=sim::temperature;
+   sim::temperature=0.0;
+   sim::integrate(sim::equilibration_time);
+
+   internal::linear_spin_system_t system;
+   system.initialise();
+
+   const int n=system.size;
+   int global_size=n;
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &global_size, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+
+   // Determine residual torque of relaxed state
+   double max_torque=0.0;
+   for(int atom=0; atom<system.num_atoms; atom++){
+      const double H[3]={atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+                         atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
+                         atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
+      const double Hl=sqrt(H[0]*H[0]+H[1]*H[1]+H[2]*H[2]);
+      if(Hl==0.0) continue;
+      const double torque=sqrt(pow(system.s0[3*atom+1]*H[2]-system.s0[3*atom+2]*H[1],2)+
+                               pow(system.s0[3*atom+2]*H[0]-system.s0[3*atom+0]*H[2],2)+
+                               pow(system.s0[3*atom+0]*H[1]-system.s0[3*atom+1]*H[0],2))/Hl;
+      if(torque>max_torque) max_torque=torque;
+   }
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &max_torque, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+   #endif
+   zlog << zTs() << "Spin waves: maximum residual torque |S x H|/|H| of relaxed state " << max_torque << std::endl;
+   if(max_torque>1.0e-3) zlog << zTs() << "Spin waves: warning - system is not fully relaxed, increase equilibration-time-steps" << std::endl;
+
+   //---------------------------------------------------------------------------
+   // Lanczos iteration for T^-1 in G inner product
+   //---------------------------------------------------------------------------
+   const int num_modes = sim::spin_wave_num_modes < global_size ? sim::spin_wave_num_modes : global_size;
+   int max_steps = sim::spin_wave_lanczos_steps > 0 ? sim::spin_wave_lanczos_steps : 4*num_modes+20;
+   if(max_steps>global_size) max_steps=global_size;
+
+   std::vector< std::vector<double> > V; // Lanczos vectors
+   std::vector< std::vector<double> > GV; // G applied to Lanczos vectors
+   std::vector<double> alpha;
+   std::vector<double> beta;
+
+   // random start vector normalised in G inner product
+   std::vector<double> v(n);
+   for(int i=0; i<n; i++) v[i]=mtrandom::gaussian();
+   std::vector<double> Gv;
+   system.apply_G(v,Gv);
+   double norm=sqrt(internal::dot(v,Gv));
+   for(int i=0; i<n; i++){ v[i]/=norm; Gv[i]/=norm; }
+
+   double last_beta=0.0;
+   for(int step=0; step<max_steps; step++){
+
+      V.push_back(v);
+      GV.push_back(Gv);
+
+      // w = G^-1 K^-1 v
+      std::vector<double> q, w;
+      internal::conjugate_gradient(system, true, v, q);
+      internal::conjugate_gradient(system, false, q, w);
+
+      const double a=internal::dot(v,q); // <v, w>_G
+      alpha.push_back(a);
+
+      // full reorthogonalisation in G inner product (twice for stability)
+      for(int pass=0; pass<2; pass++){
+         for(unsigned int j=0; j<V.size(); j++){
+            const double c=internal::dot(GV[j],w);
+            for(int i=0; i<n; i++) w[i]-=c*V[j][i];
+         }
+      }
+
+      system.apply_G(w,Gv);
+      last_beta=sqrt(fabs(internal::dot(w,Gv)));
+
+      zlog << zTs() << "Spin waves: Lanczos step " << step+1 << " of " << max_steps << ", alpha = " << a << ", beta = " << last_beta << std::endl;
+
+      // invariant subspace found
+      if(last_beta<1.0e-12*fabs(a)) break;
+      if(step==max_steps-1) break;
+
+      beta.push_back(last_beta);
+      for(int i=0; i<n; i++){ v[i]=w[i]/last_beta; Gv[i]/=last_beta; }
+
+   }
+
+   //---------------------------------------------------------------------------
+   // Ritz values and vectors
+   //---------------------------------------------------------------------------
+   const int m=alpha.size();
+   std::vector<double> tridiagonal(m*m,0.0);
+   for(int i=0; i<m; i++){
+      tridiagonal[i*m+i]=alpha[i];
+      if(i<m-1){
+         tridiagonal[i*m+i+1]=beta[i];
+         tridiagonal[(i+1)*m+i]=beta[i];
+      }
+   }
+
+   std::vector<double> theta, s;
+   internal::jacobi_eigensystem(tridiagonal, m, theta, s);
+
+   // sort by decreasing theta (increasing frequency)
+   std::vector<std::pair<double,int> > order;
+   for(int i=0; i<m; i++) order.push_back(std::pair<double,int>(-theta[i],i));
+   std::sort(order.begin(),order.end());
+
+   const double gamma=mp::gamma_SI;
+
+   std::vector<double> frequency;
+   std::vector<double> residual;
+   std::vector<double> amplitude;
+   std::vector<double> material_weight;
+
+   // G orthonormal basis of accepted modes. Each precessional mode spans the
+   // two dimensional invariant subspace (y, J G y) of T, so both members of a
+   // pair can appear as Ritz vectors and the second is discarded.
+   std::vector< std::vector<double> > B;
+   std::vector< std::vector<double> > GB;
+
+   for(int candidate=0; candidate<m && int(frequency.size())<num_modes; candidate++){
+
+      const int k=order[candidate].second;
+      if(theta[k]<=0.0) continue;
+      const double omega2=1.0/theta[k];
+
+      // Ritz vector y = V s
+      std::vector<double> y(n,0.0);
+      for(int j=0; j<m; j++){
+         const double c=s[j*m+k];
+         for(int i=0; i<n; i++) y[i]+=c*V[j][i];
+      }
+
+      std::vector<double> Gy;
+      system.apply_G(y,Gy);
+
+      // skip partner of an accepted mode
+      double overlap=0.0;
+      for(unsigned int j=0; j<B.size(); j++){
+         const double c=internal::dot(GB[j],y);
+         overlap+=c*c;
+      }
+      if(overlap>0.5*internal::dot(y,Gy)) continue;
+
+      // out of phase component z = J G y / omega of precession
+      const double inv_omega=1.0/sqrt(omega2);
+      std::vector<double> z(n);
+      for(int atom=0; atom<system.num_atoms; atom++){
+         z[2*atom]=Gy[2*atom+1]*inv_omega;
+         z[2*atom+1]=-Gy[2*atom]*inv_omega;
+      }
+      std::vector<double> Gz;
+      system.apply_G(z,Gz);
+
+      internal::add_to_basis(B,GB,y,Gy);
+      internal::add_to_basis(B,GB,z,Gz);
+
+      const int mode=frequency.size();
+      frequency.push_back(gamma*sqrt(omega2)/(2.0*M_PI));
+
+      // Ritz estimate of relative error in theta
+      residual.push_back(fabs(last_beta*s[(m-1)*m+k]/theta[k]));
+
+      amplitude.resize((mode+1)*system.num_atoms,0.0);
+      material_weight.resize((mode+1)*mp::num_materials,0.0);
+
+      double max_amplitude=0.0;
+      double total_weight=0.0;
+      for(int atom=0; atom<system.num_atoms; atom++){
+         const double weight=y[2*atom]*y[2*atom]+y[2*atom+1]*y[2*atom+1]+z[2*atom]*z[2*atom]+z[2*atom+1]*z[2*atom+1];
+         const double a=sqrt(weight)/system.root_mu[atom];
+         amplitude[mode*system.num_atoms+atom]=a;
+         if(a>max_amplitude) max_amplitude=a;
+         material_weight[mode*mp::num_materials+atoms::type_array[atom]]+=weight;
+         total_weight+=weight;
+      }
+
+      #ifdef MPICF
+         MPI_Allreduce(MPI_IN_PLACE, &max_amplitude, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+         MPI_Allreduce(MPI_IN_PLACE, &total_weight, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+         MPI_Allreduce(MPI_IN_PLACE, &material_weight[mode*mp::num_materials], mp::num_materials, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      #endif
+
+      if(max_amplitude>0.0) for(int atom=0; atom<system.num_atoms; atom++) amplitude[mode*system.num_atoms+atom]/=max_amplitude;
+      if(total_weight>0.0) for(int mat=0; mat<mp::num_materials; mat++) material_weight[mode*mp::num_materials+mat]/=total_weight;
+
+      zlog << zTs() << "Spin waves: mode " << mode+1 << " frequency " << frequency[mode]*1.0e-9 << " GHz, relative error " << residual[mode] << std::endl;
+
+   }
+
+   const int num_output_modes=frequency.size();
+   if(num_output_modes<num_modes) zlog << zTs() << "Spin waves: warning - only " << num_output_modes << " modes found, increase spin-wave-lanczos-steps" << std::endl;
+
+   zlog << zTs() << "Spin waves: " << system.num_operations << " applications of linearised Hamiltonian (" << 2*system.num_operations << " field evaluations)" << std::endl;
+
+   //---------------------------------------------------------------------------
+   // Output mode frequencies on root process
+   //---------------------------------------------------------------------------
+   if(vmpi::my_rank==0){
+
+      std::ofstream modes_file("spin-wave-modes");
+
+      modes_file << "#-----------------------------------------------------------" << std::endl;
+      modes_file << "# Spin wave eigenmodes of linearised LLG equation" << std::endl;
+      modes_file << "#-----------------------------------------------------------" << std::endl;
+      modes_file << "# applied field (T):      " << sim::H_applied << std::endl;
+      modes_file << "# degrees of freedom:     " << global_size << std::endl;
+      modes_file << "# Lanczos steps:          " << m << std::endl;
+      modes_file << "# field evaluations:      " << 2*system.num_operations << std::endl;
+      modes_file << "# residual torque:        " << max_torque << std::endl;
+      modes_file << "#" << std::endl;
+      modes_file << "# mode\tfrequency(GHz)\tomega(rad/s)\trelative_error";
+      for(int mat=0; mat<mp::num_materials; mat++) modes_file << "\tweight_material_" << mat+1;
+      modes_file << std::endl;
+
+      for(int mode=0; mode<num_output_modes; mode++){
+         modes_file << mode+1 << "\t" << frequency[mode]*1.0e-9 << "\t" << 2.0*M_PI*frequency[mode] << "\t" << residual[mode];
+         for(int mat=0; mat<mp::num_materials; mat++) modes_file << "\t" << material_weight[mode*mp::num_materials+mat];
+         modes_file << std::endl;
+      }
+
+      modes_file.close();
+
+   }
+
+   //---------------------------------------------------------------------------
+   // Output mode profiles on all processes
+   //---------------------------------------------------------------------------
+   std::stringstream profile_sstr;
+   profile_sstr << "spin-wave-mode-profiles";
+   if(vmpi::my_rank!=0) profile_sstr << "-" << std::setfill('0') << std::setw(5) << vmpi::my_rank;
+   std::ofstream profile_file(profile_sstr.str().c_str());
+
+   const bool coordinates = (atoms::x_coord_array.size()>=static_cast<unsigned int>(system.num_atoms));
+   profile_file << "# precession amplitude of each atom in each mode (normalised to maximum of 1)" << std::endl;
+   if(coordinates) profile_file << "# x\ty\tz\tmaterial";
+   else profile_file << "# atom\tmaterial";
+   for(int mode=0; mode<num_output_modes; mode++) profile_file << "\tmode_" << mode+1;
+   profile_file << std::endl;
+
+   for(int atom=0; atom<system.num_atoms; atom++){
+      if(coordinates) profile_file << atoms::x_coord_array[atom] << "\t" << atoms::y_coord_array[atom] << "\t" << atoms::z_coord_array[atom];
+      else profile_file << atom;
+      profile_file << "\t" << atoms::type_array[atom]+1;
+      for(int mode=0; mode<num_output_modes; mode++) profile_file << "\t" << amplitude[mode*system.num_atoms+atom];
+      profile_file << std::endl;
+   }
+
+   profile_file.close();
+
+   sim::temperature=temperature;
+
+   return;
+
+}
+
+}//end of namespace program
@@ -84,6 +84,12 @@ void time_series(){
 	sim::temperature=sim::Teq;
 	
 	// Equilibrate system
+	sim::set_telemetry_stage("equilibration", sim::equilibration_time);
+	if(sim::equilibration_integrator>=0 || sim::equilibration_tolerance>0.0){
+		if(sim::time<sim::equilibration_time) sim::equilibrate(sim::equilibration_time-sim::time);
+		stats::mag_m();
+		vout::data();
+	}
 	while(sim::time<sim::equilibration_time){
 		
 		sim::integrate(sim::partial_time);
@@ -101,6 +107,7 @@ void time_series(){
    stats::mag_m_reset();
 
 	// Perform Time Series
+	sim::set_telemetry_stage("time-series", sim::equilibration_time+sim::total_time);
 	while(sim::time<sim::equilibration_time+sim::total_time){
 
 		// Integrate system
@@ -56,9 +56,11 @@
 #include "errors.hpp"
 #include "LLG.hpp"
 #include "material.hpp"
+#include "sim.hpp"
 
 //Function prototypes
 int calculate_spin_fields(const int,const int);
+void pack_interleaved_spins(const int,const int);
 int calculate_external_fields(const int,const int);
 
 namespace LLG_arrays{
@@ -166,6 +168,9 @@ int LLG_Heun(){
 
 	// Check for initialisation of LLG integration arrays
 	if(LLG_set==false) sim::LLGinit();
+
+	// Spin transfer torque flag
+	const bool stt=sim::spin_transfer_torque;
 	
 	// Local variables for system integration
 	const int num_atoms=atoms::num_atoms;
@@ -181,6 +186,7 @@ int LLG_Heun(){
 	}
 
 	// Calculate fields
+	pack_interleaved_spins(0,num_atoms);
 	calculate_spin_fields(0,num_atoms);
 	calculate_external_fields(0,num_atoms);
 	
@@ -193,10 +199,13 @@ int LLG_Heun(){
 
 		// Store local spin in Sand local field in H
 		const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field
+		if(stt) sim::add_stt_field(imaterial, S, H);
+
 		// Calculate Delta S
 		xyz[0]=(one_oneplusalpha_sq)*(S[1]*H[2]-S[2]*H[1]) + (alpha_oneplusalpha_sq)*(S[1]*(S[0]*H[1]-S[1]*H[0])-S[2]*(S[2]*H[0]-S[0]*H[2]));
 		xyz[1]=(one_oneplusalpha_sq)*(S[2]*H[0]-S[0]*H[2]) + (alpha_oneplusalpha_sq)*(S[2]*(S[1]*H[2]-S[2]*H[1])-S[0]*(S[0]*H[1]-S[1]*H[0]));
@@ -233,6 +242,7 @@ int LLG_Heun(){
 	}
 		
 	// Recalculate spin dependent fields
+	pack_interleaved_spins(0,num_atoms);
 	calculate_spin_fields(0,num_atoms);
 		
 	// Calculate Heun Gradients
@@ -244,10 +254,13 @@ int LLG_Heun(){
 
 		// Store local spin in Sand local field in H
 		const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field
+		if(stt) sim::add_stt_field(imaterial, S, H);
+
 		// Calculate Delta S
 		xyz[0]=(one_oneplusalpha_sq)*(S[1]*H[2]-S[2]*H[1]) + (alpha_oneplusalpha_sq)*(S[1]*(S[0]*H[1]-S[1]*H[0])-S[2]*(S[2]*H[0]-S[0]*H[2]));
 		xyz[1]=(one_oneplusalpha_sq)*(S[2]*H[0]-S[0]*H[2]) + (alpha_oneplusalpha_sq)*(S[2]*(S[1]*H[2]-S[2]*H[1])-S[0]*(S[0]*H[1]-S[1]*H[0]));
@@ -259,6 +272,10 @@ int LLG_Heun(){
 		z_heun_array[atom]=xyz[2];
 	}
 
+	// Sum of moments for LaGrange multiplier
+	const bool lagrange=sim::lagrange_multiplier;
+	double lm[4]={0.0,0.0,0.0,0.0};
+
 	// Calculate Heun Step
 	for(int atom=0;atom<num_atoms;atom++){
 		S_new[0]=x_initial_spin_array[atom]+mp::half_dt*(x_euler_array[atom]+x_heun_array[atom]);
@@ -276,6 +293,21 @@ int LLG_Heun(){
 		atoms::x_spin_array[atom]=S_new[0];
 		atoms::y_spin_array[atom]=S_new[1];
 		atoms::z_spin_array[atom]=S_new[2];
+
+		// Add moment to system magnetisation
+		if(lagrange){
+			const double mu=atoms::m_spin_array[atom];
+			lm[0]+=S_new[0]*mu;
+			lm[1]+=S_new[1]*mu;
+			lm[2]+=S_new[2]*mu;
+			lm[3]+=mu;
+		}
+	}
+
+	// Save sum of moments for LaGrange multiplier update
+	if(lagrange){
+		for(int i=0;i<4;i++) sim::lagrange_local_moment[i]=lm[i];
+		sim::lagrange_local_moment_set=true;
 	}
 
 	return EXIT_SUCCESS;
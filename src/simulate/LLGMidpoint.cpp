@@ -60,6 +60,7 @@
 
 //Function prototypes
 int calculate_spin_fields(const int,const int);
+void pack_interleaved_spins(const int,const int);
 int calculate_external_fields(const int,const int);
 
 namespace sim{
@@ -96,6 +97,9 @@ int LLG_Midpoint(){
 
 	// Check for initialisation of LLG integration arrays
 	if(LLG_set==false) sim::LLGinit();
+
+	// Spin transfer torque flag
+	const bool stt=sim::spin_transfer_torque;
 	
 	// Local variables for system integration
 	const int num_atoms=atoms::num_atoms;
@@ -108,6 +112,7 @@ int LLG_Midpoint(){
 	}
 
 	// Calculate fields
+	pack_interleaved_spins(0,num_atoms);
 	calculate_spin_fields(0,num_atoms);
 	calculate_external_fields(0,num_atoms);
 	
@@ -121,10 +126,13 @@ int LLG_Midpoint(){
 		
 		// Store local spin in S and local field in H
 		const double S[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field
+		if(stt) sim::add_stt_field(imaterial, S, H);
+
 		// Calculate F = [H + alpha* (S x H)]
 		const double F[3] = {H[0] + alpha*(S[1]*H[2]-S[2]*H[1]),
 									H[1] + alpha*(S[2]*H[0]-S[0]*H[2]),
@@ -150,8 +158,13 @@ int LLG_Midpoint(){
 	}
 		
 	// Recalculate spin dependent fields
+	pack_interleaved_spins(0,num_atoms);
 	calculate_spin_fields(0,num_atoms);
 		
+	// Sum of moments for LaGrange multiplier
+	const bool lagrange=sim::lagrange_multiplier;
+	double lm[4]={0.0,0.0,0.0,0.0};
+
 	// Calculate Corrector Step
 	for(int atom=0;atom<num_atoms;atom++){
 
@@ -163,10 +176,13 @@ int LLG_Midpoint(){
 		// Store local spin in S and local field in H
 		const double M[3] = {atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
 		const double S[3] = {x_initial_spin_array[atom],y_initial_spin_array[atom],z_initial_spin_array[atom]};
-		const double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
+		double H[3] = {atoms::x_total_spin_field_array[atom]+atoms::x_total_external_field_array[atom],
 									atoms::y_total_spin_field_array[atom]+atoms::y_total_external_field_array[atom],
 									atoms::z_total_spin_field_array[atom]+atoms::z_total_external_field_array[atom]};
 
+		// Add spin transfer torque field a_j (M x p) + b_j p
+		if(stt) sim::add_stt_field(imaterial, M, H);
+
 		// Calculate F = [H + alpha* (M x H)]
 		const double F[3] = {H[0] + alpha*(M[1]*H[2]-M[2]*H[1]),
 									H[1] + alpha*(M[2]*H[0]-M[0]*H[2]),
@@ -181,6 +197,21 @@ int LLG_Midpoint(){
 		atoms::x_spin_array[atom] = one_o_one_plus_beta2FdotF*(S[0]*one_minus_beta2FdotF + 2.0*(beta*(F[1]*S[2]-F[2]*S[1]) + F[0]*beta2FdotS));
 		atoms::y_spin_array[atom] = one_o_one_plus_beta2FdotF*(S[1]*one_minus_beta2FdotF + 2.0*(beta*(F[2]*S[0]-F[0]*S[2]) + F[1]*beta2FdotS));
 		atoms::z_spin_array[atom] = one_o_one_plus_beta2FdotF*(S[2]*one_minus_beta2FdotF + 2.0*(beta*(F[0]*S[1]-F[1]*S[0]) + F[2]*beta2FdotS));
+
+		// Add moment to system magnetisation
+		if(lagrange){
+			const double mu=atoms::m_spin_array[atom];
+			lm[0]+=atoms::x_spin_array[atom]*mu;
+			lm[1]+=atoms::y_spin_array[atom]*mu;
+			lm[2]+=atoms::z_spin_array[atom]*mu;
+			lm[3]+=mu;
+		}
+	}
+
+	// Save sum of moments for LaGrange multiplier update
+	if(lagrange){
+		for(int i=0;i<4;i++) sim::lagrange_local_moment[i]=lm[i];
+		sim::lagrange_local_moment_set=true;
 	}
 
 	return EXIT_SUCCESS;
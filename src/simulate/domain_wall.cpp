@@ -0,0 +1,312 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Domain wall position tracking and co-moving simulation frame.
+//
+//   The wire axis is the x-direction. The m_z profile along the wire is
+//   calculated for slices one unit cell thick, and the wall position is the
+//   (linearly interpolated) zero crossing of m_z closest to the last known
+//   wall position.
+//
+//   With a moving frame, whenever the wall has drifted by at least one unit
+//   cell from its initial position, all spins are shifted by a whole number
+//   of unit cells along the wire to bring it back, and the slices exposed
+//   at the end of the wire are set to the magnetisation of that end found
+//   when tracking started. Long distance wall motion can then be simulated
+//   with a short box, with the wall position in the laboratory frame given
+//   by the accumulated shift of the frame plus the position in the box.
+//
+//   The wall position is updated at the end of every call to sim::integrate.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "cells.hpp"
+#include "create.hpp"
+#include "errors.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace sim{
+
+   bool domain_wall_tracking=false; // Track domain wall position along x
+   bool domain_wall_moving_frame=false; // Shift spins to keep domain wall in simulation box
+   double domain_wall_position=0.0; // Domain wall position in laboratory frame (A)
+   int domain_wall_frame_shift=0; // Total shift of simulation frame (unit cells)
+
+   namespace internal{
+
+      bool dw_initialised=false; // Flag if reference position and end magnetisation are set
+      double dw_box_position=0.0; // Wall position in simulation box (unit cells)
+      double dw_reference_position=0.0; // Initial wall position in simulation box (unit cells)
+      double dw_end_magnetisation[6]={0.0,0.0,0.0,0.0,0.0,0.0}; // Magnetisation direction at x=0 and x=max
+
+      //-----------------------------------------------------------------------
+      // Function to calculate mu_s weighted spin sums for each slice along x
+      //-----------------------------------------------------------------------
+      void slice_magnetisation(std::vector<double>& slice_m){
+
+         const int num_slices=cs::total_num_unit_cells[0];
+         const int num_local_atoms=atoms::num_atoms-vmpi::num_halo_atoms;
+
+         // mx, my, mz, mu for each slice
+         slice_m.assign(4*num_slices,0.0);
+
+         for(int atom=0;atom<num_local_atoms;atom++){
+            const int slice=cs::unit_cell_index_array[4*atom];
+            if(slice<0 || slice>=num_slices) continue;
+            const double mu=atoms::m_spin_array[atom];
+            slice_m[4*slice+0]+=mu*atoms::x_spin_array[atom];
+            slice_m[4*slice+1]+=mu*atoms::y_spin_array[atom];
+            slice_m[4*slice+2]+=mu*atoms::z_spin_array[atom];
+            slice_m[4*slice+3]+=mu;
+         }
+
+         #ifdef MPICF
+            MPI_Allreduce(MPI_IN_PLACE,&slice_m[0],4*num_slices,MPI_DOUBLE,MPI_SUM,MPI_COMM_WORLD);
+         #endif
+
+         return;
+
+      }
+
+      #ifdef MPICF
+      //-----------------------------------------------------------------------
+      // Function to exchange sites needed for a shift by one unit cell along
+      // x. Only sites whose source cell is not local are sent, to the
+      // neighbouring cpu along x for the geometric decomposition, or to all
+      // cpus otherwise. Received sites are added to the box of local cells.
+      //-----------------------------------------------------------------------
+      void exchange_boundary_sites(const int d, const std::vector<int>& atom_box_index, const int cmin[3], const int box_size[3],
+                                   std::vector<double>& box_spin, std::vector<bool>& box_filled){
+
+         const int n0=cs::total_num_unit_cells[0];
+         const int nuc=cells::num_atoms_in_unit_cell;
+         const int num_local_atoms=atoms::num_atoms-vmpi::num_halo_atoms;
+         const int slice_size=box_size[1]*box_size[2]*nuc;
+
+         // pack sites needed by other cpus (source for a cell which is not local)
+         std::vector<int> send_site(0);
+         std::vector<double> send_spin(0);
+         for(int atom=0;atom<num_local_atoms;atom++){
+            const int idx=atom_box_index[atom];
+            if(idx<0) continue;
+            const int* c=&cs::unit_cell_index_array[4*atom];
+            if(c[0]-d<0 || c[0]-d>=n0 || box_filled[idx-d*slice_size]) continue;
+            for(int i=0;i<4;i++) send_site.push_back(c[i]);
+            for(int i=0;i<3;i++) send_spin.push_back(box_spin[3*idx+i]);
+         }
+
+         // determine cpus to exchange sites with
+         std::vector<int> send_cpu(0);
+         std::vector<int> recv_cpu(0);
+         if(vmpi::mpi_mode==0 && vmpi::max_dimensions[0]-vmpi::min_dimensions[0]>=cs::unit_cell_size[0]){
+            const int nx=vmpi::decomposition_grid[0];
+            const int ny=vmpi::decomposition_grid[1];
+            const int rank_x=(vmpi::my_rank%(nx*ny))/ny;
+            send_cpu.push_back(rank_x-d>=0 && rank_x-d<nx ? vmpi::my_rank-d*ny : MPI_PROC_NULL);
+            recv_cpu.push_back(rank_x+d>=0 && rank_x+d<nx ? vmpi::my_rank+d*ny : MPI_PROC_NULL);
+         }
+         else{
+            for(int p=1;p<vmpi::num_processors;p++){
+               send_cpu.push_back((vmpi::my_rank+p)%vmpi::num_processors);
+               recv_cpu.push_back((vmpi::my_rank-p+vmpi::num_processors)%vmpi::num_processors);
+            }
+         }
+
+         // exchange sites and add to box
+         int num_send=send_spin.size()/3;
+         std::vector<int> recv_site(0);
+         std::vector<double> recv_spin(0);
+         send_site.resize(4*num_send+1);
+         send_spin.resize(3*num_send+1);
+         for(unsigned int p=0;p<send_cpu.size();p++){
+            int num_recv=0;
+            MPI_Sendrecv(&num_send,1,MPI_INT,send_cpu[p],50,&num_recv,1,MPI_INT,recv_cpu[p],50,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+            recv_site.resize(4*num_recv+1);
+            recv_spin.resize(3*num_recv+1);
+            MPI_Sendrecv(&send_site[0],4*num_send,MPI_INT,send_cpu[p],51,&recv_site[0],4*num_recv,MPI_INT,recv_cpu[p],51,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+            MPI_Sendrecv(&send_spin[0],3*num_send,MPI_DOUBLE,send_cpu[p],52,&recv_spin[0],3*num_recv,MPI_DOUBLE,recv_cpu[p],52,MPI_COMM_WORLD,MPI_STATUS_IGNORE);
+            for(int r=0;r<num_recv;r++){
+               const int* c=&recv_site[4*r];
+               const int b[3]={c[0]-cmin[0]+1,c[1]-cmin[1],c[2]-cmin[2]};
+               if(b[0]<0 || b[0]>=box_size[0] || b[1]<0 || b[1]>=box_size[1] || b[2]<0 || b[2]>=box_size[2]) continue;
+               const int idx=((b[0]*box_size[1]+b[1])*box_size[2]+b[2])*nuc+c[3];
+               for(int i=0;i<3;i++) box_spin[3*idx+i]=recv_spin[3*r+i];
+               box_filled[idx]=true;
+            }
+         }
+
+         return;
+
+      }
+      #endif
+
+      //-----------------------------------------------------------------------
+      // Function to shift all spins by shift unit cells towards -x, setting
+      // exposed slices to the end magnetisation. Spins are shifted one unit
+      // cell at a time using a box of the local unit cells padded by one
+      // slice in x.
+      //-----------------------------------------------------------------------
+      void shift_spins(const int shift){
+
+         const int n[3]={int(cs::total_num_unit_cells[0]),int(cs::total_num_unit_cells[1]),int(cs::total_num_unit_cells[2])};
+         const int nuc=cells::num_atoms_in_unit_cell;
+         const int num_local_atoms=atoms::num_atoms-vmpi::num_halo_atoms;
+
+         // determine range of local unit cells
+         int cmin[3]={n[0],n[1],n[2]};
+         int cmax[3]={-1,-1,-1};
+         for(int atom=0;atom<num_local_atoms;atom++){
+            const int* c=&cs::unit_cell_index_array[4*atom];
+            if(c[0]<0 || c[0]>=n[0] || c[1]<0 || c[1]>=n[1] || c[2]<0 || c[2]>=n[2]) continue;
+            for(int i=0;i<3;i++){
+               if(c[i]<cmin[i]) cmin[i]=c[i];
+               if(c[i]>cmax[i]) cmax[i]=c[i];
+            }
+         }
+
+         // box of local unit cells padded by one slice either side in x
+         int box_size[3]={0,0,0};
+         if(cmax[0]>=0){
+            for(int i=0;i<3;i++) box_size[i]=cmax[i]-cmin[i]+1;
+            box_size[0]+=2;
+         }
+         const int slice_size=box_size[1]*box_size[2]*nuc;
+
+         // index of each local atom in box
+         std::vector<int> atom_box_index(num_local_atoms,-1);
+         for(int atom=0;atom<num_local_atoms;atom++){
+            const int* c=&cs::unit_cell_index_array[4*atom];
+            if(c[0]<0 || c[0]>=n[0] || c[1]<0 || c[1]>=n[1] || c[2]<0 || c[2]>=n[2]) continue;
+            atom_box_index[atom]=(((c[0]-cmin[0]+1)*box_size[1]+c[1]-cmin[1])*box_size[2]+c[2]-cmin[2])*nuc+c[3];
+         }
+
+         std::vector<double> box_spin(3*box_size[0]*slice_size);
+         std::vector<bool> box_filled(box_size[0]*slice_size);
+
+         // shift by one unit cell at a time (d = +1 towards -x, d = -1 towards +x)
+         const int d = shift>0 ? 1 : -1;
+         for(int step=0;step<abs(shift);step++){
+
+            // copy local spins to box
+            std::fill(box_filled.begin(),box_filled.end(),false);
+            for(int atom=0;atom<num_local_atoms;atom++){
+               const int idx=atom_box_index[atom];
+               if(idx<0) continue;
+               box_spin[3*idx+0]=atoms::x_spin_array[atom];
+               box_spin[3*idx+1]=atoms::y_spin_array[atom];
+               box_spin[3*idx+2]=atoms::z_spin_array[atom];
+               box_filled[idx]=true;
+            }
+
+            #ifdef MPICF
+               exchange_boundary_sites(d, atom_box_index, cmin, box_size, box_spin, box_filled);
+            #endif
+
+            // set spins from site one unit cell along x
+            for(int atom=0;atom<num_local_atoms;atom++){
+               const int idx=atom_box_index[atom];
+               if(idx<0) continue;
+               const int x=cs::unit_cell_index_array[4*atom]+d;
+               const double* s;
+               if(x<0) s=&dw_end_magnetisation[0];
+               else if(x>=n[0]) s=&dw_end_magnetisation[3];
+               else if(box_filled[idx+d*slice_size]) s=&box_spin[3*(idx+d*slice_size)];
+               // empty sites keep their spin
+               else continue;
+               if(s[0]==0.0 && s[1]==0.0 && s[2]==0.0) continue;
+               atoms::x_spin_array[atom]=s[0];
+               atoms::y_spin_array[atom]=s[1];
+               atoms::z_spin_array[atom]=s[2];
+            }
+
+         }
+
+         return;
+
+      }
+
+   } // end of internal namespace
+
+   //--------------------------------------------------------------------------
+   // Function to update domain wall position and shift moving frame
+   //--------------------------------------------------------------------------
+   void update_domain_wall_tracking(){
+
+      if(!sim::domain_wall_tracking) return;
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "sim::update_domain_wall_tracking has been called" << std::endl;
+
+      const int num_slices=cs::total_num_unit_cells[0];
+      if(num_slices<2 || int(cs::unit_cell_index_array.size())<4*(atoms::num_atoms-vmpi::num_halo_atoms)) return;
+
+      std::vector<double> slice_m;
+      internal::slice_magnetisation(slice_m);
+
+      std::vector<double> mz(num_slices,0.0);
+      for(int slice=0;slice<num_slices;slice++){
+         if(slice_m[4*slice+3]>0.0) mz[slice]=slice_m[4*slice+2]/slice_m[4*slice+3];
+      }
+
+      // set reference position and magnetisation at ends of wire
+      if(!internal::dw_initialised){
+         for(int end=0;end<2;end++){
+            const int slice = end==0 ? 0 : num_slices-1;
+            const double* m=&slice_m[4*slice];
+            const double mm=sqrt(m[0]*m[0]+m[1]*m[1]+m[2]*m[2]);
+            for(int i=0;i<3;i++) internal::dw_end_magnetisation[3*end+i] = mm>0.0 ? m[i]/mm : 0.0;
+         }
+         internal::dw_box_position=0.5*double(num_slices);
+      }
+
+      // find zero crossing of m_z closest to last wall position
+      bool found=false;
+      double position=internal::dw_box_position;
+      for(int slice=0;slice<num_slices-1;slice++){
+         if(mz[slice]*mz[slice+1]>0.0 || mz[slice]==mz[slice+1]) continue;
+         const double x=double(slice)+0.5+mz[slice]/(mz[slice]-mz[slice+1]);
+         if(!found || fabs(x-internal::dw_box_position)<fabs(position-internal::dw_box_position)) position=x;
+         found=true;
+      }
+      internal::dw_box_position=position;
+
+      if(!internal::dw_initialised){
+         internal::dw_reference_position=position;
+         internal::dw_initialised=true;
+         zlog << zTs() << "Domain wall tracking initialised with wall at x = " << position*cs::unit_cell_size[0] << " A";
+         if(!found) zlog << " (no zero crossing of m_z found)";
+         zlog << std::endl;
+      }
+
+      // shift spins to keep wall at its initial position
+      if(sim::domain_wall_moving_frame && found){
+         const int shift=int(internal::dw_box_position-internal::dw_reference_position);
+         if(shift!=0){
+            internal::shift_spins(shift);
+            internal::dw_box_position-=double(shift);
+            sim::domain_wall_frame_shift+=shift;
+         }
+      }
+
+      sim::domain_wall_position=(double(sim::domain_wall_frame_shift)+internal::dw_box_position)*cs::unit_cell_size[0];
+
+      return;
+
+   }
+
+} // end of namespace sim
@@ -59,10 +59,48 @@
 #include "random.hpp"
 #include "sim.hpp"
 #include "vio.hpp"
+#include "vmath.hpp"
 #include "vmpi.hpp"
 
 namespace sim{
 
+//------------------------------------------------------------------------------
+///  Function to calculate temperature rescaled exchange energy for a single
+///  spin, E = r_i sum_j J_ij r_j S_j . S_i (see interaction_rescaling.cpp)
+//------------------------------------------------------------------------------
+double rescaled_spin_exchange_energy(const int atom, const double Sx, const double Sy, const double Sz){
+
+	double energy=0.0;
+
+	for(int nn=atoms::neighbour_list_start_index[atom];nn<=atoms::neighbour_list_end_index[atom];nn++){
+
+		const int natom = atoms::neighbour_list_array[nn];
+		const int iid = atoms::neighbour_interaction_type_array[nn];
+		const double r = sim::exchange_rescaling_root[atoms::type_array[natom]];
+		const double S[3]={r*atoms::x_spin_array[natom],r*atoms::y_spin_array[natom],r*atoms::z_spin_array[natom]};
+
+		switch(atoms::exchange_type){
+			case 0: // isotropic
+				energy+=atoms::i_exchange_list[iid].Jij*(S[0]*Sx + S[1]*Sy + S[2]*Sz);
+				break;
+			case 1: // vector
+				energy+=(atoms::v_exchange_list[iid].Jij[0]*S[0]*Sx + atoms::v_exchange_list[iid].Jij[1]*S[1]*Sy + atoms::v_exchange_list[iid].Jij[2]*S[2]*Sz);
+				break;
+			case 2: // tensor
+				{
+					const double (&Jij)[3][3] = atoms::t_exchange_list[iid].Jij;
+					energy+=(Jij[0][0]*S[0]*Sx + Jij[0][1]*S[1]*Sx +Jij[0][2]*S[2]*Sx +
+								Jij[1][0]*S[0]*Sy + Jij[1][1]*S[1]*Sy +Jij[1][2]*S[2]*Sy +
+								Jij[2][0]*S[0]*Sz + Jij[2][1]*S[1]*Sz +Jij[2][2]*S[2]*Sz);
+				}
+				break;
+		}
+	}
+
+	return sim::exchange_rescaling_root[atoms::type_array[atom]]*energy;
+
+}
+
 /// @brief Calculates the exchange energy for a single spin (isotropic).
 ///
 /// @section License
@@ -88,6 +126,9 @@ namespace sim{
 ///
 double spin_exchange_energy_isotropic(const int atom, const double Sx, const double Sy, const double Sz){
 	
+	// temperature rescaled exchange
+	if(sim::interaction_rescaling) return rescaled_spin_exchange_energy(atom, Sx, Sy, Sz);
+
 	// energy
 	double energy=0.0;
 	
@@ -128,6 +169,9 @@ double spin_exchange_energy_isotropic(const int atom, const double Sx, const dou
 ///
 double spin_exchange_energy_vector(const int atom, const double Sx, const double Sy, const double Sz){
 	
+	// temperature rescaled exchange
+	if(sim::interaction_rescaling) return rescaled_spin_exchange_energy(atom, Sx, Sy, Sz);
+
 	// energy
 	double energy=0.0;
 	
@@ -170,6 +214,9 @@ double spin_exchange_energy_vector(const int atom, const double Sx, const double
 ///
 double spin_exchange_energy_tensor(const int atom, const double Sx, const double Sy, const double Sz){
 	
+	// temperature rescaled exchange
+	if(sim::interaction_rescaling) return rescaled_spin_exchange_energy(atom, Sx, Sy, Sz);
+
 	// energy
 	double energy=0.0;
 	
@@ -226,7 +273,7 @@ double spin_exchange_energy_tensor(const int atom, const double Sx, const double
 ///
 double spin_scalar_anisotropy_energy(const int imaterial, const double Sz){
 	
-	return mp::MaterialScalarAnisotropyArray[imaterial].K*Sz*Sz;
+	return sim::anisotropy_rescaling[imaterial]*mp::MaterialScalarAnisotropyArray[imaterial].K*Sz*Sz;
 	
 }
 // E = Ku(S . e)(S . e) = (Sxex + Syey + Szez)**2 = Sx exSxex + 2*Sx exSyey + 2*Sx exSzez + SyeySyey + 2*SyeySzez+ SzezSzez ==
@@ -249,12 +296,28 @@ double spin_tensor_anisotropy_energy(const int imaterial, const double Sx, const
 								 mp::MaterialTensorAnisotropyArray[imaterial].K[2][1],
 								 mp::MaterialTensorAnisotropyArray[imaterial].K[2][2]};
 								 
-	return (K[0][0]*Sx*Sx + K[0][1]*Sx*Sy +K[0][2]*Sx*Sz) +
+	return sim::anisotropy_rescaling[imaterial]*(
+			 (K[0][0]*Sx*Sx + K[0][1]*Sx*Sy +K[0][2]*Sx*Sz) +
 			 (K[1][0]*Sx*Sy + K[1][1]*Sy*Sy +K[1][2]*Sy*Sz) +
-			 (K[2][0]*Sx*Sz + K[2][1]*Sy*Sz +K[2][2]*Sz*Sz);
+			 (K[2][0]*Sx*Sz + K[2][1]*Sy*Sz +K[2][2]*Sz*Sz));
 	
 }
 
+//--------------------------------------------------------------
+//
+///  Function to calculate uniaxial anisotropy energy along
+///  the local (per-atom) easy axis e
+//
+///  E = Ku (S . e)^2
+//
+//---------------------------------------------------------------
+double spin_local_uniaxial_anisotropy_energy(const int atom, const int imaterial, const double Sx, const double Sy, const double Sz){
+   double ex, ey, ez;
+   vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
+   const double Sdote=Sx*ex + Sy*ey + Sz*ez;
+   return sim::anisotropy_rescaling[imaterial]*mp::MaterialScalarAnisotropyArray[imaterial].K*Sdote*Sdote;
+}
+
 double spin_cubic_anisotropy_energy(const int imaterial, const double Sx, const double Sy, const double Sz){
 	///------------------------------------------------------
 	/// 	Function to calculate cubic anisotropy energy
@@ -265,7 +328,7 @@ double spin_cubic_anisotropy_energy(const int imaterial, const double Sx, const
 	///	
 	///------------------------------------------------------
 	//std::cout << "here" << imaterial << "\t" << std::endl; 
-	return 0.5*mp::MaterialCubicAnisotropyArray[imaterial]*(Sx*Sx*Sx*Sx + Sy*Sy*Sy*Sy + Sz*Sz*Sz*Sz);
+	return 0.5*sim::anisotropy_rescaling[imaterial]*mp::MaterialCubicAnisotropyArray[imaterial]*(Sx*Sx*Sx*Sx + Sy*Sy*Sy*Sy + Sz*Sz*Sz*Sz);
 
 }
 
@@ -278,14 +341,15 @@ double spin_cubic_anisotropy_energy(const int imaterial, const double Sx, const
 ///  E = K2 (-2Sz^2 + Sz^4)
 ///
 ///---------------------------------------------------------------
-double spin_second_order_uniaxial_anisotropy_energy(const int imaterial, const double Sx, const double Sy, const double Sz){
-   const double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
-   const double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
-   const double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+double spin_second_order_uniaxial_anisotropy_energy(const int atom, const int imaterial, const double Sx, const double Sy, const double Sz){
+   double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
+   double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
+   double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+   if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
    const double Sdote=Sx*ex + Sy*ey + Sz*ez;
    const double Sdote2=Sdote*Sdote;
    const double Sdote4=Sdote2*Sdote2;
-   return mp::material_second_order_anisotropy_constant_array[imaterial]*(Sdote4);
+   return sim::anisotropy_rescaling[imaterial]*mp::material_second_order_anisotropy_constant_array[imaterial]*(Sdote4);
 }
 
 //--------------------------------------------------------------
@@ -297,14 +361,15 @@ double spin_second_order_uniaxial_anisotropy_energy(const int imaterial, const d
 ///  E = K3 (Sz^6)
 //
 //---------------------------------------------------------------
-double spin_sixth_order_uniaxial_anisotropy_energy(const int imaterial, const double Sx, const double Sy, const double Sz){
-   const double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
-   const double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
-   const double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+double spin_sixth_order_uniaxial_anisotropy_energy(const int atom, const int imaterial, const double Sx, const double Sy, const double Sz){
+   double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
+   double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
+   double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+   if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
    const double Sdote=Sx*ex + Sy*ey + Sz*ez;
    const double Sdote3=Sdote*Sdote*Sdote;
    const double Sdote6=Sdote3*Sdote3;
-   return mp::material_sixth_order_anisotropy_constant_array[imaterial]*(Sdote6);
+   return sim::anisotropy_rescaling[imaterial]*mp::material_sixth_order_anisotropy_constant_array[imaterial]*(Sdote6);
 }
 
 //------------------------------------------------------
@@ -321,12 +386,13 @@ double spin_sixth_order_uniaxial_anisotropy_energy(const int imaterial, const do
 ///  E = kappa * S_z^2
 //
 //------------------------------------------------------
-double spin_lattice_anisotropy_energy(const int imaterial, const double Sx, const double Sy, const double Sz){
+double spin_lattice_anisotropy_energy(const int atom, const int imaterial, const double Sx, const double Sy, const double Sz){
 
    const double klatt=mp::material[imaterial].Klatt*mp::material[imaterial].lattice_anisotropy.get_lattice_anisotropy_constant(sim::temperature);
-   const double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector[0];
-   const double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector[1];
-   const double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector[2];
+   double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector[0];
+   double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector[1];
+   double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector[2];
+   if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
    const double Sdote=Sx*ex + Sy*ey + Sz*ez;
 
    return klatt*(Sdote*Sdote);
@@ -355,7 +421,7 @@ double spin_lattice_anisotropy_energy(const int imaterial, const double Sx, cons
 ///  simultaneously.
 ///
 ///--------------------------------------------------------------------------------------------------------------
-double spin_spherical_harmonic_aniostropy_energy(const int imaterial, const double sx, const double sy, const double sz){
+double spin_spherical_harmonic_aniostropy_energy(const int atom, const int imaterial, const double sx, const double sy, const double sz){
 
    // rescaling prefactor
    const double scale = -2.0/3.0; // Factor to rescale anisotropies to usual scale
@@ -371,9 +437,10 @@ double spin_spherical_harmonic_aniostropy_energy(const int imaterial, const doub
    const double k6 = mp::material_spherical_harmonic_constants_array[3*imaterial + 2];
 
    // determine anisotropy direction and dot product
-   const double ex = mp::material[imaterial].UniaxialAnisotropyUnitVector[0];
-   const double ey = mp::material[imaterial].UniaxialAnisotropyUnitVector[1];
-   const double ez = mp::material[imaterial].UniaxialAnisotropyUnitVector[2];
+   double ex = mp::material[imaterial].UniaxialAnisotropyUnitVector[0];
+   double ey = mp::material[imaterial].UniaxialAnisotropyUnitVector[1];
+   double ez = mp::material[imaterial].UniaxialAnisotropyUnitVector[2];
+   if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
 
    const double sdote2 = (sx*ex + sy*ey + sz*ez)*(sx*ex + sy*ey + sz*ez);
    const double sdote4 = sdote2*sdote2;
@@ -384,7 +451,7 @@ double spin_spherical_harmonic_aniostropy_energy(const int imaterial, const doub
                                 k4*oneo8*(35.0*sdote4 - 30.0*sdote2 + 3.0) +
                                 k6*oneo16*(231.0*sdote6 - 315.0*sdote4 + 105.0*sdote2 - 5.0));
 
-   return energy;
+   return sim::anisotropy_rescaling[imaterial]*energy;
 
 }
 
@@ -529,14 +596,15 @@ double calculate_spin_energy(const int atom, const int AtomExchangeType){
 		case 0: energy+=spin_scalar_anisotropy_energy(imaterial, Sz); break;
 		case 1: energy+=spin_tensor_anisotropy_energy(imaterial, Sx, Sy, Sz); break;
 		case 2: ; break; // skip
-		default: zlog << zTs() << "Error. sim::AnisotropyType has value " << sim::AnisotropyType << " which is outside of valid range 0-1. Exiting." << std::endl; err::vexit();
+		case 3: energy+=spin_local_uniaxial_anisotropy_energy(atom, imaterial, Sx, Sy, Sz); break;
+		default: zlog << zTs() << "Error. sim::AnisotropyType has value " << sim::AnisotropyType << " which is outside of valid range 0-3. Exiting." << std::endl; err::vexit();
 	}
-	if(second_order_uniaxial_anisotropy) energy+=spin_second_order_uniaxial_anisotropy_energy(imaterial, Sx, Sy, Sz);
-   if(sixth_order_uniaxial_anisotropy) energy+=spin_sixth_order_uniaxial_anisotropy_energy(imaterial, Sx, Sy, Sz);
+	if(second_order_uniaxial_anisotropy) energy+=spin_second_order_uniaxial_anisotropy_energy(atom, imaterial, Sx, Sy, Sz);
+   if(sixth_order_uniaxial_anisotropy) energy+=spin_sixth_order_uniaxial_anisotropy_energy(atom, imaterial, Sx, Sy, Sz);
 	if(sim::CubicScalarAnisotropy==true) energy+=spin_cubic_anisotropy_energy(imaterial, Sx, Sy, Sz);
-   if(sim::lattice_anisotropy_flag) energy+=spin_lattice_anisotropy_energy(imaterial, Sx, Sy, Sz);
+   if(sim::lattice_anisotropy_flag) energy+=spin_lattice_anisotropy_energy(atom, imaterial, Sx, Sy, Sz);
 	if(sim::surface_anisotropy==true) energy+=spin_surface_anisotropy_energy(atom, imaterial, Sx, Sy, Sz);
-   if(sim::spherical_harmonics) energy += spin_spherical_harmonic_aniostropy_energy(imaterial, Sx, Sy, Sz);
+   if(sim::spherical_harmonics) energy += spin_spherical_harmonic_aniostropy_energy(atom, imaterial, Sx, Sy, Sz);
 	energy+=spin_applied_field_energy(Sx, Sy, Sz);
 	energy+=spin_magnetostatic_energy(atom, Sx, Sy, Sz);
 	
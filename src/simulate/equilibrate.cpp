@@ -0,0 +1,179 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Equilibration stage of standard programs.
+//
+//   The equilibration stage can be run with a different integrator to the
+//   production stage (sim:equilibration-integrator), usually Monte Carlo
+//   which reaches the thermal state in far fewer steps than LLG at low
+//   damping. After equilibration the production integrator is restored and
+//   the LLG integration arrays are reinitialised.
+//
+//   Optionally the equilibration is stopped early when the drift of the
+//   mean reduced magnetisation between successive blocks of
+//   sim:partial-time-steps is less than sim:equilibration-tolerance. The
+//   time counter is then advanced to the end of the stage so that the
+//   schedule of the production stage is unchanged.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "LLG.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace sim{
+
+   int equilibration_integrator=-1; // Integrator for equilibration stage, -1 = same as production
+   double equilibration_tolerance=0.0; // Magnetisation drift for early stop of equilibration, 0 = disabled
+
+   namespace internal{
+
+      //-----------------------------------------------------------------------
+      // Function to calculate the reduced magnetisation length of the system
+      //-----------------------------------------------------------------------
+      double reduced_magnetisation(){
+
+         #ifdef MPICF
+            const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+         #else
+            const int num_local_atoms = atoms::num_atoms;
+         #endif
+
+         double m[4]={0.0,0.0,0.0,0.0};
+         for(int atom=0; atom<num_local_atoms; atom++){
+            const double mu=atoms::m_spin_array[atom];
+            m[0]+=mu*atoms::x_spin_array[atom];
+            m[1]+=mu*atoms::y_spin_array[atom];
+            m[2]+=mu*atoms::z_spin_array[atom];
+            m[3]+=mu;
+         }
+
+         #ifdef MPICF
+            MPI_Allreduce(MPI_IN_PLACE, m, 4, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+         #endif
+
+         if(m[3]==0.0) return 0.0;
+
+         return sqrt(m[0]*m[0]+m[1]*m[1]+m[2]*m[2])/m[3];
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to release LLG integration arrays so that they are
+      // reinitialised by the next LLG step
+      //-----------------------------------------------------------------------
+      void reset_llg_arrays(){
+
+         using namespace LLG_arrays;
+
+         std::vector<double>().swap(x_euler_array);
+         std::vector<double>().swap(y_euler_array);
+         std::vector<double>().swap(z_euler_array);
+
+         std::vector<double>().swap(x_heun_array);
+         std::vector<double>().swap(y_heun_array);
+         std::vector<double>().swap(z_heun_array);
+
+         std::vector<double>().swap(x_spin_storage_array);
+         std::vector<double>().swap(y_spin_storage_array);
+         std::vector<double>().swap(z_spin_storage_array);
+
+         std::vector<double>().swap(x_initial_spin_array);
+         std::vector<double>().swap(y_initial_spin_array);
+         std::vector<double>().swap(z_initial_spin_array);
+
+         LLG_set=false;
+
+         return;
+
+      }
+
+   } // end of internal namespace
+
+   //--------------------------------------------------------------------------
+   // Function to equilibrate the system for n_steps time steps. Equivalent
+   // to sim::integrate(n_steps) unless an equilibration integrator or drift
+   // tolerance is set.
+   //--------------------------------------------------------------------------
+   void equilibrate(const uint64_t n_steps){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "sim::equilibrate has been called" << std::endl;
+
+      const bool switch_integrator = (sim::equilibration_integrator>=0 && sim::equilibration_integrator!=sim::integrator);
+      const bool early_stop = (sim::equilibration_tolerance>0.0);
+
+      if(!switch_integrator && !early_stop){
+         sim::integrate(n_steps);
+         return;
+      }
+
+      if(n_steps==0) return;
+
+      // Switch to equilibration integrator
+      const int production_integrator=sim::integrator;
+      if(switch_integrator) sim::integrator=sim::equilibration_integrator;
+
+      const uint64_t start_time=sim::time;
+      const uint64_t end_time=start_time+n_steps;
+
+      if(!early_stop) sim::integrate(n_steps);
+      else{
+
+         // Integrate in blocks and compare mean magnetisation of successive
+         // blocks, sampled ten times per block
+         const uint64_t block_steps = sim::partial_time > 0 ? sim::partial_time : 1;
+         const uint64_t sample_steps = block_steps >= 10 ? block_steps/10 : 1;
+         double last_block_m=-1.0;
+
+         while(sim::time<end_time){
+
+            const uint64_t block_end = end_time-sim::time < block_steps ? end_time : sim::time+block_steps;
+
+            double block_m=0.0;
+            int num_samples=0;
+            while(sim::time<block_end){
+               const uint64_t steps = block_end-sim::time < sample_steps ? block_end-sim::time : sample_steps;
+               sim::integrate(steps);
+               block_m+=internal::reduced_magnetisation();
+               num_samples++;
+            }
+            block_m/=double(num_samples);
+
+            if(last_block_m>=0.0 && fabs(block_m-last_block_m)<sim::equilibration_tolerance && sim::time<end_time){
+               zlog << zTs() << "Equilibration converged after " << sim::time-start_time << " of " << n_steps << " time steps at T = "
+                    << sim::temperature << " K (m = " << block_m << ", drift = " << fabs(block_m-last_block_m) << ")" << std::endl;
+               sim::time=end_time;
+               break;
+            }
+
+            last_block_m=block_m;
+
+         }
+
+      }
+
+      // Restore production integrator and reinitialise LLG arrays
+      if(switch_integrator){
+         sim::integrator=production_integrator;
+         internal::reset_llg_arrays();
+      }
+
+      return;
+
+   }
+
+} // end of namespace sim
@@ -39,6 +39,8 @@
 #include "random.hpp"
 #include "sim.hpp"
 #include "stats.hpp"
+#include "vio.hpp"
+#include "vmath.hpp"
 #include "vmpi.hpp"
 
 #include <algorithm>
@@ -50,11 +52,14 @@
 //========================
 
 int calculate_exchange_fields(const int,const int);
+bool interleaved_spins_required();
+void pack_interleaved_spins(const int,const int);
 int calculate_anisotropy_fields(const int,const int);
 void calculate_second_order_uniaxial_anisotropy_fields(const int,const int);
 void calculate_sixth_order_uniaxial_anisotropy_fields(const int,const int);
 void calculate_spherical_harmonic_fields(const int,const int);
 void calculate_lattice_anisotropy_fields(const int, const int);
+void calculate_fused_uniaxial_anisotropy_fields(const int, const int);
 int calculate_cubic_anisotropy_fields(const int,const int);
 int calculate_applied_fields(const int,const int);
 int calculate_thermal_fields(const int,const int);
@@ -83,11 +88,18 @@ int calculate_spin_fields(const int start_index,const int end_index){
 	if(sim::hamiltonian_simulation_flags[0]==1) calculate_exchange_fields(start_index,end_index);
 	
 	// Anisotropy Fields
-	if(sim::UniaxialScalarAnisotropy || sim::TensorAnisotropy) calculate_anisotropy_fields(start_index,end_index);
-   if(sim::second_order_uniaxial_anisotropy) calculate_second_order_uniaxial_anisotropy_fields(start_index,end_index);
-   if(sim::sixth_order_uniaxial_anisotropy) calculate_sixth_order_uniaxial_anisotropy_fields(start_index,end_index);
-   if(sim::spherical_harmonics) calculate_spherical_harmonic_fields(start_index,end_index);
-   if(sim::lattice_anisotropy_flag) calculate_lattice_anisotropy_fields(start_index,end_index);
+	if(sim::fused_uniaxial_anisotropy){
+		// evaluate all uniaxial terms in a single pass
+		calculate_fused_uniaxial_anisotropy_fields(start_index,end_index);
+		if((sim::UniaxialScalarAnisotropy || sim::TensorAnisotropy) && !sim::fused_first_order_anisotropy) calculate_anisotropy_fields(start_index,end_index);
+	}
+	else{
+		if(sim::UniaxialScalarAnisotropy || sim::TensorAnisotropy) calculate_anisotropy_fields(start_index,end_index);
+		if(sim::second_order_uniaxial_anisotropy) calculate_second_order_uniaxial_anisotropy_fields(start_index,end_index);
+		if(sim::sixth_order_uniaxial_anisotropy) calculate_sixth_order_uniaxial_anisotropy_fields(start_index,end_index);
+		if(sim::spherical_harmonics) calculate_spherical_harmonic_fields(start_index,end_index);
+		if(sim::lattice_anisotropy_flag) calculate_lattice_anisotropy_fields(start_index,end_index);
+	}
    if(sim::CubicScalarAnisotropy) calculate_cubic_anisotropy_fields(start_index,end_index);
 	//if(sim::hamiltonian_simulation_flags[1]==3) calculate_local_anis_fields();
 	if(sim::surface_anisotropy==true) calculate_surface_anisotropy_fields(start_index,end_index);
@@ -146,6 +158,58 @@ int calculate_external_fields(const int start_index,const int end_index){
 	return 0;
 }
 
+//------------------------------------------------------------------------------
+///  Function to determine if the exchange calculation reads spins from the
+///  interleaved spin array
+//------------------------------------------------------------------------------
+bool interleaved_spins_required(){
+	return sim::interleaved_spin_layout || (sim::interaction_rescaling && !sim::uniform_exchange_rescaling);
+}
+
+//------------------------------------------------------------------------------
+///  Function to copy spins into the interleaved (x,y,z,w) spin array so that
+///  each neighbour access in the exchange calculation touches a single cache
+///  line. The w component is unused padding to give 32 bytes per atom.
+///
+///  For temperature rescaled exchange between materials with different
+///  scaling factors the spins are packed as r_j S_j (see
+///  interaction_rescaling.cpp).
+///
+///  Only atoms in the range start_atom to end_atom are packed. The array is
+///  only used (and packed) for the interleaved layout or mixed exchange
+///  rescaling, and must be packed by the caller whenever spins change before
+///  calculate_spin_fields is called. In parallel, local atoms are packed
+///  before the core fields and halo atoms after the halo swap is complete.
+//------------------------------------------------------------------------------
+void pack_interleaved_spins(const int start_atom, const int end_atom){
+
+	if(!interleaved_spins_required()) return;
+
+	const int num_atoms = atoms::num_atoms;
+	if(atoms::interleaved_spin_array.size() != 4*static_cast<unsigned int>(num_atoms)) atoms::interleaved_spin_array.resize(4*num_atoms,0.0);
+
+	double* s = &atoms::interleaved_spin_array[0];
+
+	if(sim::interaction_rescaling && !sim::uniform_exchange_rescaling){
+		for(int atom=start_atom; atom<end_atom; atom++){
+			const double r = sim::exchange_rescaling_root[atoms::type_array[atom]];
+			s[4*atom+0] = r*atoms::x_spin_array[atom];
+			s[4*atom+1] = r*atoms::y_spin_array[atom];
+			s[4*atom+2] = r*atoms::z_spin_array[atom];
+		}
+		return;
+	}
+
+	for(int atom=start_atom; atom<end_atom; atom++){
+		s[4*atom+0] = atoms::x_spin_array[atom];
+		s[4*atom+1] = atoms::y_spin_array[atom];
+		s[4*atom+2] = atoms::z_spin_array[atom];
+	}
+
+	return;
+
+}
+
 int calculate_exchange_fields(const int start_index,const int end_index){
 	///======================================================
 	/// 		Subroutine to calculate exchange fields
@@ -156,6 +220,31 @@ int calculate_exchange_fields(const int start_index,const int end_index){
 	// check calling of routine if error checking is activated
 	if(err::check==true){std::cout << "calculate_exchange_fields has been called" << std::endl;}
 
+	// Determine spin storage layout. Spin components of atom i are read from
+	// sx[stride*i], sy[stride*i] and sz[stride*i] so that the same kernels
+	// work with separate (x,y,z) arrays or interleaved (xyzw) atomic data.
+	const double* sx = &atoms::x_spin_array[0];
+	const double* sy = &atoms::y_spin_array[0];
+	const double* sz = &atoms::z_spin_array[0];
+	int stride = 1;
+
+	// Temperature rescaled exchange H_i = r_i sum_j J_ij r_j S_j. Rescaled
+	// spins r_j S_j are read from the interleaved array for mixed materials
+	// and the field is multiplied by r_i (or r_i^2 for uniform rescaling).
+	const double* rescale = NULL;
+	if(sim::interaction_rescaling){
+		if(sim::uniform_exchange_rescaling) rescale = &sim::exchange_rescaling[0];
+		else rescale = &sim::exchange_rescaling_root[0];
+	}
+
+	// spins are packed by the integrator before the field calculation
+	if(interleaved_spins_required()){
+		sx = &atoms::interleaved_spin_array[0];
+		sy = sx+1;
+		sz = sx+2;
+		stride = 4;
+	}
+
 	// Use appropriate function for exchange calculation
 	switch(atoms::exchange_type){
 		case 0: // isotropic
@@ -168,9 +257,15 @@ int calculate_exchange_fields(const int start_index,const int end_index){
 				for(int nn=start;nn<end;nn++){
 					const int natom = atoms::neighbour_list_array[nn];
 					const double Jij=atoms::i_exchange_list[atoms::neighbour_interaction_type_array[nn]].Jij;
-					Hx -= Jij*atoms::x_spin_array[natom];
-					Hy -= Jij*atoms::y_spin_array[natom];
-					Hz -= Jij*atoms::z_spin_array[natom];
+					Hx -= Jij*sx[stride*natom];
+					Hy -= Jij*sy[stride*natom];
+					Hz -= Jij*sz[stride*natom];
+				}
+				if(rescale!=NULL){
+					const double r = rescale[atoms::type_array[atom]];
+					Hx *= r;
+					Hy *= r;
+					Hz *= r;
 				}
 				atoms::x_total_spin_field_array[atom] += Hx;
 				atoms::y_total_spin_field_array[atom] += Hy;
@@ -191,9 +286,15 @@ int calculate_exchange_fields(const int start_index,const int end_index){
 												atoms::v_exchange_list[iid].Jij[1],
 												atoms::v_exchange_list[iid].Jij[2]};
 					
-					Hx -= Jij[0]*atoms::x_spin_array[natom];
-					Hy -= Jij[1]*atoms::y_spin_array[natom];
-					Hz -= Jij[2]*atoms::z_spin_array[natom];
+					Hx -= Jij[0]*sx[stride*natom];
+					Hy -= Jij[1]*sy[stride*natom];
+					Hz -= Jij[2]*sz[stride*natom];
+				}
+				if(rescale!=NULL){
+					const double r = rescale[atoms::type_array[atom]];
+					Hx *= r;
+					Hy *= r;
+					Hz *= r;
 				}
 				atoms::x_total_spin_field_array[atom] += Hx;
 				atoms::y_total_spin_field_array[atom] += Hy;
@@ -222,12 +323,18 @@ int calculate_exchange_fields(const int start_index,const int end_index){
 													atoms::t_exchange_list[iid].Jij[2][1],
 													atoms::t_exchange_list[iid].Jij[2][2]};
 					
-					const double S[3]={atoms::x_spin_array[natom],atoms::y_spin_array[natom],atoms::z_spin_array[natom]};
+					const double S[3]={sx[stride*natom],sy[stride*natom],sz[stride*natom]};
 					
 					Hx -= (Jij[0][0]*S[0] + Jij[0][1]*S[1] +Jij[0][2]*S[2]);
 					Hy -= (Jij[1][0]*S[0] + Jij[1][1]*S[1] +Jij[1][2]*S[2]);
 					Hz -= (Jij[2][0]*S[0] + Jij[2][1]*S[1] +Jij[2][2]*S[2]);
 				}
+				if(rescale!=NULL){
+					const double r = rescale[atoms::type_array[atom]];
+					Hx *= r;
+					Hy *= r;
+					Hz *= r;
+				}
 				atoms::x_total_spin_field_array[atom] += Hx;
 				atoms::y_total_spin_field_array[atom] += Hy;
 				atoms::z_total_spin_field_array[atom] += Hz;
@@ -253,24 +360,26 @@ int calculate_anisotropy_fields(const int start_index,const int end_index){
 		case 0: // scalar
 			for(int atom=start_index;atom<end_index;atom++){
 				const int imaterial=atoms::type_array[atom];
-				atoms::z_total_spin_field_array[atom] -= 2.0*mp::MaterialScalarAnisotropyArray[imaterial].K*atoms::z_spin_array[atom];
+				const double K=2.0*mp::MaterialScalarAnisotropyArray[imaterial].K*sim::anisotropy_rescaling[imaterial];
+				atoms::z_total_spin_field_array[atom] -= K*atoms::z_spin_array[atom];
 			}
 			break;
 		case 1: // tensor
 			for(int atom=start_index;atom<end_index;atom++){
 				const int imaterial=atoms::type_array[atom];
+				const double k=2.0*sim::anisotropy_rescaling[imaterial];
 
-				const double K[3][3]={2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[0][0],
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[0][1],
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[0][2],
+				const double K[3][3]={k*mp::MaterialTensorAnisotropyArray[imaterial].K[0][0],
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[0][1],
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[0][2],
 
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[1][0],
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[1][1],
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[1][2],
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[1][0],
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[1][1],
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[1][2],
 
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[2][0],
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[2][1],
-												2.0*mp::MaterialTensorAnisotropyArray[imaterial].K[2][2]};
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[2][0],
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[2][1],
+												k*mp::MaterialTensorAnisotropyArray[imaterial].K[2][2]};
 					
 				const double S[3]={atoms::x_spin_array[atom],atoms::y_spin_array[atom],atoms::z_spin_array[atom]};
 
@@ -279,6 +388,19 @@ int calculate_anisotropy_fields(const int start_index,const int end_index){
 				atoms::z_total_spin_field_array[atom] -= (K[2][0]*S[0] + K[2][1]*S[1] +K[2][2]*S[2]);
 			}
 			break;
+		case 3: // local easy axis
+			for(int atom=start_index;atom<end_index;atom++){
+				const int imaterial=atoms::type_array[atom];
+				const double K=2.0*mp::MaterialScalarAnisotropyArray[imaterial].K*sim::anisotropy_rescaling[imaterial];
+				double ex, ey, ez;
+				vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
+				const double Sdote = atoms::x_spin_array[atom]*ex + atoms::y_spin_array[atom]*ey + atoms::z_spin_array[atom]*ez;
+
+				atoms::x_total_spin_field_array[atom] -= K*ex*Sdote;
+				atoms::y_total_spin_field_array[atom] -= K*ey*Sdote;
+				atoms::z_total_spin_field_array[atom] -= K*ez*Sdote;
+			}
+			break;
    }
 	return EXIT_SUCCESS;
 }
@@ -298,13 +420,14 @@ int calculate_anisotropy_fields(const int start_index,const int end_index){
 void calculate_second_order_uniaxial_anisotropy_fields(const int start_index,const int end_index){
    for(int atom=start_index;atom<end_index;atom++){
       const int imaterial=atoms::type_array[atom];
-      const double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
-      const double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
-      const double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+      double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
+      double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
+      double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+      if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
       const double Sx = atoms::x_spin_array[atom];
       const double Sy = atoms::y_spin_array[atom];
       const double Sz = atoms::z_spin_array[atom];
-      const double Ku2 = 4.0*mp::material_second_order_anisotropy_constant_array[imaterial];
+      const double Ku2 = 4.0*mp::material_second_order_anisotropy_constant_array[imaterial]*sim::anisotropy_rescaling[imaterial];
       const double Sdote = (Sx*ex + Sy*ey + Sz*ez);
       const double Sdote3 = Sdote*Sdote*Sdote;
 
@@ -330,13 +453,14 @@ void calculate_second_order_uniaxial_anisotropy_fields(const int start_index,con
 void calculate_sixth_order_uniaxial_anisotropy_fields(const int start_index,const int end_index){
    for(int atom=start_index;atom<end_index;atom++){
       const int imaterial=atoms::type_array[atom];
-      const double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
-      const double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
-      const double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+      double ex = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(0);
+      double ey = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(1);
+      double ez = mp::material.at(imaterial).UniaxialAnisotropyUnitVector.at(2);
+      if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
       const double Sx = atoms::x_spin_array[atom];
       const double Sy = atoms::y_spin_array[atom];
       const double Sz = atoms::z_spin_array[atom];
-      const double Ku3 = 6.0*mp::material_sixth_order_anisotropy_constant_array[imaterial];
+      const double Ku3 = 6.0*mp::material_sixth_order_anisotropy_constant_array[imaterial]*sim::anisotropy_rescaling[imaterial];
       const double Sdote = (Sx*ex + Sy*ey + Sz*ez);
       const double Sdote5 = Sdote*Sdote*Sdote*Sdote*Sdote;
 
@@ -387,14 +511,16 @@ void calculate_spherical_harmonic_fields(const int start_index,const int end_ind
       const int imaterial=atoms::type_array[atom];
 
       // determine harmonic constants for material
-      const double k2 = mp::material_spherical_harmonic_constants_array[3*imaterial + 0];
-      const double k4 = mp::material_spherical_harmonic_constants_array[3*imaterial + 1];
-      const double k6 = mp::material_spherical_harmonic_constants_array[3*imaterial + 2];
+      const double kr = sim::anisotropy_rescaling[imaterial];
+      const double k2 = kr*mp::material_spherical_harmonic_constants_array[3*imaterial + 0];
+      const double k4 = kr*mp::material_spherical_harmonic_constants_array[3*imaterial + 1];
+      const double k6 = kr*mp::material_spherical_harmonic_constants_array[3*imaterial + 2];
 
       // determine anisotropy direction and dot product
-      const double ex = mp::material[imaterial].UniaxialAnisotropyUnitVector[0];
-      const double ey = mp::material[imaterial].UniaxialAnisotropyUnitVector[1];
-      const double ez = mp::material[imaterial].UniaxialAnisotropyUnitVector[2];
+      double ex = mp::material[imaterial].UniaxialAnisotropyUnitVector[0];
+      double ey = mp::material[imaterial].UniaxialAnisotropyUnitVector[1];
+      double ez = mp::material[imaterial].UniaxialAnisotropyUnitVector[2];
+      if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
       const double sx = atoms::x_spin_array[atom];
       const double sy = atoms::y_spin_array[atom];
       const double sz = atoms::z_spin_array[atom];
@@ -446,11 +572,170 @@ void calculate_lattice_anisotropy_fields(const int start_index,const int end_ind
       const double Sx = atoms::x_spin_array[atom];
       const double Sy = atoms::y_spin_array[atom];
       const double Sz = atoms::z_spin_array[atom];
-      const double Sdote = (Sx*ex[imaterial] + Sy*ey[imaterial] + Sz*ez[imaterial]);
+      double eix = ex[imaterial];
+      double eiy = ey[imaterial];
+      double eiz = ez[imaterial];
+      if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], eix, eiy, eiz);
+      const double Sdote = (Sx*eix + Sy*eiy + Sz*eiz);
 
-      atoms::x_total_spin_field_array[atom] -= klatt_array[imaterial]*ex[imaterial]*Sdote;
-      atoms::y_total_spin_field_array[atom] -= klatt_array[imaterial]*ey[imaterial]*Sdote;
-      atoms::z_total_spin_field_array[atom] -= klatt_array[imaterial]*ez[imaterial]*Sdote;
+      atoms::x_total_spin_field_array[atom] -= klatt_array[imaterial]*eix*Sdote;
+      atoms::y_total_spin_field_array[atom] -= klatt_array[imaterial]*eiy*Sdote;
+      atoms::z_total_spin_field_array[atom] -= klatt_array[imaterial]*eiz*Sdote;
+
+   }
+
+   return;
+
+}
+
+namespace sim{
+
+   bool fused_uniaxial_anisotropy=false; // Evaluate all uniaxial anisotropy terms in a single pass
+   bool fused_first_order_anisotropy=false; // Include first order anisotropy in the single pass
+   std::vector<double> fused_uniaxial_anisotropy_coefficients(0); // c1, c3, c5 and easy axis per material
+
+   namespace internal{
+      // temperature independent c1, c3 and c5 per material
+      std::vector<double> fused_uniaxial_anisotropy_constants(0);
+   }
+
+   //---------------------------------------------------------------------------------
+   ///  Function to decide if the uniaxial anisotropy terms should be fused into a
+   ///  single pass and to set the temperature independent polynomial coefficients.
+   ///  Fusion is used whenever more than one term is active (or for spherical
+   ///  harmonics, which are then evaluated once per atom). The first order term can
+   ///  only be fused when it is uniaxial, ie not given as an explicit anisotropy
+   ///  tensor. Must be called after material parameters and interaction rescaling
+   ///  are set.
+   //---------------------------------------------------------------------------------
+   void initialise_fused_uniaxial_anisotropy(){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "sim::initialise_fused_uniaxial_anisotropy has been called" << std::endl;
+
+      sim::fused_first_order_anisotropy = (sim::AnisotropyType==0 || sim::AnisotropyType==3);
+      if(sim::AnisotropyType==1){
+         sim::fused_first_order_anisotropy=true;
+         for(int imat=0; imat<mp::num_materials; imat++) if(mp::material[imat].KuVec_SI.size()!=0) sim::fused_first_order_anisotropy=false;
+      }
+
+      int num_terms=0;
+      if(sim::fused_first_order_anisotropy) num_terms++;
+      if(sim::second_order_uniaxial_anisotropy) num_terms++;
+      if(sim::sixth_order_uniaxial_anisotropy) num_terms++;
+      if(sim::spherical_harmonics) num_terms+=2;
+      if(sim::lattice_anisotropy_flag) num_terms++;
+
+      sim::fused_uniaxial_anisotropy = (num_terms>1);
+      if(!sim::fused_uniaxial_anisotropy) return;
+
+      zlog << zTs() << "Uniaxial anisotropy terms evaluated in a single pass" << std::endl;
+
+      // spherical harmonic rescaling prefactor (see calculate_spherical_harmonic_fields)
+      const double scale = 2.0/3.0;
+
+      internal::fused_uniaxial_anisotropy_constants.assign(3*mp::num_materials,0.0);
+      sim::fused_uniaxial_anisotropy_coefficients.assign(6*mp::num_materials,0.0);
+
+      for(int imat=0; imat<mp::num_materials; imat++){
+
+         double c1=0.0;
+         double c3=0.0;
+         double c5=0.0;
+
+         if(sim::fused_first_order_anisotropy) c1 += 2.0*mp::material[imat].Ku;
+         if(sim::second_order_uniaxial_anisotropy) c3 += 4.0*mp::material_second_order_anisotropy_constant_array[imat];
+         if(sim::sixth_order_uniaxial_anisotropy) c5 += 6.0*mp::material_sixth_order_anisotropy_constant_array[imat];
+         if(sim::spherical_harmonics){
+            const double k2 = mp::material_spherical_harmonic_constants_array[3*imat + 0];
+            const double k4 = mp::material_spherical_harmonic_constants_array[3*imat + 1];
+            const double k6 = mp::material_spherical_harmonic_constants_array[3*imat + 2];
+            c1 -= scale*(3.0*k2 - 7.5*k4 + 13.125*k6);
+            c3 -= scale*(17.5*k4 - 78.75*k6);
+            c5 -= scale*86.625*k6;
+         }
+
+         internal::fused_uniaxial_anisotropy_constants[3*imat+0] = c1;
+         internal::fused_uniaxial_anisotropy_constants[3*imat+1] = c3;
+         internal::fused_uniaxial_anisotropy_constants[3*imat+2] = c5;
+
+         sim::fused_uniaxial_anisotropy_coefficients[6*imat+3] = mp::material[imat].UniaxialAnisotropyUnitVector[0];
+         sim::fused_uniaxial_anisotropy_coefficients[6*imat+4] = mp::material[imat].UniaxialAnisotropyUnitVector[1];
+         sim::fused_uniaxial_anisotropy_coefficients[6*imat+5] = mp::material[imat].UniaxialAnisotropyUnitVector[2];
+
+      }
+
+      update_fused_uniaxial_anisotropy();
+
+      return;
+
+   }
+
+   //---------------------------------------------------------------------------------
+   ///  Function to update fused uniaxial anisotropy coefficients for the current
+   ///  temperature rescaling and lattice anisotropy
+   //---------------------------------------------------------------------------------
+   void update_fused_uniaxial_anisotropy(){
+
+      if(!sim::fused_uniaxial_anisotropy) return;
+
+      for(int imat=0; imat<mp::num_materials; imat++){
+
+         // temperature rescaled anisotropy (lattice anisotropy has its own temperature dependence)
+         double c1 = internal::fused_uniaxial_anisotropy_constants[3*imat+0]*sim::anisotropy_rescaling[imat];
+         if(sim::lattice_anisotropy_flag) c1 += 2.0*mp::material[imat].Klatt*mp::material[imat].lattice_anisotropy.get_lattice_anisotropy_constant(sim::temperature);
+
+         sim::fused_uniaxial_anisotropy_coefficients[6*imat+0] = c1;
+         sim::fused_uniaxial_anisotropy_coefficients[6*imat+1] = internal::fused_uniaxial_anisotropy_constants[3*imat+1]*sim::anisotropy_rescaling[imat];
+         sim::fused_uniaxial_anisotropy_coefficients[6*imat+2] = internal::fused_uniaxial_anisotropy_constants[3*imat+2]*sim::anisotropy_rescaling[imat];
+
+      }
+
+      return;
+
+   }
+
+} // end of namespace sim
+
+//------------------------------------------------------------------------------------
+///  Function to calculate all uniaxial anisotropy fields in a single pass
+///
+///  All uniaxial terms (first, second and sixth order, spherical harmonics and lattice
+///  anisotropy) share the easy axis e and so the total field is a single odd
+///  polynomial in (S . e)
+///
+///  H = -(c1 (S . e) + c3 (S . e)^3 + c5 (S . e)^5) e
+///
+///  The coefficients per material are set at initialisation and updated for the
+///  current temperature once per call to sim::integrate, so that spins and fields
+///  are only streamed once.
+///
+//------------------------------------------------------------------------------------
+void calculate_fused_uniaxial_anisotropy_fields(const int start_index, const int end_index){
+
+   const std::vector<double>& coefficients = sim::fused_uniaxial_anisotropy_coefficients;
+
+   for(int atom=start_index; atom<end_index; atom++){
+
+      const int imaterial=atoms::type_array[atom];
+      const double c1 = coefficients[6*imaterial+0];
+      const double c3 = coefficients[6*imaterial+1];
+      const double c5 = coefficients[6*imaterial+2];
+
+      double ex = coefficients[6*imaterial+3];
+      double ey = coefficients[6*imaterial+4];
+      double ez = coefficients[6*imaterial+5];
+      if(sim::local_anisotropy_axis) vmath::decode_unit_vector(atoms::uniaxial_anisotropy_axis_array[atom], ex, ey, ez);
+
+      const double Sdote = atoms::x_spin_array[atom]*ex + atoms::y_spin_array[atom]*ey + atoms::z_spin_array[atom]*ez;
+      const double Sdote2 = Sdote*Sdote;
+
+      // Horner evaluation of the field polynomial
+      const double H = Sdote*(c1 + Sdote2*(c3 + Sdote2*c5));
+
+      atoms::x_total_spin_field_array[atom] -= H*ex;
+      atoms::y_total_spin_field_array[atom] -= H*ey;
+      atoms::z_total_spin_field_array[atom] -= H*ez;
 
    }
 
@@ -473,7 +758,7 @@ int calculate_cubic_anisotropy_fields(const int start_index,const int end_index)
 	//std::cout << "here" << std::endl;
 	for(int atom=start_index;atom<end_index;atom++){
 		const int imaterial=atoms::type_array[atom];
-		const double Kc=2.0*mp::MaterialCubicAnisotropyArray[imaterial];
+		const double Kc=2.0*mp::MaterialCubicAnisotropyArray[imaterial]*sim::anisotropy_rescaling[imaterial];
 
 		const double Sx=atoms::x_spin_array[atom];
 		atoms::x_total_spin_field_array[atom] -= Kc*Sx*Sx*Sx;
@@ -619,6 +904,26 @@ int calculate_thermal_fields(const int start_index,const int end_index){
       sigma_prefactor.push_back(sqrt_T*mp::material[mat].H_th_sigma);
    }
 
+   // Use precomputed noise for this time step if available
+   if(sim::buffered_thermal_noise){
+
+      const std::vector<double>& noise = sim::get_thermal_noise();
+      const int num_noise_atoms = noise.size()/3;
+
+      for(int atom=start_index;atom<end_index;atom++){
+
+         const int imaterial=atoms::type_array[atom];
+         const double H_th_sigma = sigma_prefactor[imaterial];
+
+         atoms::x_total_external_field_array[atom] = H_th_sigma*noise[atom];
+         atoms::y_total_external_field_array[atom] = H_th_sigma*noise[num_noise_atoms+atom];
+         atoms::z_total_external_field_array[atom] = H_th_sigma*noise[2*num_noise_atoms+atom];
+      }
+
+      return EXIT_SUCCESS;
+
+   }
+
  	generate (atoms::x_total_external_field_array.begin()+start_index,atoms::x_total_external_field_array.begin()+end_index, mtrandom::gaussian);
 	generate (atoms::y_total_external_field_array.begin()+start_index,atoms::y_total_external_field_array.begin()+end_index, mtrandom::gaussian);
 	generate (atoms::z_total_external_field_array.begin()+start_index,atoms::z_total_external_field_array.begin()+end_index, mtrandom::gaussian);
@@ -0,0 +1,209 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Graceful checkpoint and exit for jobs with a limited wall time.
+//
+//   A termination request (SIGTERM or SIGUSR1, as sent by most batch
+//   schedulers before the wall time limit) or reaching the user defined
+//   sim:walltime sets a flag which is checked at the start of every call to
+//   sim::integrate and every exit_check_step_interval time steps within it.
+//   All processors agree on the flag with a single reduction, then write a
+//   checkpoint, flush output files and exit. Programs which run until a
+//   fixed value of sim::time (benchmark and time series) exit with the
+//   resumable status code sim::resumable_exit_code and can be continued
+//   with sim:load-checkpoint=continue. Other programs restart their loops
+//   when the checkpoint is loaded, and so exit with EXIT_FAILURE.
+//
+//   Signals received before the simulation starts terminate the program
+//   as normal since there is nothing to save.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <csignal>
+#include <cstdlib>
+#include <iostream>
+
+// Vampire Header files
+#include "errors.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace sim{
+
+   double walltime=0.0; // Wall time limit for simulation (s), 0 = no limit
+   const int resumable_exit_code=75; // Exit code for resumable termination (EX_TEMPFAIL)
+
+   namespace internal{
+
+      volatile sig_atomic_t exit_signal_received=0; // flag set by signal handler
+      volatile sig_atomic_t graceful_exit_active=0; // flag set when simulation is running
+
+      double program_start_time=0.0; // wall time at start of program
+      double last_exit_check_time=0.0; // wall time at last check
+      double max_exit_check_interval=0.0; // maximum time between checks
+
+      const int exit_check_step_interval=100; // time steps between checks within sim::integrate
+      int steps_since_exit_check=0; // time steps since last check
+
+      //-----------------------------------------------------------------------
+      // Signal handler to request graceful exit
+      //-----------------------------------------------------------------------
+      extern "C" void graceful_exit_signal_handler(int signal_number){
+
+         // terminate as normal if simulation has not started
+         if(!graceful_exit_active){
+            std::signal(signal_number, SIG_DFL);
+            std::raise(signal_number);
+            return;
+         }
+
+         exit_signal_received=1;
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine if wall time limit will be reached before next
+      // check, allowing time to write checkpoint files
+      //-----------------------------------------------------------------------
+      bool walltime_reached(const double current_time){
+
+         if(sim::walltime<=0.0) return false;
+
+         // reserve 5% of wall time (maximum of 60 seconds) for writing checkpoint
+         double reserve=0.05*sim::walltime;
+         if(reserve>60.0) reserve=60.0;
+
+         const double elapsed=current_time-program_start_time;
+
+         return (elapsed + 2.0*max_exit_check_interval + reserve >= sim::walltime);
+
+      }
+
+      //-----------------------------------------------------------------------
+      // Function to determine if program can be continued from a checkpoint
+      //-----------------------------------------------------------------------
+      bool program_is_resumable(){
+
+         // only benchmark and time series run until a fixed sim::time
+         return (sim::program==0 || sim::program==1);
+
+      }
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to install signal handlers and start wall time clock
+   //--------------------------------------------------------------------------
+   void initialise_graceful_exit(){
+
+      internal::program_start_time=sim::wall_time();
+      internal::last_exit_check_time=internal::program_start_time;
+
+      std::signal(SIGTERM, internal::graceful_exit_signal_handler);
+      #ifndef WIN_COMPILE
+         std::signal(SIGUSR1, internal::graceful_exit_signal_handler);
+      #endif
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to enable graceful exit once the simulation has started
+   //--------------------------------------------------------------------------
+   void enable_graceful_exit(){
+
+      internal::graceful_exit_active=1;
+      internal::last_exit_check_time=sim::wall_time();
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to check for a graceful exit request. Must be called by all
+   // processors at the same time step.
+   //--------------------------------------------------------------------------
+   void check_graceful_exit(){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "sim::check_graceful_exit has been called" << std::endl;
+
+      // update time between checks
+      const double current_time=sim::wall_time();
+      const double interval=current_time-internal::last_exit_check_time;
+      if(interval>internal::max_exit_check_interval) internal::max_exit_check_interval=interval;
+      internal::last_exit_check_time=current_time;
+      internal::steps_since_exit_check=0;
+
+      // determine local exit request (wall time is determined by root process)
+      int exit_request=0;
+      if(internal::exit_signal_received) exit_request=1;
+      if(vmpi::my_rank==0 && internal::walltime_reached(current_time)) exit_request=2;
+
+      // agree on exit request on all processors
+      #ifdef MPICF
+         MPI_Allreduce(MPI_IN_PLACE, &exit_request, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+      #endif
+
+      if(exit_request==0) return;
+
+      // inform user
+      std::string reason = exit_request==2 ? "wall time limit reached" : "termination signal received";
+      zlog << zTs() << "Graceful exit requested (" << reason << ") at time step " << sim::time << ". Saving checkpoint." << std::endl;
+      std::cout << "Graceful exit requested (" << reason << ") at time step " << sim::time << ". Saving checkpoint." << std::endl;
+
+      // save checkpoint and flush output files
+      save_checkpoint();
+      if(zmag.is_open()) zmag.flush();
+      if(zgrain.is_open()) zgrain.flush();
+
+      int exit_code=sim::resumable_exit_code;
+      if(internal::program_is_resumable()){
+         zlog << zTs() << "Simulation may be continued with sim:load-checkpoint=continue. Exiting with code " << exit_code << "." << std::endl;
+         std::cout << "Simulation may be continued with sim:load-checkpoint=continue. Exiting with code " << exit_code << "." << std::endl;
+      }
+      else{
+         exit_code=EXIT_FAILURE;
+         zlog << zTs() << "Program cannot be continued from checkpoint. Exiting with code " << exit_code << "." << std::endl;
+         std::cout << "Program cannot be continued from checkpoint. Exiting with code " << exit_code << "." << std::endl;
+      }
+
+      // finalise MPI
+      #ifdef MPICF
+         vmpi::finalise();
+         // concatenate log and sort
+         #ifdef WIN_COMPILE
+            if(vmpi::num_processors!=1 && vmpi::my_rank==0) system("type log.* 2>NUL | sort > log");
+         #else
+            if(vmpi::num_processors!=1 && vmpi::my_rank==0) system("ls log.* | xargs cat | sort -n > log");
+         #endif
+      #endif
+
+      zlog.flush();
+
+      exit(exit_code);
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to check for a graceful exit request every
+   // exit_check_step_interval time steps. Must be called by all processors
+   // after every time step.
+   //--------------------------------------------------------------------------
+   void poll_graceful_exit(){
+
+      internal::steps_since_exit_check++;
+      if(internal::steps_since_exit_check>=internal::exit_check_step_interval) check_graceful_exit();
+
+      return;
+
+   }
+
+} // end of namespace sim
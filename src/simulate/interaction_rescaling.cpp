@@ -0,0 +1,131 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Temperature rescaled exchange and anisotropy interactions.
+//
+//   The exchange and anisotropy constants of each material are scaled at
+//   runtime by powers of a fitted reduced magnetisation
+//
+//      m(T) = (1 - (T/Tc)^a)^b              (T < Tc, 0 otherwise)
+//
+//      J_ij(T) = J_ij(0) [m_i(T) m_j(T)]^(alpha_J/2)
+//      K(T)    = K(0) m(T)^alpha_K
+//
+//   so that temperature sweeps can use rescaled interactions without
+//   regenerating input files or rebuilding the exchange lists. The exchange
+//   field is evaluated as H_i = r_i sum_j J_ij r_j S_j with r = m^(alpha_J/2),
+//   which reduces to a single multiplication per atom when all materials
+//   have the same scaling factor.
+//
+//   The scaling factors are updated from the current (or material)
+//   temperature at the start of every call to sim::integrate.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "errors.hpp"
+#include "material.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+
+namespace sim{
+
+   bool interaction_rescaling=false; // Enable temperature rescaled exchange and anisotropy
+   bool uniform_exchange_rescaling=true; // Flag if all materials have the same exchange scaling
+   std::vector<double> exchange_rescaling(0); // Exchange scaling factor per material
+   std::vector<double> exchange_rescaling_root(0); // Square root of exchange scaling factor per material
+   std::vector<double> anisotropy_rescaling(0); // Anisotropy scaling factor per material
+
+   namespace internal{
+
+      //-----------------------------------------------------------------------
+      // Function to calculate reduced magnetisation from fitted m(T) curve
+      //-----------------------------------------------------------------------
+      double rescaling_magnetisation(const int mat, const double temperature){
+
+         const double Tc=mp::material[mat].interaction_rescaling_Tc;
+         if(temperature>=Tc) return 0.0;
+         if(temperature<=0.0) return 1.0;
+
+         const double a=mp::material[mat].interaction_rescaling_temperature_exponent;
+         const double b=mp::material[mat].interaction_rescaling_critical_exponent;
+
+         return pow(1.0-pow(temperature/Tc,a),b);
+
+      }
+
+   } // end of internal namespace
+
+   //--------------------------------------------------------------------------
+   // Function to initialise interaction rescaling arrays. Must be called
+   // after material parameters are set.
+   //--------------------------------------------------------------------------
+   void initialise_interaction_rescaling(){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "sim::initialise_interaction_rescaling has been called" << std::endl;
+
+      sim::exchange_rescaling.assign(mp::num_materials,1.0);
+      sim::exchange_rescaling_root.assign(mp::num_materials,1.0);
+      sim::anisotropy_rescaling.assign(mp::num_materials,1.0);
+      sim::uniform_exchange_rescaling=true;
+
+      sim::interaction_rescaling=false;
+      for(int mat=0;mat<mp::num_materials;mat++){
+         if(mp::material[mat].interaction_rescaling_Tc>0.0){
+            sim::interaction_rescaling=true;
+            zlog << zTs() << "Temperature rescaled interactions enabled for material " << mat+1 << " with Tc = "
+                 << mp::material[mat].interaction_rescaling_Tc << " K, exchange exponent "
+                 << mp::material[mat].exchange_rescaling_exponent << " and anisotropy exponent "
+                 << mp::material[mat].anisotropy_rescaling_exponent << std::endl;
+         }
+      }
+
+      update_interaction_rescaling();
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to update interaction scaling factors for current temperature
+   //--------------------------------------------------------------------------
+   void update_interaction_rescaling(){
+
+      if(!sim::interaction_rescaling) return;
+
+      for(int mat=0;mat<mp::num_materials;mat++){
+
+         // materials without fitted m(T) curve are not rescaled
+         if(mp::material[mat].interaction_rescaling_Tc<=0.0) continue;
+
+         double temperature=sim::temperature;
+         if(sim::local_temperature) temperature=mp::material[mat].temperature;
+
+         const double m=internal::rescaling_magnetisation(mat,temperature);
+
+         sim::exchange_rescaling[mat]=pow(m,mp::material[mat].exchange_rescaling_exponent);
+         sim::exchange_rescaling_root[mat]=sqrt(sim::exchange_rescaling[mat]);
+         sim::anisotropy_rescaling[mat]=pow(m,mp::material[mat].anisotropy_rescaling_exponent);
+
+      }
+
+      sim::uniform_exchange_rescaling=true;
+      for(int mat=1;mat<mp::num_materials;mat++){
+         if(sim::exchange_rescaling[mat]!=sim::exchange_rescaling[0]) sim::uniform_exchange_rescaling=false;
+      }
+
+      return;
+
+   }
+
+} // end of namespace sim
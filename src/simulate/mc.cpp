@@ -50,22 +50,137 @@
 #include <cmath>
 #include <cstdlib>
 #include <iostream>
+#include <vector>
 
 // Vampire Header files
 #include "atoms.hpp"
+#include "cells.hpp"
+#include "create.hpp"
 #include "errors.hpp"
 #include "material.hpp"
 #include "random.hpp"
 #include "sim.hpp"
+#include "vio.hpp"
 
 namespace sim{
-	
+
+namespace internal{
+
+   //--------------------------------------------------------------------------
+   // Blocks of spatially local atoms for cache local sweep orders. Blocks are
+   // the macrocells, with atoms of each block stored contiguously and blocks
+   // grouped by checkerboard colour (colour 0 first).
+   //--------------------------------------------------------------------------
+   std::vector<int> mc_block_atoms; // atom ids sorted by block
+   std::vector<int> mc_block_start; // start index of each block in mc_block_atoms
+   int mc_num_black_blocks=0; // number of blocks with colour 0
+   std::vector<int> mc_block_order; // order of blocks in current sweep
+   std::vector<int> mc_sweep_atoms; // order of atoms in current sweep
+
+   //--------------------------------------------------------------------------
+   // Function to sort atoms into blocks
+   //--------------------------------------------------------------------------
+   void initialise_mc_blocks(){
+
+      const int num_atoms=atoms::num_atoms;
+
+      // macrocell grid dimensions (as in cells::initialise)
+      const int ncelly = static_cast<int>(ceil((cs::system_dimensions[1]+0.01)/cells::size));
+      const int ncellz = static_cast<int>(ceil((cs::system_dimensions[2]+0.01)/cells::size));
+
+      // count atoms in each cell and colour
+      std::vector<int> count(2*cells::num_cells,0);
+      for(int atom=0;atom<num_atoms;atom++){
+         const int cell=atoms::cell_array[atom];
+         const int colour=(cell/(ncelly*ncellz)+(cell/ncellz)%ncelly+cell%ncellz)%2;
+         count[colour*cells::num_cells+cell]++;
+      }
+
+      // determine start of each non-empty block, colour 0 first
+      std::vector<int> offset(2*cells::num_cells,-1);
+      mc_block_start.resize(0);
+      mc_num_black_blocks=0;
+      int index=0;
+      for(int b=0;b<2*cells::num_cells;b++){
+         if(count[b]==0) continue;
+         offset[b]=index;
+         mc_block_start.push_back(index);
+         if(b<cells::num_cells) mc_num_black_blocks++;
+         index+=count[b];
+      }
+      mc_block_start.push_back(index);
+
+      // fill atoms preserving atom order within each block
+      mc_block_atoms.resize(num_atoms);
+      for(int atom=0;atom<num_atoms;atom++){
+         const int cell=atoms::cell_array[atom];
+         const int colour=(cell/(ncelly*ncellz)+(cell/ncellz)%ncelly+cell%ncellz)%2;
+         mc_block_atoms[offset[colour*cells::num_cells+cell]++]=atom;
+      }
+
+      const int num_blocks=mc_block_start.size()-1;
+      mc_block_order.resize(num_blocks);
+      mc_sweep_atoms.resize(num_atoms);
+
+      zlog << zTs() << "Monte Carlo sweep order uses " << num_blocks << " blocks (" << double(num_atoms)/double(num_blocks) << " atoms per block)" << std::endl;
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to randomly permute elements [first,last) of the block order
+   //--------------------------------------------------------------------------
+   void shuffle_mc_blocks(const int first, const int last){
+      for(int i=last-1;i>first;i--){
+         const int j=first+int(double(i-first+1)*mtrandom::grnd());
+         const int tmp=mc_block_order[i];
+         mc_block_order[i]=mc_block_order[j];
+         mc_block_order[j]=tmp;
+      }
+      return;
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to generate the order of atoms for one Monte Carlo step. Every
+   // atom is visited once, sequentially within blocks, with blocks taken in
+   // random order (all colour 0 blocks before colour 1 for checkerboard).
+   //--------------------------------------------------------------------------
+   void generate_mc_sweep(){
+
+      if(mc_block_atoms.size()!=static_cast<unsigned int>(atoms::num_atoms)) initialise_mc_blocks();
+
+      const int num_blocks=mc_block_order.size();
+      for(int b=0;b<num_blocks;b++) mc_block_order[b]=b;
+
+      if(sim::mc_sweep_order==checkerboard_blocks){
+         shuffle_mc_blocks(0,mc_num_black_blocks);
+         shuffle_mc_blocks(mc_num_black_blocks,num_blocks);
+      }
+      else shuffle_mc_blocks(0,num_blocks);
+
+      int index=0;
+      for(int b=0;b<num_blocks;b++){
+         const int block=mc_block_order[b];
+         for(int i=mc_block_start[block];i<mc_block_start[block+1];i++) mc_sweep_atoms[index++]=mc_block_atoms[i];
+      }
+
+      return;
+
+   }
+
+} // end of internal namespace
+
 /// @brief Monte Carlo Integrator
 ///
 /// @callgraph
 /// @callergraph
 ///
-/// @details Integrates the system using a Monte Carlo solver with tuned step width 
+/// @details Integrates the system using a Monte Carlo solver with tuned step width.
+/// Trial atoms are picked at random, or visited once per step in random order
+/// of spatially local blocks (sim:monte-carlo-sweep-order) to reduce cache misses
+/// for large systems. Every trial satisfies detailed balance, so the Boltzmann
+/// distribution is stationary for all orders.
 ///
 /// @section License
 /// Use of this code, either in source or compiled form, is subject to license from the authors.
@@ -88,6 +203,8 @@ int MonteCarlo(){
 	// Check for calling of function
 	if(err::check==true) std::cout << "sim::MonteCarlo has been called" << std::endl;
 
+	const double start_time=sim::wall_time();
+
 	// calculate number of steps to calculate
 	int nmoves = atoms::num_atoms;
 
@@ -117,6 +234,10 @@ int MonteCarlo(){
    double statistics_moves = 0.0;
    double statistics_reject = 0.0;
 
+   // Generate order of atoms for block sweeps
+   const bool block_sweep = (sim::mc_sweep_order!=random_sites);
+   if(block_sweep) internal::generate_mc_sweep();
+
 	// loop over natoms to form a single Monte Carlo step
 	for(int i=0;i<nmoves; i++){
 		
@@ -124,7 +245,8 @@ int MonteCarlo(){
       statistics_moves+=1.0;
 
 		// pick atom
-		atom = int(nmoves*mtrandom::grnd());
+		if(block_sweep) atom = internal::mc_sweep_atoms[i];
+		else atom = int(nmoves*mtrandom::grnd());
 		
 		// get material id
 		const int imaterial=atoms::type_array[atom];
@@ -174,6 +296,7 @@ int MonteCarlo(){
    // Save statistics to sim namespace variable
    sim::mc_statistics_moves += statistics_moves;
    sim::mc_statistics_reject += statistics_reject;
+   sim::mc_statistics_time += sim::wall_time()-start_time;
 
 	return EXIT_SUCCESS;
 }
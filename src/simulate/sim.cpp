@@ -42,6 +42,7 @@
 
 // Vampire Header files
 #include "atoms.hpp"
+#include "create.hpp"
 #include "program.hpp"
 #include "demag.hpp"
 #include "errors.hpp"
@@ -105,6 +106,8 @@ namespace sim{
    double lagrange_m=1.0;
    double lagrange_N=1000.0;
    bool   lagrange_multiplier=false;
+   double lagrange_local_moment[4]={0.0,0.0,0.0,0.0};
+   bool   lagrange_local_moment_set=false;
 
 	double cooling_time=100.0e-12; ///seconds
 	int cooling_function_flag=0; /// 0 = exp, 1 = gaussian
@@ -124,6 +127,7 @@ namespace sim{
   
    double mc_delta_angle=0.1; /// Tuned angle for Monte Carlo trial move
    mc_algorithms mc_algorithm=hinzke_nowak;
+   mc_sweep_orders mc_sweep_order=random_sites;
   
 	int system_simulation_flags;
 	int hamiltonian_simulation_flags[10];
@@ -145,6 +149,7 @@ namespace sim{
    bool spherical_harmonics=false; // Enables calculation of higher order anistropy with spherical harmonics
 	bool CubicScalarAnisotropy=false; /// Enables scalar cubic anisotropy
    bool lattice_anisotropy_flag=false; /// Enables lattice anisotropy
+   bool local_anisotropy_axis=false; /// Enables per-atom uniaxial anisotropy easy axes
 
 	bool local_temperature=false; /// flag to enable material specific temperature
 	bool local_applied_field=false; /// flag to enable material specific applied field
@@ -157,13 +162,46 @@ namespace sim{
    bool save_checkpoint_continuous_flag=false; // save checkpoints during simulations
    int save_checkpoint_rate=1; // Default increment between checkpoints
 
+   // Spin tile flags and variables
+   bool save_spin_tile_flag=false; // Save spin tile at end of simulation
+   bool load_spin_tile_flag=false; // Initialise spins by tiling a saved spin tile
+   bool spin_tile_random_shift=true; // Shift each tile by a random lattice translation
+   std::string spin_tile_file="spin-tile"; // Name of spin tile file
+
+   bool release_creation_arrays=false; // Release creation-only atomic arrays (coordinates, category) after initialisation
+   bool interleaved_spin_layout=false; // Use interleaved (xyzw) spin data in exchange calculation
+   bool buffered_thermal_noise=false; // Use precomputed thermal noise buffers
+
+   bool telemetry=false; // Write periodic status file
+   int telemetry_rate=10000; // Time steps between status updates
+   std::string telemetry_file="status"; // Name of status file
+
+   bool weak_scaling=false; // Scale system size with number of processors in scaling benchmark
+
+   // Forward flux sampling parameters
+   double ffs_basin_boundary=0.9; // Order parameter boundary of initial state A
+   double ffs_first_interface=0.8; // Order parameter of first interface
+   double ffs_last_interface=-0.8; // Order parameter of last interface (final state B)
+   int ffs_num_interfaces=9; // Number of interfaces including first and last
+   int ffs_num_configurations=100; // Number of configurations stored at first interface
+   int ffs_num_trials=100; // Number of trial trajectories per interface
+   uint64_t ffs_maximum_trial_time=1000000; // Maximum time steps per trial trajectory
+   int ffs_order_parameter_material=-1; // Material for order parameter, -1 = system
+
+   // Spin wave eigenmode parameters
+   int spin_wave_num_modes=10; // Number of lowest frequency modes to calculate
+   int spin_wave_lanczos_steps=0; // Maximum number of Lanczos steps, 0 = automatic
+   double spin_wave_tolerance=1.0e-8; // Relative residual tolerance of linear solver
+
 	// Local function declarations
 	int integrate_serial(int);
 	int integrate_mpi(int);
+	void free_creation_arrays();
 
    // Monte Carlo statistics counters
    double mc_statistics_moves = 0.0;
    double mc_statistics_reject = 0.0;
+   double mc_statistics_time = 0.0;
 
 /// @brief Function to increment time counter and associted variables
 ///
@@ -189,6 +227,9 @@ namespace sim{
 		sim::head_position[0]+=sim::head_speed*mp::dt_SI*1.0e10;
 		if(sim::hamiltonian_simulation_flags[4]==1) demag::update();
 		if(sim::lagrange_multiplier) update_lagrange_lambda();
+		if(sim::buffered_thermal_noise) advance_thermal_noise();
+		// check for graceful exit request within long integrations
+		sim::poll_graceful_exit();
 	}
 	
 /// @brief Function to run one a single program
@@ -216,6 +257,24 @@ int run(){
 	// Check for calling of function
 	if(err::check==true) std::cout << "sim::run has been called" << std::endl;
 
+   // Set up statistical data sets
+   #ifdef MPICF
+      int num_atoms_for_statistics = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+   #else
+      int num_atoms_for_statistics = atoms::num_atoms;
+   #endif
+   stats::initialize(num_atoms_for_statistics, mp::num_materials, atoms::m_spin_array, atoms::type_array, atoms::category_array);
+   if(stats::calculate_topological_charge){
+      stats::topological_charge.set_triangulation(num_atoms_for_statistics, cs::unit_cell_index_array, atoms::category_array,
+                                                  cs::total_num_unit_cells, cs::pbc);
+   }
+
+   // Free atomic data only needed during system creation
+   if(sim::release_creation_arrays) free_creation_arrays();
+
+   // Check for initial spin configuration from spin tile
+   if(sim::load_spin_tile_flag) load_spin_tile();
+
 	// For MPI version, calculate initialisation time
 	if(vmpi::my_rank==0){
 		#ifdef MPICF
@@ -241,17 +300,12 @@ int run(){
    // Seeds with single bit differences are not ideal and may be correlated for first few values - warming up integrator
    for(int i=0; i<1000; ++i) mtrandom::grnd();
 
-   // Set up statistical data sets
-   #ifdef MPICF
-      int num_atoms_for_statistics = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
-   #else
-      int num_atoms_for_statistics = atoms::num_atoms;
-   #endif
-   stats::initialize(num_atoms_for_statistics, mp::num_materials, atoms::m_spin_array, atoms::type_array, atoms::category_array);
-
    // Check for load spin configurations from checkpoint
    if(sim::load_checkpoint_flag) load_checkpoint();
 
+   // Allow checkpoint and exit on termination request or wall time limit
+   sim::enable_graceful_exit();
+
 	// Select program to run
 	switch(sim::program){
 		case 0:
@@ -372,6 +426,30 @@ int run(){
             zlog << "effective-damping..." << std::endl;
          }
          program::effective_damping();
+         break;
+
+      case 15:
+         if(vmpi::my_rank==0){
+            std::cout << "scaling-benchmark..." << std::endl;
+            zlog << "scaling-benchmark..." << std::endl;
+         }
+         program::scaling_benchmark();
+         break;
+
+      case 16:
+         if(vmpi::my_rank==0){
+            std::cout << "forward-flux-sampling..." << std::endl;
+            zlog << "forward-flux-sampling..." << std::endl;
+         }
+         program::forward_flux_sampling();
+         break;
+
+      case 17:
+         if(vmpi::my_rank==0){
+            std::cout << "spin-waves..." << std::endl;
+            zlog << "spin-waves..." << std::endl;
+         }
+         program::spin_waves();
          break;
 
 		case 50:
@@ -401,6 +479,11 @@ int run(){
       zlog << zTs() << "\tTotal moves: " << sim::mc_statistics_moves << std::endl;
       zlog << zTs() << "\t" << ((sim::mc_statistics_moves - sim::mc_statistics_reject)/sim::mc_statistics_moves)*100.0 << "% Accepted" << std::endl;
       zlog << zTs() << "\t" << (sim::mc_statistics_reject/sim::mc_statistics_moves)*100.0                              << "% Rejected" << std::endl;
+      if(sim::mc_statistics_time>0.0){
+         const char* order[3]={"random sites","random blocks","checkerboard blocks"};
+         std::cout << "\tSweep order: " << order[sim::mc_sweep_order] << ", throughput " << sim::mc_statistics_moves/sim::mc_statistics_time << " moves/s" << std::endl;
+         zlog << zTs() << "\tSweep order: " << order[sim::mc_sweep_order] << ", throughput " << sim::mc_statistics_moves/sim::mc_statistics_time << " moves/s" << std::endl;
+      }
    }
    if(sim::integrator==3 || sim::integrator==4){
       std::cout << "Constrained Monte Carlo statistics:" << std::endl;
@@ -420,6 +503,9 @@ int run(){
    // optionally save checkpoint file
    if(sim::save_checkpoint_flag && !sim::save_checkpoint_continuous_flag) save_checkpoint();
 
+   // optionally save spin tile
+   if(sim::save_spin_tile_flag) save_spin_tile();
+
 	return EXIT_SUCCESS;
 }
 
@@ -451,13 +537,31 @@ int integrate(int n_steps){
 	// Check for calling of function
 	if(err::check==true) std::cout << "sim::integrate has been called" << std::endl;
 	
+	// Checkpoint and exit if requested, after output of previous steps
+	sim::check_graceful_exit();
+
+	// Update temperature rescaled interactions for current temperature
+	sim::update_interaction_rescaling();
+
+	// Update fused uniaxial anisotropy coefficients for current temperature
+	sim::update_fused_uniaxial_anisotropy();
+
+	// Update spin transfer torque coefficients for current density
+	sim::update_spin_transfer_torque();
+
 	// Call serial or parallell depending at compile time
 	#ifdef MPICF
 		sim::integrate_mpi(n_steps);
 	#else 
 		sim::integrate_serial(n_steps);
 	#endif
+
+	// Update domain wall position and moving frame
+	sim::update_domain_wall_tracking();
 	
+	// Update run telemetry
+	if(sim::telemetry) sim::update_telemetry();
+
 	// return
 	return EXIT_SUCCESS;
 }
@@ -644,6 +748,43 @@ int integrate_mpi(int n_steps){
 	return EXIT_SUCCESS;
 }
 
+//-----------------------------------------------------------------------------
+//
+//   Function to release per-atom arrays which are only needed during system
+//   creation (sim:release-creation-arrays). Atomic coordinates are kept only
+//   when a runtime consumer requires them (HAMR fields, spin wave mode
+//   profiles and atomic configuration output), and the category (height)
+//   array is released after the statistics masks have been set. This saves
+//   at most 28 bytes per atom (24 for coordinates, 4 for the category); all
+//   other per-atom data, including the type, spin and neighbour list
+//   arrays, is unchanged.
+//
+//-----------------------------------------------------------------------------
+void free_creation_arrays(){
+
+   double released_memory=0.0;
+
+   // Coordinates are needed by HAMR fields, spin wave mode profiles and atomic configuration output
+   if(sim::program!=7 && sim::program!=17 && vout::output_atoms_config==false && vout::average_atoms_config==false){
+      released_memory+=3.0*double(atoms::x_coord_array.size())*sizeof(double);
+      std::vector<double>().swap(atoms::x_coord_array);
+      std::vector<double>().swap(atoms::y_coord_array);
+      std::vector<double>().swap(atoms::z_coord_array);
+   }
+   else zlog << zTs() << "Creation arrays: atomic coordinates retained for HAMR fields, spin wave mode profiles or atomic configuration output" << std::endl;
+
+   // Category array is needed by atomic configuration output
+   if(vout::output_atoms_config==false && vout::average_atoms_config==false){
+      released_memory+=double(atoms::category_array.size())*sizeof(int);
+      std::vector<int>().swap(atoms::category_array);
+   }
+
+   zlog << zTs() << "Creation arrays: released " << released_memory/1.0e6 << " MB RAM of creation-only atomic arrays on rank " << vmpi::my_rank << std::endl;
+
+   return;
+
+}
+
 } // Namespace sim
 
 
@@ -0,0 +1,125 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Spin transfer torque from a spin polarised current.
+//
+//   The Slonczewski (damping-like) and field-like torques acting on a spin
+//   S with current polarised along p are included in the LLG equation as an
+//   effective field
+//
+//      H_stt = a_j (S x p) + b_j p
+//
+//   which is added to the local field inside the spin update loops of the
+//   LLG integrators. The damping-like coefficient (in Tesla) is
+//
+//      a_j = eta hbar j V_atom / (2 e mu_s t)
+//
+//   where eta is the spin transfer efficiency of the material, j the current
+//   density, V_atom the volume per atom and t the thickness of the material
+//   layer, and b_j = beta a_j with beta the field-like ratio. A positive
+//   current drives the magnetisation towards p.
+//
+//   The coefficients are precomputed per material at the start of every call
+//   to sim::integrate so that programs can change the current density.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+// Vampire Header files
+#include "cells.hpp"
+#include "create.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+
+namespace sim{
+
+   bool spin_transfer_torque=false; // Flag to enable spin transfer torque in LLG integrators
+   double stt_current_density=0.0; // Current density (A/m^2)
+   std::vector<double> stt_relaxation_torque(0); // Damping-like coefficient a_j per material (T)
+   std::vector<double> stt_precession_torque(0); // Field-like coefficient b_j per material (T)
+   std::vector<double> stt_polarization_unit_vector(0); // Polarisation direction per material (3 per material)
+
+   namespace internal{
+
+      bool stt_materials=false; // Flag if any material has non-zero spin transfer efficiency
+
+   } // end of internal namespace
+
+   //--------------------------------------------------------------------------
+   // Function to initialise spin transfer torque arrays. Must be called
+   // after material parameters are set.
+   //--------------------------------------------------------------------------
+   void initialise_spin_transfer_torque(){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "sim::initialise_spin_transfer_torque has been called" << std::endl;
+
+      sim::stt_relaxation_torque.assign(mp::num_materials,0.0);
+      sim::stt_precession_torque.assign(mp::num_materials,0.0);
+      sim::stt_polarization_unit_vector.assign(3*mp::num_materials,0.0);
+
+      internal::stt_materials=false;
+      for(int mat=0;mat<mp::num_materials;mat++){
+         for(int i=0;i<3;i++) sim::stt_polarization_unit_vector[3*mat+i]=mp::material[mat].stt_polarization_unit_vector[i];
+         if(mp::material[mat].stt_efficiency!=0.0){
+            internal::stt_materials=true;
+            zlog << zTs() << "Spin transfer torque enabled for material " << mat+1 << " with efficiency "
+                 << mp::material[mat].stt_efficiency << ", field-like ratio " << mp::material[mat].stt_field_like_ratio
+                 << " and polarisation " << mp::material[mat].stt_polarization_unit_vector[0] << ", "
+                 << mp::material[mat].stt_polarization_unit_vector[1] << ", "
+                 << mp::material[mat].stt_polarization_unit_vector[2] << std::endl;
+         }
+      }
+
+      sim::spin_transfer_torque=false;
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to update spin transfer torque coefficients for the current
+   // density
+   //--------------------------------------------------------------------------
+   void update_spin_transfer_torque(){
+
+      if(!internal::stt_materials) return;
+
+      const double hbar=1.054571726e-34; // J s
+      const double e=1.602176565e-19; // C
+
+      // volume per atom (m^3) from unit cell, set during system creation
+      if(cells::num_atoms_in_unit_cell<=0) return;
+      const double atomic_volume=cs::unit_cell_size[0]*cs::unit_cell_size[1]*cs::unit_cell_size[2]*1.0e-30/double(cells::num_atoms_in_unit_cell);
+
+      for(int mat=0;mat<mp::num_materials;mat++){
+
+         const double thickness=(mp::material[mat].max-mp::material[mat].min)*cs::system_dimensions[2]*1.0e-10;
+
+         double aj=0.0;
+         if(thickness>0.0){
+            aj=mp::material[mat].stt_efficiency*hbar*sim::stt_current_density*atomic_volume/(2.0*e*mp::material[mat].mu_s_SI*thickness);
+         }
+
+         sim::stt_relaxation_torque[mat]=aj;
+         sim::stt_precession_torque[mat]=mp::material[mat].stt_field_like_ratio*aj;
+
+      }
+
+      sim::spin_transfer_torque=(sim::stt_current_density!=0.0);
+
+      return;
+
+   }
+
+} // end of namespace sim
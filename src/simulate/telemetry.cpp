@@ -0,0 +1,233 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Live run telemetry for long production simulations.
+//
+//   At a user defined interval (in time steps) the root process writes a
+//   small key=value status file containing the simulation progress,
+//   throughput, estimated time to completion of the current program stage,
+//   resident memory and the spread of compute and wait times across
+//   processors since the last update. The file is written to a temporary
+//   file and then renamed so that readers never see a partial file.
+//
+//   The update is performed from sim::integrate so that all processors
+//   take part in the reductions at the same time step.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <string>
+
+#ifndef WIN_COMPILE
+   #include <sys/time.h>
+   #include <unistd.h>
+#endif
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace sim{
+
+   namespace internal{
+
+      bool telemetry_initialised=false; // flag to initialise timers on first call
+      double telemetry_last_wall_time=0.0; // wall time at last update
+      uint64_t telemetry_last_time=0; // time step at last update
+      uint64_t telemetry_next_time=0; // time step for next update
+      double telemetry_total_atoms=0.0; // total number of atoms in system
+      double telemetry_last_compute_time=0.0; // compute time at last update
+      double telemetry_last_wait_time=0.0; // wait time at last update
+
+      std::string telemetry_stage="none"; // name of current program stage
+      uint64_t telemetry_stage_end_time=0; // last time step of current program stage
+
+      //-----------------------------------------------------------------------
+      // Function to return resident memory of the process in MB (or -1 if
+      // not available on this platform)
+      //-----------------------------------------------------------------------
+      double resident_memory(){
+
+         #ifndef WIN_COMPILE
+            std::ifstream statm("/proc/self/statm");
+            long size=0;
+            long resident=0;
+            if(statm >> size >> resident) return double(resident)*double(sysconf(_SC_PAGESIZE))/1.0e6;
+         #endif
+
+         return -1.0;
+
+      }
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to return wall clock time in seconds
+   //--------------------------------------------------------------------------
+   double wall_time(){
+
+      #ifdef MPICF
+         return MPI_Wtime();
+      #elif defined(WIN_COMPILE)
+         return double(clock())/double(CLOCKS_PER_SEC);
+      #else
+         struct timeval tv;
+         gettimeofday(&tv, NULL);
+         return double(tv.tv_sec)+1.0e-6*double(tv.tv_usec);
+      #endif
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to set the name and final time step of the current program
+   // stage, used to estimate time to completion
+   //--------------------------------------------------------------------------
+   void set_telemetry_stage(std::string name, uint64_t end_time){
+
+      internal::telemetry_stage=name;
+      internal::telemetry_stage_end_time=end_time;
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to write the telemetry status file if the update interval has
+   // been reached. Must be called by all processors.
+   //--------------------------------------------------------------------------
+   void update_telemetry(){
+
+      // check calling of routine if error checking is activated
+      if(err::check==true) std::cout << "sim::update_telemetry has been called" << std::endl;
+
+      // initialise counters on first call
+      if(!internal::telemetry_initialised){
+
+         #ifdef MPICF
+            double local_atoms = double(vmpi::num_core_atoms+vmpi::num_bdry_atoms);
+            MPI_Allreduce(&local_atoms, &internal::telemetry_total_atoms, 1, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+            internal::telemetry_last_compute_time=vmpi::TotalComputeTime;
+            internal::telemetry_last_wait_time=vmpi::TotalWaitTime;
+         #else
+            internal::telemetry_total_atoms = double(atoms::num_atoms);
+         #endif
+
+         internal::telemetry_last_wall_time=sim::wall_time();
+         internal::telemetry_last_time=sim::time;
+         internal::telemetry_next_time=(sim::time/sim::telemetry_rate+1)*sim::telemetry_rate;
+         internal::telemetry_initialised=true;
+
+         return;
+
+      }
+
+      // check for update
+      if(sim::time<internal::telemetry_next_time) return;
+
+      // calculate throughput since last update
+      const double current_wall_time=sim::wall_time();
+      const double elapsed=current_wall_time-internal::telemetry_last_wall_time;
+      const double steps=double(sim::time-internal::telemetry_last_time);
+      const double steps_per_second = elapsed > 0.0 ? steps/elapsed : 0.0;
+      const double atom_steps_per_second = steps_per_second*internal::telemetry_total_atoms;
+
+      // estimate remaining time for current stage
+      double eta=-1.0;
+      if(internal::telemetry_stage_end_time>=sim::time && steps_per_second>0.0){
+         eta = double(internal::telemetry_stage_end_time-sim::time)/steps_per_second;
+      }
+
+      // resident memory
+      const double local_memory=internal::resident_memory();
+      double max_memory=local_memory;
+      double total_memory=local_memory;
+
+      // compute and wait times since last update (counters may be reset by detailed MPI timing output)
+      double compute[3]={0.0,0.0,0.0}; // min, max, mean
+      double wait[3]={0.0,0.0,0.0};
+
+      #ifdef MPICF
+
+         double local_compute=vmpi::TotalComputeTime-internal::telemetry_last_compute_time;
+         double local_wait=vmpi::TotalWaitTime-internal::telemetry_last_wait_time;
+         if(local_compute<0.0) local_compute=vmpi::TotalComputeTime;
+         if(local_wait<0.0) local_wait=vmpi::TotalWaitTime;
+         internal::telemetry_last_compute_time=vmpi::TotalComputeTime;
+         internal::telemetry_last_wait_time=vmpi::TotalWaitTime;
+
+         MPI_Reduce(&local_compute, &compute[0], 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+         MPI_Reduce(&local_compute, &compute[1], 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+         MPI_Reduce(&local_compute, &compute[2], 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+         MPI_Reduce(&local_wait, &wait[0], 1, MPI_DOUBLE, MPI_MIN, 0, MPI_COMM_WORLD);
+         MPI_Reduce(&local_wait, &wait[1], 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+         MPI_Reduce(&local_wait, &wait[2], 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+         compute[2]/=double(vmpi::num_processors);
+         wait[2]/=double(vmpi::num_processors);
+
+         MPI_Reduce(&local_memory, &max_memory, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+         MPI_Reduce(&local_memory, &total_memory, 1, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+
+      #else
+         compute[0]=elapsed;
+         compute[1]=elapsed;
+         compute[2]=elapsed;
+      #endif
+
+      // root process writes status file
+      if(vmpi::my_rank==0){
+
+         const std::string tmp_file_name = sim::telemetry_file+".tmp";
+
+         std::ofstream status(tmp_file_name.c_str());
+         status << std::setprecision(10);
+         status << "step=" << sim::time << std::endl;
+         status << "simulation_time=" << double(sim::time)*mp::dt_SI << std::endl;
+         status << "temperature=" << sim::temperature << std::endl;
+         status << "stage=" << internal::telemetry_stage << std::endl;
+         status << "stage_end_step=" << internal::telemetry_stage_end_time << std::endl;
+         status << "steps_per_second=" << steps_per_second << std::endl;
+         status << "atom_steps_per_second=" << atom_steps_per_second << std::endl;
+         status << "stage_eta_seconds=" << eta << std::endl;
+         status << "processors=" << vmpi::num_processors << std::endl;
+         status << "resident_memory_mb_max=" << max_memory << std::endl;
+         status << "resident_memory_mb_total=" << total_memory << std::endl;
+         status << "compute_time_min=" << compute[0] << std::endl;
+         status << "compute_time_max=" << compute[1] << std::endl;
+         status << "compute_time_mean=" << compute[2] << std::endl;
+         status << "wait_time_min=" << wait[0] << std::endl;
+         status << "wait_time_max=" << wait[1] << std::endl;
+         status << "wait_time_mean=" << wait[2] << std::endl;
+         status << "unix_time=" << std::time(NULL) << std::endl;
+         status.close();
+
+         // replace status file in one step
+         #ifdef WIN_COMPILE
+            std::remove(sim::telemetry_file.c_str());
+         #endif
+         if(std::rename(tmp_file_name.c_str(), sim::telemetry_file.c_str())!=0){
+            zlog << zTs() << "Warning: unable to update telemetry file " << sim::telemetry_file << std::endl;
+         }
+
+      }
+
+      internal::telemetry_last_wall_time=current_wall_time;
+      internal::telemetry_last_time=sim::time;
+      internal::telemetry_next_time=(sim::time/sim::telemetry_rate+1)*sim::telemetry_rate;
+
+      return;
+
+   }
+
+} // end of namespace sim
@@ -0,0 +1,109 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Double buffered thermal noise for the LLG integrators.
+//
+//   The gaussian random numbers for the thermal field are generated for all
+//   local atoms in blocks of x, y and z components (as in the unbuffered
+//   calculation) and held in one of two buffers. The buffer for the next time
+//   step can be produced ahead of time, eg while waiting for halo data in the
+//   parallel integrators, so that the field calculation only scales
+//   precomputed noise by the thermal field prefactor.
+//
+//   Buffers are always filled in time step order from the same generator, so
+//   the noise sequence is identical whether or not it is produced ahead of
+//   time and results remain reproducible for a given seed.
+//
+//-----------------------------------------------------------------------------
+
+// Standard Libraries
+#include <algorithm>
+#include <vector>
+
+// Vampire Header files
+#include "atoms.hpp"
+#include "random.hpp"
+#include "sim.hpp"
+#include "vmpi.hpp"
+
+namespace sim{
+
+   namespace internal{
+
+      std::vector<double> thermal_noise_buffer[2]; // noise for current and next time step
+      int current_noise_buffer=0; // index of buffer for current time step
+      bool current_noise_ready=false; // noise for current time step has been generated
+      bool next_noise_ready=false; // noise for next time step has been generated
+
+      //-----------------------------------------------------------------------
+      // Function to fill a buffer with 3N gaussian random numbers
+      //-----------------------------------------------------------------------
+      void generate_thermal_noise(std::vector<double>& buffer){
+
+         #ifdef MPICF
+            const int num_local_atoms = vmpi::num_core_atoms+vmpi::num_bdry_atoms;
+         #else
+            const int num_local_atoms = atoms::num_atoms;
+         #endif
+
+         buffer.resize(3*num_local_atoms);
+         std::generate(buffer.begin(), buffer.end(), mtrandom::gaussian);
+
+         return;
+
+      }
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to return noise for the current time step, generating it if
+   // it has not already been produced
+   //--------------------------------------------------------------------------
+   const std::vector<double>& get_thermal_noise(){
+
+      std::vector<double>& buffer = internal::thermal_noise_buffer[internal::current_noise_buffer];
+
+      if(!internal::current_noise_ready){
+         internal::generate_thermal_noise(buffer);
+         internal::current_noise_ready=true;
+      }
+
+      return buffer;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to produce noise for the next time step ahead of time
+   //--------------------------------------------------------------------------
+   void produce_thermal_noise(){
+
+      if(!sim::buffered_thermal_noise || internal::next_noise_ready) return;
+
+      // current step must be generated first to preserve the random sequence
+      get_thermal_noise();
+
+      internal::generate_thermal_noise(internal::thermal_noise_buffer[1-internal::current_noise_buffer]);
+      internal::next_noise_ready=true;
+
+      return;
+
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to swap noise buffers at the end of a time step
+   //--------------------------------------------------------------------------
+   void advance_thermal_noise(){
+
+      internal::current_noise_buffer = 1-internal::current_noise_buffer;
+      internal::current_noise_ready = internal::next_noise_ready;
+      internal::next_noise_ready = false;
+
+      return;
+
+   }
+
+} // end of namespace sim
@@ -19,6 +19,11 @@ namespace stats{
    bool calculate_height_magnetization          = false;
    bool calculate_material_height_magnetization = false;
    bool calculate_system_susceptibility         = false;
+   bool calculate_topological_charge            = false;
+   bool calculate_system_energy                 = false;
+   bool calculate_material_energy               = false;
+   bool calculate_height_energy                 = false;
+   bool calculate_material_height_energy        = false;
 
    magnetization_statistic_t system_magnetization;
    magnetization_statistic_t material_magnetization;
@@ -27,6 +32,13 @@ namespace stats{
 
    susceptibility_statistic_t system_susceptibility;
 
+   topological_charge_statistic_t topological_charge;
+
+   energy_statistic_t system_energy_statistic;
+   energy_statistic_t material_energy_statistic;
+   energy_statistic_t height_energy_statistic;
+   energy_statistic_t material_height_energy_statistic;
+
    //-----------------------------------------------------------------------------
    // Shared variables used for statistics calculation
    //-----------------------------------------------------------------------------
@@ -0,0 +1,253 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+
+// Vampire headers
+#include "atoms.hpp"
+#include "errors.hpp"
+#include "material.hpp"
+#include "sim.hpp"
+#include "stats.hpp"
+#include "vmpi.hpp"
+#include "vio.hpp"
+
+namespace stats{
+
+//------------------------------------------------------------------------------------------------------
+// Constructor to initialize data structures
+//------------------------------------------------------------------------------------------------------
+energy_statistic_t::energy_statistic_t (): initialized(false){}
+
+//------------------------------------------------------------------------------------------------------
+// Function to determine if class is properly initialized
+//------------------------------------------------------------------------------------------------------
+bool energy_statistic_t::is_initialized(){
+   return initialized;
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to initialize mask
+//------------------------------------------------------------------------------------------------------
+void energy_statistic_t::set_mask(const int in_mask_size, std::vector<int> in_mask){
+
+   // Check that mask values never exceed mask_size
+   for(unsigned int atom=0; atom<in_mask.size(); ++atom){
+      if(in_mask[atom] > in_mask_size-1){
+         terminaltextcolor(RED);
+         std::cerr << "Programmer Error - mask id " << in_mask[atom] << " is greater than number of elements for mask "<< in_mask_size << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Programmer Error - mask id " << in_mask[atom] << " is greater than number of elements for mask "<< in_mask_size << std::endl;
+         err::vexit();
+      }
+   }
+
+   // save mask to internal storage
+   num_atoms = in_mask.size();
+   mask_size = in_mask_size;
+   mean_counter=0.0;
+   mask=in_mask; // copy contents of vector
+   energy.assign(num_energy_types*mask_size,0.0);
+   mean_energy.assign(num_energy_types*mask_size,0.0);
+   mean_energy_squared.assign(num_energy_types*mask_size,0.0);
+
+   // determine number of atoms in each mask id for normalisation of specific heat
+   num_atoms_in_mask.assign(mask_size,0.0);
+   for(int atom=0; atom<num_atoms; ++atom) num_atoms_in_mask[mask[atom]]+=1.0;
+
+   // Reduce on all CPUs
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &num_atoms_in_mask[0], mask_size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+
+   // Set flag indicating correct initialization
+   initialized=true;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to calculate energies of spins for all energy statistics given their masks
+//
+// The energy of each atom is split into the terms of energy_t (in Joules), with exchange and
+// magnetostatic pair energies shared equally between both atoms so that the sum over atoms gives
+// the energy of the system. All statistics are updated in a single pass over the atoms, and the
+// energies of all statistics are reduced together.
+//
+// Note: the single spin energy functions use the atomic spin arrays for neighbouring spins, so
+// sx, sy and sz must be the atomic spin arrays.
+//------------------------------------------------------------------------------------------------------
+void calculate_energies(const std::vector<energy_statistic_t*>& energy_statistics,
+                        const std::vector<double>& sx, // spin unit vector
+                        const std::vector<double>& sy,
+                        const std::vector<double>& sz){
+
+   const int num_statistics = energy_statistics.size();
+   if(num_statistics==0) return;
+
+   // initialise energies to zero
+   int buffer_size=0;
+   for(int s=0; s<num_statistics; ++s){
+      std::fill(energy_statistics[s]->energy.begin(),energy_statistics[s]->energy.end(),0.0);
+      buffer_size+=energy_statistics[s]->energy.size();
+   }
+
+   const int num_atoms = energy_statistics[0]->num_atoms;
+
+   // calculate contributions of spins to each energy category
+   for(int atom=0; atom<num_atoms; ++atom){
+
+      const double Sx=sx[atom];
+      const double Sy=sy[atom];
+      const double Sz=sz[atom];
+      const int imaterial=atoms::type_array[atom];
+
+      double e[num_energy_types];
+
+      switch(atoms::exchange_type){
+         case 0: e[exchange]=0.5*sim::spin_exchange_energy_isotropic(atom, Sx, Sy, Sz); break;
+         case 1: e[exchange]=0.5*sim::spin_exchange_energy_vector(atom, Sx, Sy, Sz); break;
+         case 2: e[exchange]=0.5*sim::spin_exchange_energy_tensor(atom, Sx, Sy, Sz); break;
+         default: e[exchange]=0.0; break;
+      }
+
+      switch(sim::AnisotropyType){
+         case 0: e[anisotropy]=sim::spin_scalar_anisotropy_energy(imaterial, Sz); break;
+         case 1: e[anisotropy]=sim::spin_tensor_anisotropy_energy(imaterial, Sx, Sy, Sz); break;
+         case 3: e[anisotropy]=sim::spin_local_uniaxial_anisotropy_energy(atom, imaterial, Sx, Sy, Sz); break;
+         default: e[anisotropy]=0.0; break;
+      }
+      // lattice anisotropy is included in the anisotropy energy
+      if(sim::lattice_anisotropy_flag) e[anisotropy]+=sim::spin_lattice_anisotropy_energy(atom, imaterial, Sx, Sy, Sz);
+
+      e[cubic_anisotropy]        = sim::CubicScalarAnisotropy ? sim::spin_cubic_anisotropy_energy(imaterial, Sx, Sy, Sz) : 0.0;
+      e[surface_anisotropy]      = sim::surface_anisotropy ? sim::spin_surface_anisotropy_energy(atom, imaterial, Sx, Sy, Sz) : 0.0;
+      e[applied_field]           = sim::spin_applied_field_energy(Sx, Sy, Sz);
+      e[magnetostatic]           = 0.5*sim::spin_magnetostatic_energy(atom, Sx, Sy, Sz);
+      e[second_order_anisotropy] = sim::second_order_uniaxial_anisotropy ? sim::spin_second_order_uniaxial_anisotropy_energy(atom, imaterial, Sx, Sy, Sz) : 0.0;
+
+      // convert to Joules and sum total energy
+      const double mu_s=mp::material[imaterial].mu_s_SI;
+      e[all]=0.0;
+      for(int type=1; type<num_energy_types; ++type){
+         e[type]*=mu_s;
+         e[all]+=e[type];
+      }
+
+      // add energies to each statistic
+      for(int s=0; s<num_statistics; ++s){
+         double* energy = &energy_statistics[s]->energy[num_energy_types*energy_statistics[s]->mask[atom]];
+         for(int type=0; type<num_energy_types; ++type) energy[type]+=e[type];
+      }
+
+   }
+
+   // Reduce energies of all statistics on all CPUS
+   #ifdef MPICF
+      std::vector<double> buffer(buffer_size);
+      int offset=0;
+      for(int s=0; s<num_statistics; ++s){
+         std::copy(energy_statistics[s]->energy.begin(),energy_statistics[s]->energy.end(),buffer.begin()+offset);
+         offset+=energy_statistics[s]->energy.size();
+      }
+      MPI_Allreduce(MPI_IN_PLACE, &buffer[0], buffer_size, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+      offset=0;
+      for(int s=0; s<num_statistics; ++s){
+         std::copy(buffer.begin()+offset,buffer.begin()+offset+energy_statistics[s]->energy.size(),energy_statistics[s]->energy.begin());
+         offset+=energy_statistics[s]->energy.size();
+      }
+   #endif
+
+   // Add energy and energy squared to means
+   for(int s=0; s<num_statistics; ++s){
+      energy_statistic_t& stat = *energy_statistics[s];
+      const int esize = stat.energy.size();
+      for(int idx=0; idx<esize; ++idx){
+         stat.mean_energy[idx]+=stat.energy[idx];
+         stat.mean_energy_squared[idx]+=stat.energy[idx]*stat.energy[idx];
+      }
+      stat.mean_counter+=1.0;
+   }
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to reset energy averages
+//------------------------------------------------------------------------------------------------------
+void energy_statistic_t::reset_averages(){
+
+   // reinitialise mean energies to zero
+   std::fill(mean_energy.begin(),mean_energy.end(),0.0);
+   std::fill(mean_energy_squared.begin(),mean_energy_squared.end(),0.0);
+
+   // reset data counter
+   mean_counter = 0.0;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to output mean energies (J) as string, with all energy types for each mask id
+//------------------------------------------------------------------------------------------------------
+std::string energy_statistic_t::output_mean_energy(){
+
+   // result string stream
+   std::ostringstream result;
+
+   // inverse number of data samples
+   const double ic = 1.0/mean_counter;
+
+   // loop over all energy values
+   for(int mask_id=0; mask_id<mask_size; ++mask_id){
+      for(int type=0; type<num_energy_types; ++type) result << mean_energy[num_energy_types*mask_id + type]*ic << "\t";
+   }
+
+   return result.str();
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to output specific heat values as string
+//
+//       C_V / N k_B = ( <E^2> - <E>^2 ) / ( N (k_B T)^2 )
+//
+//-------------------------------------------------------------------------------------------------------
+std::string energy_statistic_t::output_specific_heat(const double temperature){
+
+   // result string stream
+   std::ostringstream result;
+
+   // determine inverse thermal energy 1/(kB T) (flushing to zero for very low temperatures)
+   const double ikT = temperature < 1.e-300 ? 0.0 : 1.0/(1.3806503e-23*temperature);
+
+   // inverse number of data samples
+   const double ic = 1.0/mean_counter;
+
+   // loop over all mask ids
+   for(int mask_id=0; mask_id<mask_size; ++mask_id){
+
+      const int idx = num_energy_types*mask_id + all;
+      const double mean_e = mean_energy[idx]*ic;
+      const double variance = mean_energy_squared[idx]*ic - mean_e*mean_e;
+      const double cv = num_atoms_in_mask[mask_id] > 0.0 ? variance*ikT*ikT/num_atoms_in_mask[mask_id] : 0.0; // in k_B per atom
+
+      result << cv << "\t";
+
+   }
+
+   return result.str();
+
+}
+
+} // end of namespace stats
@@ -29,19 +29,21 @@ namespace stats{
       // define vector mask
       std::vector<int> mask(stats::num_atoms,0);
 
-      // system magnetization
+      // system magnetization and energy
       if(stats::calculate_system_magnetization){
          stats::system_magnetization.set_mask(1,mask,magnetic_moment_array);
       }
+      if(stats::calculate_system_energy) stats::system_energy_statistic.set_mask(1,mask);
 
-      // material magnetization
-      if(stats::calculate_material_magnetization){
+      // material magnetization and energy
+      if(stats::calculate_material_magnetization || stats::calculate_material_energy){
          for(int atom=0; atom < stats::num_atoms; ++atom) mask[atom] = material_type_array[atom];
-         stats::material_magnetization.set_mask(num_materials,mask,magnetic_moment_array);
+         if(stats::calculate_material_magnetization) stats::material_magnetization.set_mask(num_materials,mask,magnetic_moment_array);
+         if(stats::calculate_material_energy) stats::material_energy_statistic.set_mask(num_materials,mask);
       }
 
-      // height magnetization
-      if(stats::calculate_height_magnetization){
+      // height magnetization and energy
+      if(stats::calculate_height_magnetization || stats::calculate_height_energy){
          int max_height=0;
          for(int atom=0; atom < stats::num_atoms; ++atom){
             mask[atom] = height_category_array[atom];
@@ -51,11 +53,12 @@ namespace stats{
          #ifdef MPICF
             MPI_Allreduce(MPI_IN_PLACE, &max_height, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
          #endif
-         stats::height_magnetization.set_mask(max_height+1,mask,magnetic_moment_array);
+         if(stats::calculate_height_magnetization) stats::height_magnetization.set_mask(max_height+1,mask,magnetic_moment_array);
+         if(stats::calculate_height_energy) stats::height_energy_statistic.set_mask(max_height+1,mask);
       }
 
-      // material height magnetization
-      if(stats::calculate_material_height_magnetization){
+      // material height magnetization and energy
+      if(stats::calculate_material_height_magnetization || stats::calculate_material_height_energy){
          // store as blocks of material magnetisation for each height [ m1x m1y m1z m1m m2x m2y m2z 2m2 ] [ m1x m1y m1z m1m m2x m2y m2z 2m2 ] ...
          // num masks = num_materials*num_heights
          int max_height=0;
@@ -69,7 +72,8 @@ namespace stats{
          #ifdef MPICF
             MPI_Allreduce(MPI_IN_PLACE, &max_height, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
          #endif
-         stats::material_height_magnetization.set_mask(num_materials*(max_height+1),mask,magnetic_moment_array);
+         if(stats::calculate_material_height_magnetization) stats::material_height_magnetization.set_mask(num_materials*(max_height+1),mask,magnetic_moment_array);
+         if(stats::calculate_material_height_energy) stats::material_height_energy_statistic.set_mask(num_materials*(max_height+1),mask);
       }
 
       // system susceptibility
@@ -36,6 +36,17 @@ namespace stats{
       // update susceptibility statistics
       if(stats::calculate_system_susceptibility)         stats::system_susceptibility.calculate(stats::system_magnetization.get_magnetization());
 
+      // update topological charge statistics
+      if(stats::calculate_topological_charge)            stats::topological_charge.calculate_topological_charge(sx,sy,sz);
+
+      // update energy statistics (all masks in a single pass over atoms)
+      std::vector<energy_statistic_t*> energy_statistics;
+      if(stats::calculate_system_energy)          energy_statistics.push_back(&stats::system_energy_statistic);
+      if(stats::calculate_material_energy)        energy_statistics.push_back(&stats::material_energy_statistic);
+      if(stats::calculate_height_energy)          energy_statistics.push_back(&stats::height_energy_statistic);
+      if(stats::calculate_material_height_energy) energy_statistics.push_back(&stats::material_height_energy_statistic);
+      if(energy_statistics.size()>0) stats::calculate_energies(energy_statistics,sx,sy,sz);
+
       return;
 
    }
@@ -54,6 +65,15 @@ namespace stats{
       // reset susceptibility statistics
       if(stats::calculate_system_susceptibility) stats::system_susceptibility.reset_averages();
 
+      // reset topological charge statistics
+      if(stats::calculate_topological_charge) stats::topological_charge.reset_averages();
+
+      // reset energy statistics
+      if(stats::calculate_system_energy)          stats::system_energy_statistic.reset_averages();
+      if(stats::calculate_material_energy)        stats::material_energy_statistic.reset_averages();
+      if(stats::calculate_height_energy)          stats::height_energy_statistic.reset_averages();
+      if(stats::calculate_material_height_energy) stats::material_height_energy_statistic.reset_averages();
+
       return;
 
    }
@@ -0,0 +1,368 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+
+// C++ standard library headers
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <sstream>
+#include <stdint.h>
+#include <utility>
+
+// Vampire headers
+#include "errors.hpp"
+#include "stats.hpp"
+#include "vmpi.hpp"
+#include "vio.hpp"
+
+namespace stats{
+
+//------------------------------------------------------------------------------------------------------
+// Constructor to initialize data structures
+//------------------------------------------------------------------------------------------------------
+topological_charge_statistic_t::topological_charge_statistic_t (): initialized(false), num_atoms(0), num_remote(0), num_layers(0), mean_counter(0.0){}
+
+//------------------------------------------------------------------------------------------------------
+// Function to determine if class is properly initialized
+//------------------------------------------------------------------------------------------------------
+bool topological_charge_statistic_t::is_initialized(){
+   return initialized;
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to build lattice triangulation for the Berg-Luscher topological charge.
+//
+// Each atom with unit cell coordinates (x,y,z) and unit cell site uc forms two triangles with its
+// neighbours at the same site in adjacent unit cells, (x,y)-(x+1,y)-(x,y+1) and (x,y)-(x-1,y)-(x,y-1),
+// which together tile the x-y plane of each sublattice with anticlockwise triangles. Triangles are
+// assigned to the layer (mask) of the first atom, and the charge of each layer is averaged over the
+// sublattices in the layer.
+//
+// Neighbours on other processors are not necessarily halo atoms (which are only those within the
+// exchange range), so the spins of remote vertices are exchanged directly, with the list of atoms
+// each processor sends set up here.
+//------------------------------------------------------------------------------------------------------
+void topological_charge_statistic_t::set_triangulation(const int num_local_atoms,
+                                                       const std::vector<int>& unit_cell_index, // x,y,z,uc for each atom
+                                                       const std::vector<int>& layer_mask,
+                                                       const unsigned int num_unit_cells[3],
+                                                       const bool periodic[3]){
+
+   if(int(unit_cell_index.size())<4*num_local_atoms){
+      terminaltextcolor(RED);
+      std::cerr << "Programmer Error - unit cell coordinates are not available for topological charge statistic." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Programmer Error - unit cell coordinates are not available for topological charge statistic." << std::endl;
+      err::vexit();
+   }
+
+   num_atoms=num_local_atoms;
+   const int64_t n[3]={int64_t(num_unit_cells[0]),int64_t(num_unit_cells[1]),int64_t(num_unit_cells[2])};
+
+   // determine number of layers and sites in unit cell
+   int max_layer=0;
+   int max_uc=0;
+   for(int atom=0; atom<num_atoms; ++atom){
+      max_layer=std::max(max_layer,layer_mask[atom]);
+      max_uc=std::max(max_uc,unit_cell_index[4*atom+3]);
+   }
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &max_layer, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+      MPI_Allreduce(MPI_IN_PLACE, &max_uc, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+   #endif
+   num_layers=max_layer+1;
+   const int64_t nuc=max_uc+1;
+
+   // sort local atoms by site key (x,y,z,uc)
+   std::vector< std::pair<int64_t,int> > site(num_atoms);
+   for(int atom=0; atom<num_atoms; ++atom){
+      const int* uci=&unit_cell_index[4*atom];
+      site[atom]=std::make_pair(((int64_t(uci[0])*n[1]+uci[1])*n[2]+uci[2])*nuc+uci[3],atom);
+   }
+   std::sort(site.begin(),site.end());
+
+   // build triangles of local atoms, with remote vertices numbered from num_atoms in order of request
+   std::vector<int> all_triangles;
+   std::vector<int> all_triangle_layers;
+   std::vector<int64_t> request;
+   std::vector< std::pair<int64_t,int> > request_index; // sorted key -> request number
+   std::vector<int> sublattice(num_layers*nuc,0);
+
+   for(int atom=0; atom<num_atoms; ++atom){
+
+      const int* uci=&unit_cell_index[4*atom];
+      sublattice[layer_mask[atom]*nuc+uci[3]]=1;
+
+      for(int sign=1; sign>=-1; sign-=2){
+
+         int corner[2]={-1,-1};
+         for(int d=0; d<2; d++){
+            int64_t c[3]={uci[0],uci[1],uci[2]};
+            c[d]+=sign;
+            if(periodic[d]) c[d]=((c[d]%n[d])+n[d])%n[d];
+            if(c[d]<0 || c[d]>=n[d]) break;
+            const int64_t key=((c[0]*n[1]+c[1])*n[2]+c[2])*nuc+uci[3];
+            std::vector< std::pair<int64_t,int> >::iterator it=std::lower_bound(site.begin(),site.end(),std::make_pair(key,-1));
+            if(it!=site.end() && it->first==key) corner[d]=it->second;
+            else{
+               #ifdef MPICF
+                  std::vector< std::pair<int64_t,int> >::iterator rit=std::lower_bound(request_index.begin(),request_index.end(),std::make_pair(key,-1));
+                  if(rit==request_index.end() || rit->first!=key){
+                     rit=request_index.insert(rit,std::make_pair(key,int(request.size())));
+                     request.push_back(key);
+                  }
+                  corner[d]=num_atoms+rit->second;
+               #else
+                  break;
+               #endif
+            }
+         }
+
+         // skip triangles at surfaces
+         if(corner[0]<0 || corner[1]<0) continue;
+
+         all_triangles.push_back(atom);
+         all_triangles.push_back(corner[0]);
+         all_triangles.push_back(corner[1]);
+         all_triangle_layers.push_back(layer_mask[atom]);
+
+      }
+   }
+
+   num_remote=request.size();
+   std::vector<int> remote_found(num_remote+1,0);
+
+   #ifdef MPICF
+
+      // share requested sites with all processors
+      const int num_processors=vmpi::num_processors;
+      std::vector<int> request_counts(num_processors,0);
+      std::vector<int> request_displacements(num_processors,0);
+      int num_requests=num_remote;
+      MPI_Allgather(&num_requests, 1, MPI_INT, &request_counts[0], 1, MPI_INT, MPI_COMM_WORLD);
+      int total_requests=0;
+      for(int p=0; p<num_processors; ++p){
+         request_displacements[p]=total_requests;
+         total_requests+=request_counts[p];
+      }
+      std::vector<long long> local_requests(request.begin(),request.end());
+      local_requests.push_back(0);
+      std::vector<long long> all_requests(total_requests+1,0);
+      MPI_Allgatherv(&local_requests[0], num_requests, MPI_LONG_LONG_INT, &all_requests[0], &request_counts[0], &request_displacements[0], MPI_LONG_LONG_INT, MPI_COMM_WORLD);
+
+      // find requested sites held locally and reply with their request numbers
+      send_counts.assign(num_processors,0);
+      send_atoms.clear();
+      std::vector<int> reply;
+      for(int p=0; p<num_processors; ++p){
+         if(p==vmpi::my_rank) continue;
+         for(int r=0; r<request_counts[p]; ++r){
+            const int64_t key=all_requests[request_displacements[p]+r];
+            std::vector< std::pair<int64_t,int> >::iterator it=std::lower_bound(site.begin(),site.end(),std::make_pair(key,-1));
+            if(it==site.end() || it->first!=key) continue;
+            send_atoms.push_back(it->second);
+            reply.push_back(r);
+            send_counts[p]++;
+         }
+      }
+      reply.push_back(0);
+
+      recv_counts.assign(num_processors,0);
+      MPI_Alltoall(&send_counts[0], 1, MPI_INT, &recv_counts[0], 1, MPI_INT, MPI_COMM_WORLD);
+
+      send_displacements.assign(num_processors,0);
+      recv_displacements.assign(num_processors,0);
+      int total_send=0;
+      int total_recv=0;
+      for(int p=0; p<num_processors; ++p){
+         send_displacements[p]=total_send;
+         recv_displacements[p]=total_recv;
+         total_send+=send_counts[p];
+         total_recv+=recv_counts[p];
+      }
+
+      recv_slot.assign(total_recv+1,0);
+      MPI_Alltoallv(&reply[0], &send_counts[0], &send_displacements[0], MPI_INT, &recv_slot[0], &recv_counts[0], &recv_displacements[0], MPI_INT, MPI_COMM_WORLD);
+      recv_slot.resize(total_recv);
+      for(int k=0; k<total_recv; ++k) remote_found[recv_slot[k]]=1;
+
+      // convert counts and displacements to spin components
+      for(int p=0; p<num_processors; ++p){
+         send_counts[p]*=3;
+         recv_counts[p]*=3;
+         send_displacements[p]*=3;
+         recv_displacements[p]*=3;
+      }
+
+   #endif
+
+   // remove triangles with vertices which do not exist on any processor
+   triangle.clear();
+   triangle_layer.clear();
+   for(unsigned int t=0; t<all_triangle_layers.size(); ++t){
+      bool valid=true;
+      for(int v=1; v<3; ++v){
+         const int idx=all_triangles[3*t+v];
+         if(idx>=num_atoms && remote_found[idx-num_atoms]==0) valid=false;
+      }
+      if(!valid) continue;
+      for(int v=0; v<3; ++v) triangle.push_back(all_triangles[3*t+v]);
+      triangle_layer.push_back(all_triangle_layers[t]);
+   }
+
+   // normalise charge of each layer by number of sublattices
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &sublattice[0], int(sublattice.size()), MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+   #endif
+   normalisation.assign(num_layers,0.0);
+   for(int layer=0; layer<num_layers; ++layer){
+      int num_sublattices=0;
+      for(int uc=0; uc<nuc; ++uc) num_sublattices+=sublattice[layer*nuc+uc];
+      if(num_sublattices>0) normalisation[layer]=1.0/(4.0*M_PI*double(num_sublattices));
+   }
+
+   topological_charge.assign(num_layers,0.0);
+   mean_topological_charge.assign(num_layers,0.0);
+   mean_counter=0.0;
+
+   int num_triangles=triangle_layer.size();
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &num_triangles, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+   zlog << zTs() << "Topological charge triangulation generated with " << num_triangles << " triangles in " << num_layers << " layers" << std::endl;
+
+   // Set flag indicating correct initialization
+   initialized=true;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to calculate topological charge of each layer from the solid angles of the triangles
+//
+//    tan(Omega/2) = S1.(S2 x S3) / (1 + S1.S2 + S2.S3 + S3.S1)
+//
+//------------------------------------------------------------------------------------------------------
+void topological_charge_statistic_t::calculate_topological_charge(const std::vector<double>& sx, // spin unit vector
+                                                                  const std::vector<double>& sy,
+                                                                  const std::vector<double>& sz){
+
+   // copy local spins and exchange spins of remote vertices
+   std::vector<double> spin(3*(num_atoms+num_remote));
+   for(int atom=0; atom<num_atoms; ++atom){
+      spin[3*atom+0]=sx[atom];
+      spin[3*atom+1]=sy[atom];
+      spin[3*atom+2]=sz[atom];
+   }
+
+   #ifdef MPICF
+      const int num_send=send_atoms.size();
+      const int num_recv=recv_slot.size();
+      std::vector<double> send_buffer(3*num_send+1);
+      std::vector<double> recv_buffer(3*num_recv+1);
+      for(int k=0; k<num_send; ++k){
+         const int atom=send_atoms[k];
+         send_buffer[3*k+0]=sx[atom];
+         send_buffer[3*k+1]=sy[atom];
+         send_buffer[3*k+2]=sz[atom];
+      }
+      MPI_Alltoallv(&send_buffer[0], &send_counts[0], &send_displacements[0], MPI_DOUBLE, &recv_buffer[0], &recv_counts[0], &recv_displacements[0], MPI_DOUBLE, MPI_COMM_WORLD);
+      for(int k=0; k<num_recv; ++k){
+         const int idx=num_atoms+recv_slot[k];
+         spin[3*idx+0]=recv_buffer[3*k+0];
+         spin[3*idx+1]=recv_buffer[3*k+1];
+         spin[3*idx+2]=recv_buffer[3*k+2];
+      }
+   #endif
+
+   std::fill(topological_charge.begin(),topological_charge.end(),0.0);
+
+   const int num_triangles=triangle_layer.size();
+   for(int t=0; t<num_triangles; ++t){
+
+      const double* s1=&spin[3*triangle[3*t+0]];
+      const double* s2=&spin[3*triangle[3*t+1]];
+      const double* s3=&spin[3*triangle[3*t+2]];
+
+      const double triple=s1[0]*(s2[1]*s3[2]-s2[2]*s3[1])+s1[1]*(s2[2]*s3[0]-s2[0]*s3[2])+s1[2]*(s2[0]*s3[1]-s2[1]*s3[0]);
+      const double denominator=1.0+s1[0]*s2[0]+s1[1]*s2[1]+s1[2]*s2[2]
+                                  +s2[0]*s3[0]+s2[1]*s3[1]+s2[2]*s3[2]
+                                  +s3[0]*s1[0]+s3[1]*s1[1]+s3[2]*s1[2];
+
+      topological_charge[triangle_layer[t]]+=2.0*atan2(triple,denominator);
+
+   }
+
+   // Reduce on all CPUS
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE, &topological_charge[0], num_layers, MPI_DOUBLE, MPI_SUM, MPI_COMM_WORLD);
+   #endif
+
+   for(int layer=0; layer<num_layers; ++layer){
+      topological_charge[layer]*=normalisation[layer];
+      mean_topological_charge[layer]+=topological_charge[layer];
+   }
+   mean_counter+=1.0;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to reset topological charge averages
+//------------------------------------------------------------------------------------------------------
+void topological_charge_statistic_t::reset_averages(){
+
+   std::fill(mean_topological_charge.begin(),mean_topological_charge.end(),0.0);
+   mean_counter=0.0;
+
+   return;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to get topological charge data
+//------------------------------------------------------------------------------------------------------
+const std::vector<double>& topological_charge_statistic_t::get_topological_charge(){
+
+   return topological_charge;
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to output topological charge of each layer as string
+//------------------------------------------------------------------------------------------------------
+std::string topological_charge_statistic_t::output_topological_charge(){
+
+   // result string stream
+   std::ostringstream result;
+
+   for(int layer=0; layer<num_layers; ++layer) result << topological_charge[layer] << "\t";
+
+   return result.str();
+
+}
+
+//------------------------------------------------------------------------------------------------------
+// Function to output mean topological charge of each layer as string
+//------------------------------------------------------------------------------------------------------
+std::string topological_charge_statistic_t::output_mean_topological_charge(){
+
+   // result string stream
+   std::ostringstream result;
+
+   // inverse number of data samples
+   const double ic = 1.0/mean_counter;
+
+   for(int layer=0; layer<num_layers; ++layer) result << mean_topological_charge[layer]*ic << "\t";
+
+   return result.str();
+
+}
+
+} // end of namespace stats
@@ -0,0 +1,264 @@
+//-----------------------------------------------------------------------------
+//
+// This source file is part of the VAMPIRE open source package under the
+// GNU GPL (version 2) licence (see licence file for details).
+//
+//-----------------------------------------------------------------------------
+//
+//   Tiled initialisation of large systems from a pre-equilibrated block.
+//
+//   A small periodic block with the same unit cell and materials is
+//   equilibrated in a separate run with sim:save-spin-tile, which writes the
+//   spin of every atom indexed by its unit cell coordinates and site in the
+//   unit cell. A large system run with sim:load-spin-tile then sets the
+//   spin of each atom from the block atom at the same site, with unit cell
+//   coordinates taken modulo the block size.
+//
+//   To avoid imposing the periodicity of the block on the large system each
+//   tile is shifted by a random lattice translation of the periodic block
+//   along directions where the system is larger than the block. The shifts
+//   are generated from a common seed so that tiles are consistent on all
+//   processors. Spins at tile boundaries are not matched to each other, so
+//   a short re-equilibration is still needed before measuring.
+//
+//   The tile is a text file with a header line "nx ny nz n_uc num_atoms"
+//   followed by one line "x y z uc sx sy sz" per atom.
+//
+//-----------------------------------------------------------------------------
+
+// System headers
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+// Program headers
+#include "atoms.hpp"
+#include "cells.hpp"
+#include "create.hpp"
+#include "errors.hpp"
+#include "random.hpp"
+#include "sim.hpp"
+#include "vio.hpp"
+#include "vmpi.hpp"
+
+namespace vio{
+namespace internal{
+
+   //--------------------------------------------------------------------------
+   // Function to return positive modulus
+   //--------------------------------------------------------------------------
+   inline int positive_modulo(const int i, const int n){
+      const int m=i%n;
+      return m<0 ? m+n : m;
+   }
+
+   //--------------------------------------------------------------------------
+   // Function to return floor of integer division
+   //--------------------------------------------------------------------------
+   inline int floor_division(const int i, const int n){
+      return (i-positive_modulo(i,n))/n;
+   }
+
+} // end of internal namespace
+} // end of vio namespace
+
+//-----------------------------------------------------------------------------
+// Function to save spin tile file from the spins of all processors
+//-----------------------------------------------------------------------------
+void save_spin_tile(){
+
+   const int num_local_atoms=atoms::num_atoms-vmpi::num_halo_atoms;
+
+   if(int(cs::unit_cell_index_array.size())<4*num_local_atoms) return;
+
+   std::vector<int> index(cs::unit_cell_index_array.begin(),cs::unit_cell_index_array.begin()+4*num_local_atoms);
+   std::vector<double> spin(3*num_local_atoms);
+   for(int atom=0;atom<num_local_atoms;atom++){
+      spin[3*atom+0]=atoms::x_spin_array[atom];
+      spin[3*atom+1]=atoms::y_spin_array[atom];
+      spin[3*atom+2]=atoms::z_spin_array[atom];
+   }
+
+   // gather unit cell coordinates and spins on root process
+   #ifdef MPICF
+      std::vector<int> num_atoms_on_rank(vmpi::num_processors,0);
+      MPI_Gather(const_cast<int*>(&num_local_atoms),1,MPI_INT,&num_atoms_on_rank[0],1,MPI_INT,0,MPI_COMM_WORLD);
+
+      std::vector<int> index_counts(vmpi::num_processors,0);
+      std::vector<int> index_displacements(vmpi::num_processors,0);
+      std::vector<int> spin_counts(vmpi::num_processors,0);
+      std::vector<int> spin_displacements(vmpi::num_processors,0);
+      int total_atoms=0;
+      for(int p=0;p<vmpi::num_processors;p++){
+         index_counts[p]=4*num_atoms_on_rank[p];
+         spin_counts[p]=3*num_atoms_on_rank[p];
+         index_displacements[p]=4*total_atoms;
+         spin_displacements[p]=3*total_atoms;
+         total_atoms+=num_atoms_on_rank[p];
+      }
+
+      std::vector<int> all_index(vmpi::my_rank==0 ? 4*total_atoms+1 : 1);
+      std::vector<double> all_spin(vmpi::my_rank==0 ? 3*total_atoms+1 : 1);
+      MPI_Gatherv(&index[0],4*num_local_atoms,MPI_INT,&all_index[0],&index_counts[0],&index_displacements[0],MPI_INT,0,MPI_COMM_WORLD);
+      MPI_Gatherv(&spin[0],3*num_local_atoms,MPI_DOUBLE,&all_spin[0],&spin_counts[0],&spin_displacements[0],MPI_DOUBLE,0,MPI_COMM_WORLD);
+      index.swap(all_index);
+      spin.swap(all_spin);
+   #else
+      const int total_atoms=num_local_atoms;
+   #endif
+
+   if(vmpi::my_rank==0){
+
+      std::ofstream tile_file(sim::spin_tile_file.c_str());
+
+      if(!tile_file.is_open()){
+         terminaltextcolor(RED);
+         std::cerr << "Error: Unable to open spin tile file " << sim::spin_tile_file << " for writing. Exiting." << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Error: Unable to open spin tile file " << sim::spin_tile_file << " for writing. Exiting." << std::endl;
+         err::vexit();
+      }
+
+      tile_file << cs::total_num_unit_cells[0] << "\t" << cs::total_num_unit_cells[1] << "\t" << cs::total_num_unit_cells[2] << "\t"
+                << cells::num_atoms_in_unit_cell << "\t" << total_atoms << std::endl;
+
+      tile_file.precision(10);
+      for(int atom=0;atom<total_atoms;atom++){
+         tile_file << index[4*atom+0] << "\t" << index[4*atom+1] << "\t" << index[4*atom+2] << "\t" << index[4*atom+3] << "\t"
+                   << spin[3*atom+0] << "\t" << spin[3*atom+1] << "\t" << spin[3*atom+2] << "\n";
+      }
+
+      tile_file.close();
+
+      zlog << zTs() << "Spin tile of " << cs::total_num_unit_cells[0] << " x " << cs::total_num_unit_cells[1] << " x "
+           << cs::total_num_unit_cells[2] << " unit cells written to file " << sim::spin_tile_file << std::endl;
+
+   }
+
+   return;
+
+}
+
+//-----------------------------------------------------------------------------
+// Function to initialise spins by tiling the spin tile file over the system
+//-----------------------------------------------------------------------------
+void load_spin_tile(){
+
+   // open spin tile file (read independently by all processors)
+   std::ifstream tile_file(sim::spin_tile_file.c_str());
+
+   if(!tile_file.is_open()){
+      terminaltextcolor(RED);
+      std::cerr << "Error: Unable to open spin tile file " << sim::spin_tile_file << " for reading. Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error: Unable to open spin tile file " << sim::spin_tile_file << " for reading. Exiting." << std::endl;
+      err::vexit();
+   }
+
+   int n[3]={0,0,0};
+   int num_uc_atoms=0;
+   int num_tile_atoms=0;
+   tile_file >> n[0] >> n[1] >> n[2] >> num_uc_atoms >> num_tile_atoms;
+
+   if(n[0]<1 || n[1]<1 || n[2]<1 || num_tile_atoms<0){
+      terminaltextcolor(RED);
+      std::cerr << "Error: Spin tile file " << sim::spin_tile_file << " has an invalid header. Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error: Spin tile file " << sim::spin_tile_file << " has an invalid header. Exiting." << std::endl;
+      err::vexit();
+   }
+
+   if(num_uc_atoms!=cells::num_atoms_in_unit_cell){
+      terminaltextcolor(RED);
+      std::cerr << "Error: Spin tile file " << sim::spin_tile_file << " has " << num_uc_atoms << " atoms per unit cell but the system has "
+                << cells::num_atoms_in_unit_cell << ". Exiting." << std::endl;
+      terminaltextcolor(WHITE);
+      zlog << zTs() << "Error: Spin tile file " << sim::spin_tile_file << " has " << num_uc_atoms << " atoms per unit cell but the system has "
+           << cells::num_atoms_in_unit_cell << ". Exiting." << std::endl;
+      err::vexit();
+   }
+
+   // read block spins, sites missing from the block keep their initial spin
+   const int num_sites=n[0]*n[1]*n[2]*num_uc_atoms;
+   std::vector<double> tile(3*num_sites,0.0);
+   std::vector<bool> tile_site(num_sites,false);
+
+   for(int i=0;i<num_tile_atoms;i++){
+      int c[4];
+      double s[3];
+      tile_file >> c[0] >> c[1] >> c[2] >> c[3] >> s[0] >> s[1] >> s[2];
+      if(tile_file.fail()){
+         terminaltextcolor(RED);
+         std::cerr << "Error: Spin tile file " << sim::spin_tile_file << " ends after " << i << " of " << num_tile_atoms << " atoms. Exiting." << std::endl;
+         terminaltextcolor(WHITE);
+         zlog << zTs() << "Error: Spin tile file " << sim::spin_tile_file << " ends after " << i << " of " << num_tile_atoms << " atoms. Exiting." << std::endl;
+         err::vexit();
+      }
+      if(c[0]<0 || c[0]>=n[0] || c[1]<0 || c[1]>=n[1] || c[2]<0 || c[2]>=n[2] || c[3]<0 || c[3]>=num_uc_atoms) continue;
+      const int site=((c[0]*n[1]+c[1])*n[2]+c[2])*num_uc_atoms+c[3];
+      tile[3*site+0]=s[0];
+      tile[3*site+1]=s[1];
+      tile[3*site+2]=s[2];
+      tile_site[site]=true;
+   }
+
+   tile_file.close();
+
+   // generate random lattice translation of each tile from a common seed
+   int num_tiles[3];
+   bool shift[3];
+   for(int d=0;d<3;d++){
+      num_tiles[d]=(int(cs::total_num_unit_cells[d])+n[d]-1)/n[d];
+      shift[d]=(sim::spin_tile_random_shift && num_tiles[d]>1);
+   }
+
+   MTRand random_tile_rng;
+   random_tile_rng.seed(345678);
+   std::vector<int> tile_shift(3*num_tiles[0]*num_tiles[1]*num_tiles[2],0);
+   for(unsigned int t=0;t<tile_shift.size();t++){
+      const int d=t%3;
+      tile_shift[t] = shift[d] ? int(double(n[d])*random_tile_rng())%n[d] : 0;
+   }
+
+   // set spins of local atoms from block
+   const int num_local_atoms=atoms::num_atoms-vmpi::num_halo_atoms;
+   int num_tiled_atoms=0;
+   for(int atom=0;atom<num_local_atoms;atom++){
+
+      const int* c=&cs::unit_cell_index_array[4*atom];
+
+      int tile_id=0;
+      for(int d=0;d<3;d++) tile_id=tile_id*num_tiles[d]+vio::internal::positive_modulo(vio::internal::floor_division(c[d],n[d]),num_tiles[d]);
+
+      int site=0;
+      for(int d=0;d<3;d++) site=site*n[d]+vio::internal::positive_modulo(c[d]+tile_shift[3*tile_id+d],n[d]);
+      site=site*num_uc_atoms+c[3];
+
+      if(!tile_site[site]) continue;
+
+      const double sx=tile[3*site+0];
+      const double sy=tile[3*site+1];
+      const double sz=tile[3*site+2];
+      const double imodS=1.0/sqrt(sx*sx+sy*sy+sz*sz);
+      atoms::x_spin_array[atom]=sx*imodS;
+      atoms::y_spin_array[atom]=sy*imodS;
+      atoms::z_spin_array[atom]=sz*imodS;
+      num_tiled_atoms++;
+
+   }
+
+   #ifdef MPICF
+      MPI_Allreduce(MPI_IN_PLACE,&num_tiled_atoms,1,MPI_INT,MPI_SUM,MPI_COMM_WORLD);
+   #endif
+
+   zlog << zTs() << "Spins of " << num_tiled_atoms << " atoms initialised from " << n[0] << " x " << n[1] << " x " << n[2]
+        << " unit cell spin tile " << sim::spin_tile_file << " with " << num_tiles[0]*num_tiles[1]*num_tiles[2] << " tiles" << std::endl;
+
+   // release unit cell coordinates if no longer needed
+   if(!sim::save_spin_tile_flag && !sim::domain_wall_tracking) std::vector<int>().swap(cs::unit_cell_index_array);
+
+   return;
+
+}
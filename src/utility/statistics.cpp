@@ -59,6 +59,7 @@
 
 //Function prototypes
 int calculate_spin_fields(const int,const int);
+void pack_interleaved_spins(const int,const int);
 int calculate_external_fields(const int,const int);
 
 /// @namespace stats
@@ -268,6 +269,7 @@ double max_torque(){
 	// Recalculate net fields
 	//------------------------------------------------
 
+	pack_interleaved_spins(0,num_atoms);
 	calculate_spin_fields(0,num_atoms);
 	calculate_external_fields(0,num_atoms);
 		
@@ -314,6 +316,7 @@ void system_torque(){
 	double torque[3]={0.0,0.0,0.0};
 
 	// calculate net fields
+	pack_interleaved_spins(0,atoms::num_atoms);
 	calculate_spin_fields(0,atoms::num_atoms);
 	calculate_external_fields(0,atoms::num_atoms);
 		
@@ -439,6 +442,17 @@ void system_energy(){
       }
       stats::total_anisotropy_energy=energy;
    }
+   else if(sim::AnisotropyType==3){ // Local easy axes
+      double register energy=0.0;
+      for(int atom=0; atom<stats::num_atoms; atom++){
+         const double Sx=atoms::x_spin_array[atom];
+         const double Sy=atoms::y_spin_array[atom];
+         const double Sz=atoms::z_spin_array[atom];
+         const int imaterial=atoms::type_array[atom];
+         energy+=sim::spin_local_uniaxial_anisotropy_energy(atom, imaterial, Sx, Sy, Sz)*mp::material[imaterial].mu_s_SI;
+      }
+      stats::total_anisotropy_energy=energy;
+   }
    //------------------------------
    // Calculate other energy
    //------------------------------
@@ -460,7 +474,7 @@ void system_energy(){
          const double Sy=atoms::y_spin_array[atom];
          const double Sz=atoms::z_spin_array[atom];
          const int imaterial=atoms::type_array[atom];
-         energy+=sim::spin_second_order_uniaxial_anisotropy_energy(imaterial, Sx, Sy, Sz)*mp::material[imaterial].mu_s_SI;
+         energy+=sim::spin_second_order_uniaxial_anisotropy_energy(atom, imaterial, Sx, Sy, Sz)*mp::material[imaterial].mu_s_SI;
       }
       stats::total_so_anisotropy_energy=energy;
    }
@@ -471,7 +485,7 @@ void system_energy(){
          const double Sy=atoms::y_spin_array[atom];
          const double Sz=atoms::z_spin_array[atom];
          const int imaterial=atoms::type_array[atom];
-         energy+=sim::spin_lattice_anisotropy_energy(imaterial, Sx, Sy, Sz)*mp::material[imaterial].mu_s_SI;
+         energy+=sim::spin_lattice_anisotropy_energy(atom, imaterial, Sx, Sy, Sz)*mp::material[imaterial].mu_s_SI;
       }
       stats::total_lattice_anisotropy_energy=energy;
    }
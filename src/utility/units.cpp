@@ -58,7 +58,7 @@
 ///
 namespace units {
 	
-	const int max_units=43;
+	const int max_units=45;
 
 	const double pi=3.14;
 	//const double bohr_magneton=7.0;
@@ -145,6 +145,8 @@ int init(){
 		unit[40]="fs";			conversion[40]=1.0E-15;				type[40]="time"; // femtoseconds
 		unit[41]="as";			conversion[41]=1.0E-18;				type[41]="time"; // attoseconds
 		unit[42]="zs";			conversion[42]=1.0E-21;				type[42]="time"; // zeptoseconds
+		unit[43]="min";		conversion[43]=60.0;					type[43]="time"; // minutes
+		unit[44]="h";			conversion[44]=3600.0;				type[44]="time"; // hours
 
       // temperature C, F, K; angles degrees, rad, mrad;
 		// Set initialised flag
@@ -41,6 +41,7 @@
 ///
 
 // Standard Libraries
+#include <algorithm>
 #include <cmath>
 #include <cstdlib>
 #include <ctime>
@@ -82,11 +83,40 @@ namespace vout{
    int output_config_grain_rate=1000;
    int output_grains_file_counter=0;
 
+   bool atoms_coords_written=false;
+   bool cells_coords_written=false;
+
+   bool average_atoms_config=false;
+   bool average_cells_config=false;
+   bool output_config_variance=false;
+   int config_average_window=1000;
+   int config_average_sample_counter=0;
+   int output_average_file_counter=0;
+   double config_average_start_time=0.0;
+
+   // running sums of per-atom spins and per-cell moments over the averaging window
+   std::vector<double> atoms_x_sum(0);
+   std::vector<double> atoms_y_sum(0);
+   std::vector<double> atoms_z_sum(0);
+   std::vector<double> atoms_x_sq_sum(0);
+   std::vector<double> atoms_y_sq_sum(0);
+   std::vector<double> atoms_z_sq_sum(0);
+
+   std::vector<double> cells_x_sum(0);
+   std::vector<double> cells_y_sum(0);
+   std::vector<double> cells_z_sum(0);
+   std::vector<double> cells_x_sq_sum(0);
+   std::vector<double> cells_y_sq_sum(0);
+   std::vector<double> cells_z_sq_sum(0);
+
    // function headers
    void atoms();
    void atoms_coords();
    void cells();
    void cells_coords();
+   void accumulate_config_averages();
+   void atoms_average();
+   void cells_average();
 
 /// @brief Config master output function
 ///
@@ -111,16 +141,19 @@ void config(){
 
    // atoms output
    if((vout::output_atoms_config==true) && (vout::output_rate_counter%output_atoms_config_rate==0)){
-      if(output_atoms_file_counter==0) vout::atoms_coords();
+      if(atoms_coords_written==false) vout::atoms_coords();
       vout::atoms();
    }
 
    // cells output
    if((vout::output_cells_config==true) && (vout::output_rate_counter%output_cells_config_rate==0)){
-      if(output_cells_file_counter==0) vout::cells_coords();
+      if(cells_coords_written==false) vout::cells_coords();
       vout::cells();
    }
 
+   // time-averaged output
+   if(vout::average_atoms_config==true || vout::average_cells_config==true) vout::accumulate_config_averages();
+
    // increment rate counter
    vout::output_rate_counter++;
 
@@ -379,6 +412,8 @@ void config(){
 
       cfg_file_ofstr.close();
 
+      atoms_coords_written=true;
+
    }
 
 /// @brief Cell output function
@@ -568,6 +603,276 @@ void cells_coords(){
       cfg_file_ofstr.close();
    }
 
+   cells_coords_written=true;
+
+   return;
+
+}
+
+/// @brief Time-averaged configuration accumulator
+///
+/// @details Accumulates running sums of the local atomic spins and macrocell
+///          moments at every configuration output step. At the end of each
+///          averaging window the mean (and optionally variance) maps are written
+///          to disk once, avoiding the output of every instantaneous snapshot.
+///
+///=====================================================================================
+///
+void accumulate_config_averages(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true){std::cout << "vout::accumulate_config_averages has been called" << std::endl;}
+
+   // initialise accumulators at start of window
+   if(config_average_sample_counter==0){
+
+      config_average_start_time=double(sim::time)*mp::dt_SI;
+
+      if(vout::average_atoms_config==true){
+         // determine local output atom list and coordinates
+         if(atoms_coords_written==false) vout::atoms_coords();
+         const int num_output_atoms=vout::local_output_atom_list.size();
+         atoms_x_sum.assign(num_output_atoms,0.0);
+         atoms_y_sum.assign(num_output_atoms,0.0);
+         atoms_z_sum.assign(num_output_atoms,0.0);
+         if(vout::output_config_variance==true){
+            atoms_x_sq_sum.assign(num_output_atoms,0.0);
+            atoms_y_sq_sum.assign(num_output_atoms,0.0);
+            atoms_z_sq_sum.assign(num_output_atoms,0.0);
+         }
+      }
+
+      if(vout::average_cells_config==true){
+         if(cells_coords_written==false) vout::cells_coords();
+         cells_x_sum.assign(cells::num_cells,0.0);
+         cells_y_sum.assign(cells::num_cells,0.0);
+         cells_z_sum.assign(cells::num_cells,0.0);
+         if(vout::output_config_variance==true){
+            cells_x_sq_sum.assign(cells::num_cells,0.0);
+            cells_y_sq_sum.assign(cells::num_cells,0.0);
+            cells_z_sq_sum.assign(cells::num_cells,0.0);
+         }
+      }
+   }
+
+   // accumulate atomic spins
+   if(vout::average_atoms_config==true){
+      const int num_output_atoms=vout::local_output_atom_list.size();
+      for(int i=0; i<num_output_atoms; i++){
+         const int atom = vout::local_output_atom_list[i];
+         atoms_x_sum[i] += atoms::x_spin_array[atom];
+         atoms_y_sum[i] += atoms::y_spin_array[atom];
+         atoms_z_sum[i] += atoms::z_spin_array[atom];
+      }
+      if(vout::output_config_variance==true){
+         for(int i=0; i<num_output_atoms; i++){
+            const int atom = vout::local_output_atom_list[i];
+            const double sx = atoms::x_spin_array[atom];
+            const double sy = atoms::y_spin_array[atom];
+            const double sz = atoms::z_spin_array[atom];
+            atoms_x_sq_sum[i] += sx*sx;
+            atoms_y_sq_sum[i] += sy*sy;
+            atoms_z_sq_sum[i] += sz*sz;
+         }
+      }
+   }
+
+   // accumulate cell moments
+   if(vout::average_cells_config==true){
+      cells::mag();
+      for(int cell=0; cell<cells::num_cells; cell++){
+         cells_x_sum[cell] += cells::x_mag_array[cell];
+         cells_y_sum[cell] += cells::y_mag_array[cell];
+         cells_z_sum[cell] += cells::z_mag_array[cell];
+      }
+      if(vout::output_config_variance==true){
+         for(int cell=0; cell<cells::num_cells; cell++){
+            const double mx = cells::x_mag_array[cell];
+            const double my = cells::y_mag_array[cell];
+            const double mz = cells::z_mag_array[cell];
+            cells_x_sq_sum[cell] += mx*mx;
+            cells_y_sq_sum[cell] += my*my;
+            cells_z_sq_sum[cell] += mz*mz;
+         }
+      }
+   }
+
+   config_average_sample_counter++;
+
+   // output averages at end of window
+   if(config_average_sample_counter==vout::config_average_window){
+      if(vout::average_atoms_config==true) vout::atoms_average();
+      if(vout::average_cells_config==true) vout::cells_average();
+      config_average_sample_counter=0;
+      output_average_file_counter++;
+   }
+
+   return;
+
+}
+
+/// @brief Time-averaged atomistic output function
+///
+/// @details Outputs mean spin configuration over the averaging window. The
+///          header follows the atoms-*.cfg format with the window details
+///          appended. Each line contains the mean spin components
+///          $<sx> $<sy> $<sz>, followed by the variances of each component
+///          $var(sx) $var(sy) $var(sz) if config:output-variance is set.
+///
+///=====================================================================================
+///
+void atoms_average(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true){std::cout << "vout::atoms_average has been called" << std::endl;}
+
+   // Set local output filename
+   std::stringstream file_sstr;
+   file_sstr << "atoms-mean-";
+   // Set CPUID on non-root process
+   if(vmpi::my_rank!=0){
+      file_sstr << std::setfill('0') << std::setw(5) << vmpi::my_rank << "-";
+   }
+   file_sstr << std::setfill('0') << std::setw(8) << output_average_file_counter;
+   file_sstr << ".cfg";
+   std::string cfg_file = file_sstr.str();
+   const char* cfg_filec = cfg_file.c_str();
+
+   // Output informative message to log file
+   zlog << zTs() << "Outputting time-averaged configuration file " << cfg_file << " to disk" << std::endl;
+
+   // Declare and open output file
+   std::ofstream cfg_file_ofstr;
+   cfg_file_ofstr.open (cfg_filec);
+
+   // Output masterfile header on root process
+   if(vmpi::my_rank==0){
+      // Get system date
+      time_t rawtime = time(NULL);
+      struct tm * timeinfo = localtime(&rawtime);
+
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+      cfg_file_ofstr << "# Time-averaged atomistic spin configuration file for vampire"<< std::endl;
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+      cfg_file_ofstr << "# Date: "<< asctime(timeinfo);
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+      cfg_file_ofstr << "Number of spins: "<< vout::total_output_atoms << std::endl;
+      cfg_file_ofstr << "System dimensions:" << cs::system_dimensions[0] << "\t" << cs::system_dimensions[1] << "\t" << cs::system_dimensions[2] << std::endl;
+      cfg_file_ofstr << "Coordinates-file: atoms-coord.cfg"<< std::endl;
+      cfg_file_ofstr << "Time: " << double(sim::time)*mp::dt_SI << std::endl;
+      cfg_file_ofstr << "Field: " << sim::H_applied << std::endl;
+      cfg_file_ofstr << "Temperature: "<< sim::temperature << std::endl;
+      cfg_file_ofstr << "Magnetisation: " << stats::system_magnetization.output_normalized_magnetization() << std::endl;
+      cfg_file_ofstr << "Number of Materials: " << mp::num_materials << std::endl;
+      for(int mat=0;mat<mp::num_materials;mat++){
+         cfg_file_ofstr << mp::material[mat].mu_s_SI << std::endl;
+      }
+      cfg_file_ofstr << "Averaging start time: " << config_average_start_time << std::endl;
+      cfg_file_ofstr << "Averaging samples: " << config_average_sample_counter << std::endl;
+      cfg_file_ofstr << "Variance: " << vout::output_config_variance << std::endl;
+      cfg_file_ofstr << "#------------------------------------------------------" << std::endl;
+      cfg_file_ofstr << "Number of spin files: " << vmpi::num_processors-1 << std::endl;
+      for(int p=1;p<vmpi::num_processors;p++){
+         std::stringstream cfg_sstr;
+         cfg_sstr << "atoms-mean-" << std::setfill('0') << std::setw(5) << p << "-" << std::setfill('0') << std::setw(8) << output_average_file_counter << ".cfg";
+         cfg_file_ofstr << cfg_sstr.str() << std::endl;
+      }
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+   }
+
+   const double inv_n = 1.0/double(config_average_sample_counter);
+
+   // Everyone now outputs their averaged atom list
+   cfg_file_ofstr << vout::local_output_atom_list.size() << std::endl;
+   for(unsigned int i=0; i<vout::local_output_atom_list.size(); i++){
+      const double mx = atoms_x_sum[i]*inv_n;
+      const double my = atoms_y_sum[i]*inv_n;
+      const double mz = atoms_z_sum[i]*inv_n;
+      cfg_file_ofstr << mx << "\t" << my << "\t" << mz;
+      if(vout::output_config_variance==true){
+         cfg_file_ofstr << "\t" << std::max(0.0,atoms_x_sq_sum[i]*inv_n-mx*mx);
+         cfg_file_ofstr << "\t" << std::max(0.0,atoms_y_sq_sum[i]*inv_n-my*my);
+         cfg_file_ofstr << "\t" << std::max(0.0,atoms_z_sq_sum[i]*inv_n-mz*mz);
+      }
+      cfg_file_ofstr << std::endl;
+   }
+
+   cfg_file_ofstr.close();
+
+   return;
+
+}
+
+/// @brief Time-averaged cell output function
+///
+/// @details Outputs mean macrocell moments (J/T) over the averaging window in
+///          the cells-*.cfg format, followed by the variances of each component
+///          if config:output-variance is set.
+///
+///=====================================================================================
+///
+void cells_average(){
+
+   // check calling of routine if error checking is activated
+   if(err::check==true){std::cout << "vout::cells_average has been called" << std::endl;}
+
+   // Cell moments are reduced on all processors so only root outputs data
+   if(vmpi::my_rank==0){
+
+      // Set output filename
+      std::stringstream file_sstr;
+      file_sstr << "cells-mean-";
+      file_sstr << std::setfill('0') << std::setw(8) << output_average_file_counter;
+      file_sstr << ".cfg";
+      std::string cfg_file = file_sstr.str();
+      const char* cfg_filec = cfg_file.c_str();
+
+      zlog << zTs() << "Outputting time-averaged cell configuration " << output_average_file_counter << " to disk." << std::endl;
+
+      // Declare and open output file
+      std::ofstream cfg_file_ofstr;
+      cfg_file_ofstr.open (cfg_filec);
+
+      // Get system date
+      time_t rawtime = time(NULL);
+      struct tm * timeinfo = localtime(&rawtime);
+
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+      cfg_file_ofstr << "# Time-averaged cell configuration file for vampire"<< std::endl;
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+      cfg_file_ofstr << "# Date: "<< asctime(timeinfo);
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+      cfg_file_ofstr << "# Number of spins: "<< cells::num_cells << std::endl;
+      cfg_file_ofstr << "# System dimensions:" << cs::system_dimensions[0] << "\t" << cs::system_dimensions[1] << "\t" << cs::system_dimensions[2] << std::endl;
+      cfg_file_ofstr << "# Coordinates-file: cells-coord.cfg"<< std::endl;
+      cfg_file_ofstr << "# Time: " << double(sim::time)*mp::dt_SI << std::endl;
+      cfg_file_ofstr << "# Field: " << sim::H_applied << std::endl;
+      cfg_file_ofstr << "# Temperature: "<< sim::temperature << std::endl;
+      cfg_file_ofstr << "# Magnetisation: " << stats::system_magnetization.output_normalized_magnetization() << std::endl;
+      cfg_file_ofstr << "# Averaging start time: " << config_average_start_time << std::endl;
+      cfg_file_ofstr << "# Averaging samples: " << config_average_sample_counter << std::endl;
+      cfg_file_ofstr << "# Variance: " << vout::output_config_variance << std::endl;
+      cfg_file_ofstr << "#------------------------------------------------------"<< std::endl;
+
+      const double inv_n = 1.0/double(config_average_sample_counter);
+
+      for(int cell=0; cell < cells::num_cells; cell++){
+         const double mx = cells_x_sum[cell]*inv_n;
+         const double my = cells_y_sum[cell]*inv_n;
+         const double mz = cells_z_sum[cell]*inv_n;
+         cfg_file_ofstr << mx << "\t" << my << "\t" << mz;
+         if(vout::output_config_variance==true){
+            cfg_file_ofstr << "\t" << std::max(0.0,cells_x_sq_sum[cell]*inv_n-mx*mx);
+            cfg_file_ofstr << "\t" << std::max(0.0,cells_y_sq_sum[cell]*inv_n-my*my);
+            cfg_file_ofstr << "\t" << std::max(0.0,cells_z_sq_sum[cell]*inv_n-mz*mz);
+         }
+         cfg_file_ofstr << std::endl;
+      }
+
+      cfg_file_ofstr.close();
+
+   }
+
    return;
 
 }
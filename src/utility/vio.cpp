@@ -1513,6 +1513,22 @@ int match_sim(string const word, string const value, string const unit, int cons
          sim::program=14;
          return EXIT_SUCCESS;
       }
+      test="scaling-benchmark";
+      if(value==test){
+         sim::program=15;
+         return EXIT_SUCCESS;
+      }
+      test="forward-flux-sampling";
+      if(value==test){
+         sim::program=16;
+         stats::calculate_system_magnetization=true; // order parameter
+         return EXIT_SUCCESS;
+      }
+      test="spin-waves";
+      if(value==test){
+         sim::program=17;
+         return EXIT_SUCCESS;
+      }
       test="diagnostic-boltzmann";
       if(value==test){
          sim::program=50;
@@ -1532,6 +1548,9 @@ int match_sim(string const word, string const value, string const unit, int cons
          std::cerr << "\t\"hybrid-cmc\"" << std::endl;
          std::cerr << "\t\"reverse-hybrid-cmc\"" << std::endl;
          std::cerr << "\t\"localised-temperature-pulse\"" << std::endl;
+         std::cerr << "\t\"scaling-benchmark\"" << std::endl;
+         std::cerr << "\t\"forward-flux-sampling\"" << std::endl;
+         std::cerr << "\t\"spin-waves\"" << std::endl;
          terminaltextcolor(WHITE);
 		 err::vexit();
       }
@@ -1644,6 +1663,73 @@ int match_sim(string const word, string const value, string const unit, int cons
       return EXIT_SUCCESS;
    }
    //--------------------------------------------------------------------
+   test="equilibration-integrator";
+   if(word==test){
+      test="llg-heun";
+      if(value==test){
+         sim::equilibration_integrator=0;
+         return EXIT_SUCCESS;
+      }
+      test="llg-midpoint";
+      if(value==test){
+         sim::equilibration_integrator=2;
+         return EXIT_SUCCESS;
+      }
+      #ifndef MPICF
+      test="monte-carlo";
+      if(value==test){
+         sim::equilibration_integrator=1;
+         return EXIT_SUCCESS;
+      }
+      test="constrained-monte-carlo";
+      if(value==test){
+         sim::equilibration_integrator=3;
+         return EXIT_SUCCESS;
+      }
+      test="hybrid-constrained-monte-carlo";
+      if(value==test){
+         sim::equilibration_integrator=4;
+         return EXIT_SUCCESS;
+      }
+      #endif
+      terminaltextcolor(RED);
+      std::cerr << "Error - value for \'sim:" << word << "\' must be one of:" << std::endl;
+      std::cerr << "\t\"llg-heun\"" << std::endl;
+      std::cerr << "\t\"llg-midpoint\"" << std::endl;
+      #ifdef MPICF
+         std::cerr << "Monte Carlo integrators are unavailable for parallel execution" << std::endl;
+      #else
+         std::cerr << "\t\"monte-carlo\"" << std::endl;
+         std::cerr << "\t\"constrained-monte-carlo\"" << std::endl;
+         std::cerr << "\t\"hybrid-constrained-monte-carlo\"" << std::endl;
+      #endif
+      terminaltextcolor(WHITE);
+      err::vexit();
+   }
+   //--------------------------------------------------------------------
+   test="spin-transfer-torque-current-density";
+   if(word==test){
+      double j=atof(value.c_str());
+      check_for_valid_value(j, word, line, prefix, unit, "none", -1.0e15, 1.0e15,"input","-1e15 - 1e15 A/m^2");
+      sim::stt_current_density=j;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="domain-wall-moving-frame";
+   if(word==test){
+      sim::domain_wall_moving_frame=check_for_valid_bool(value, word, line, prefix,"input");
+      if(sim::domain_wall_moving_frame) sim::domain_wall_tracking=true;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="equilibration-tolerance";
+   if(word==test){
+      double et=atof(value.c_str());
+      check_for_valid_value(et, word, line, prefix, unit, "none", 0.0, 1.0,"input","0 - 1");
+      sim::equilibration_tolerance=et;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
    test="simulation-cycles";
    if(word==test){
       int r=atoi(value.c_str());
@@ -2090,6 +2176,205 @@ int match_sim(string const word, string const value, string const unit, int cons
          err::vexit();
       }
    }
+   //--------------------------------------------------------------------
+   test="monte-carlo-sweep-order";
+   if(word==test){
+      // include namesapce here to access enum values
+      using namespace sim;
+      test="random-sites";
+      if(value==test){
+         sim::mc_sweep_order=random_sites;
+         return EXIT_SUCCESS;
+      }
+      test="random-blocks";
+      if(value==test){
+         sim::mc_sweep_order=random_blocks;
+         return EXIT_SUCCESS;
+      }
+      test="checkerboard";
+      if(value==test){
+         sim::mc_sweep_order=checkerboard_blocks;
+         return EXIT_SUCCESS;
+      }
+      else{
+         terminaltextcolor(RED);
+         std::cerr << "Error - value for \'sim:" << word << "\' must be one of:" << std::endl;
+         std::cerr << "\t\"random-sites\"" << std::endl;
+         std::cerr << "\t\"random-blocks\"" << std::endl;
+         std::cerr << "\t\"checkerboard\"" << std::endl;
+         terminaltextcolor(WHITE);
+         err::vexit();
+      }
+   }
+   //-------------------------------------------------------------------
+   test="release-creation-arrays";
+   if(word==test){
+      sim::release_creation_arrays=true; // release creation-only atomic coordinates and category arrays after initialisation
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="spin-layout";
+   if(word==test){
+      test="separate";
+      if(value==test){
+         sim::interleaved_spin_layout=false; // separate x,y,z spin arrays
+         return EXIT_SUCCESS;
+      }
+      test="interleaved";
+      if(value==test){
+         sim::interleaved_spin_layout=true; // interleaved xyzw spin data
+         return EXIT_SUCCESS;
+      }
+      else{
+         terminaltextcolor(RED);
+         std::cerr << "Error - value for \'sim:" << word << "\' must be one of:" << std::endl;
+         std::cerr << "\t\"separate\"" << std::endl;
+         std::cerr << "\t\"interleaved\"" << std::endl;
+         terminaltextcolor(WHITE);
+         err::vexit();
+      }
+   }
+   //-------------------------------------------------------------------
+   test="buffered-thermal-noise";
+   if(word==test){
+      sim::buffered_thermal_noise=true; // use double buffered thermal noise
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="scaling-benchmark-mode";
+   if(word==test){
+      test="strong";
+      if(value==test){
+         sim::weak_scaling=false; // constant total system size
+         return EXIT_SUCCESS;
+      }
+      test="weak";
+      if(value==test){
+         sim::weak_scaling=true; // constant system size per processor
+         return EXIT_SUCCESS;
+      }
+      else{
+         terminaltextcolor(RED);
+         std::cerr << "Error - value for \'sim:" << word << "\' must be one of:" << std::endl;
+         std::cerr << "\t\"strong\"" << std::endl;
+         std::cerr << "\t\"weak\"" << std::endl;
+         terminaltextcolor(WHITE);
+         err::vexit();
+      }
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-basin-boundary";
+   if(word==test){
+      double l=atof(value.c_str());
+      check_for_valid_value(l, word, line, prefix, unit, "none", -1.0, 1.0,"input","-1 - 1");
+      sim::ffs_basin_boundary=l;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-first-interface";
+   if(word==test){
+      double l=atof(value.c_str());
+      check_for_valid_value(l, word, line, prefix, unit, "none", -1.0, 1.0,"input","-1 - 1");
+      sim::ffs_first_interface=l;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-last-interface";
+   if(word==test){
+      double l=atof(value.c_str());
+      check_for_valid_value(l, word, line, prefix, unit, "none", -1.0, 1.0,"input","-1 - 1");
+      sim::ffs_last_interface=l;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-interfaces";
+   if(word==test){
+      int n=atoi(value.c_str());
+      check_for_valid_int(n, word, line, prefix, 2, 1000,"input","2 - 1000");
+      sim::ffs_num_interfaces=n;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-configurations";
+   if(word==test){
+      int n=atoi(value.c_str());
+      check_for_valid_int(n, word, line, prefix, 1, 1000000,"input","1 - 1,000,000");
+      sim::ffs_num_configurations=n;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-trials";
+   if(word==test){
+      int n=atoi(value.c_str());
+      check_for_valid_int(n, word, line, prefix, 1, 1000000,"input","1 - 1,000,000");
+      sim::ffs_num_trials=n;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-maximum-trial-time-steps";
+   if(word==test){
+      int tt=atoi(value.c_str());
+      check_for_valid_int(tt, word, line, prefix, 1, 2000000000,"input","1 - 2,000,000,000");
+      sim::ffs_maximum_trial_time=tt;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="forward-flux-material";
+   if(word==test){
+      int mat=atoi(value.c_str());
+      check_for_valid_int(mat, word, line, prefix, 1, 100,"input","1 - 100");
+      sim::ffs_order_parameter_material=mat-1;
+      stats::calculate_material_magnetization=true; // order parameter
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="spin-wave-modes";
+   if(word==test){
+      int n=atoi(value.c_str());
+      check_for_valid_int(n, word, line, prefix, 1, 10000,"input","1 - 10,000");
+      sim::spin_wave_num_modes=n;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="spin-wave-lanczos-steps";
+   if(word==test){
+      int n=atoi(value.c_str());
+      check_for_valid_int(n, word, line, prefix, 1, 100000,"input","1 - 100,000");
+      sim::spin_wave_lanczos_steps=n;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="spin-wave-solver-tolerance";
+   if(word==test){
+      double t=atof(value.c_str());
+      check_for_valid_value(t, word, line, prefix, unit, "none", 1.0e-14, 1.0e-2,"input","1e-14 - 1e-2");
+      sim::spin_wave_tolerance=t;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="telemetry-rate";
+   if(word==test){
+      int tr=atoi(value.c_str());
+      check_for_valid_int(tr, word, line, prefix, 1, 2000000000,"input","1 - 2,000,000,000");
+      sim::telemetry=true;
+      sim::telemetry_rate=tr;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="telemetry-file";
+   if(word==test){
+      sim::telemetry=true;
+      sim::telemetry_file=value;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="walltime";
+   if(word==test){
+      double wt=atof(value.c_str());
+      check_for_valid_value(wt, word, line, prefix, unit, "time", 0.0, 1.0e9,"input","0 - 1e9 s");
+      sim::walltime=wt;
+      return EXIT_SUCCESS;
+   }
    //-------------------------------------------------------------------
    test="save-checkpoint";
    if(word==test){
@@ -2146,6 +2431,26 @@ int match_sim(string const word, string const value, string const unit, int cons
          err::vexit();
       }
    }
+   //-------------------------------------------------------------------
+   test="save-spin-tile";
+   if(word==test){
+      sim::save_spin_tile_flag=true; // Save spin tile at end of simulation
+      if(value.size()>0) sim::spin_tile_file=value;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="load-spin-tile";
+   if(word==test){
+      sim::load_spin_tile_flag=true; // Initialise spins from spin tile
+      if(value.size()>0) sim::spin_tile_file=value;
+      return EXIT_SUCCESS;
+   }
+   //-------------------------------------------------------------------
+   test="spin-tile-random-shift";
+   if(word==test){
+      sim::spin_tile_random_shift=check_for_valid_bool(value, word, line, prefix,"input");
+      return EXIT_SUCCESS;
+   }
    //--------------------------------------------------------------------
    else{
 	  terminaltextcolor(RED);
@@ -2238,6 +2543,32 @@ int match_config(string const word, string const value, int const line){
       vout::output_cells_config_rate=i;
       return EXIT_SUCCESS;
    }
+   //--------------------------------------------------------------------
+   test="atoms-average";
+   if(word==test){
+      vout::average_atoms_config=true;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="macro-cells-average";
+   if(word==test){
+      vout::average_cells_config=true;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="average-window";
+   if(word==test){
+      int i=atoi(value.c_str());
+      check_for_valid_int(i, word, line, prefix, 1, 1000000,"input","1 - 1,000,000");
+      vout::config_average_window=i;
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="output-variance";
+   if(word==test){
+      vout::output_config_variance=true;
+      return EXIT_SUCCESS;
+   }
    //-------------------------------------------------------------------
    test="identify-surface-atoms";
    if(word==test){
@@ -2580,6 +2911,83 @@ int match_vout_list(string const word, string const value, int const line, std::
       output_list.push_back(46);
       return EXIT_SUCCESS;
    }
+   //--------------------------------------------------------------------
+   test="topological-charge";
+   if(word==test){
+      stats::calculate_topological_charge=true;
+      output_list.push_back(48);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="mean-topological-charge";
+   if(word==test){
+      stats::calculate_topological_charge=true;
+      output_list.push_back(49);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="domain-wall-position";
+   if(word==test){
+      sim::domain_wall_tracking=true;
+      output_list.push_back(47);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="system-specific-heat";
+   if(word==test){
+      stats::calculate_system_energy=true;
+      output_list.push_back(50);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="material-specific-heat";
+   if(word==test){
+      stats::calculate_material_energy=true;
+      output_list.push_back(51);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="height-specific-heat";
+   if(word==test){
+      stats::calculate_height_energy=true;
+      output_list.push_back(52);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="material-height-specific-heat";
+   if(word==test){
+      stats::calculate_material_height_energy=true;
+      output_list.push_back(53);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="system-mean-energy";
+   if(word==test){
+      stats::calculate_system_energy=true;
+      output_list.push_back(54);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="material-mean-energy";
+   if(word==test){
+      stats::calculate_material_energy=true;
+      output_list.push_back(55);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="height-mean-energy";
+   if(word==test){
+      stats::calculate_height_energy=true;
+      output_list.push_back(56);
+      return EXIT_SUCCESS;
+   }
+   //--------------------------------------------------------------------
+   test="material-height-mean-energy";
+   if(word==test){
+      stats::calculate_material_height_energy=true;
+      output_list.push_back(57);
+      return EXIT_SUCCESS;
+   }
    //-------------------------------------------------------------------
    test="mpi-timings";
    if(word==test){
@@ -3082,6 +3490,39 @@ int match_material(string const word, string const value, string const unit, int
       }
       //------------------------------------------------------------
       else
+      test="uniaxial-anisotropy-direction-dispersion";
+      if(word==test){
+         double angle=atof(value.c_str());
+         check_for_valid_value(angle, word, line, prefix, unit, "none", 0.0, 180.0,"material","0.0 - 180.0 degrees");
+         read_material[super_index].UniaxialAnisotropyDispersion=angle*M_PI/180.0;
+         // Enable per-atom easy axes
+         sim::local_anisotropy_axis=true;
+         return EXIT_SUCCESS;
+      }
+      //------------------------------------------------------------
+      else
+      test="uniaxial-anisotropy-direction-dispersion-type";
+      if(word==test){
+         std::string grain="grain";
+         std::string atom="atom";
+         if(value==grain){
+            read_material[super_index].UniaxialAnisotropyDispersionPerGrain=true;
+            return EXIT_SUCCESS;
+         }
+         else if(value==atom){
+            read_material[super_index].UniaxialAnisotropyDispersionPerGrain=false;
+            return EXIT_SUCCESS;
+         }
+         else{
+            terminaltextcolor(RED);
+            std::cerr << "Error in input file - material[" << super_index+1 << "]:" << word << " must be either grain or atom" << std::endl;
+            terminaltextcolor(WHITE);
+            zlog << zTs() << "Error in input file - material[" << super_index+1 << "]:" << word << " must be either grain or atom" << std::endl;
+            return EXIT_FAILURE;
+         }
+      }
+      //------------------------------------------------------------
+      else
       test="uniaxial-anisotropy-tensor";
       if(word==test){
          std::vector<double> K;
@@ -3794,6 +4235,96 @@ int match_material(string const word, string const value, string const unit, int
          check_for_valid_value(Tc, word, line, prefix, unit, "none", 0.0, 10000.0,"material"," 0 - 10000 K");
          read_material[super_index].temperature_rescaling_Tc=Tc;
          return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="interaction-rescaling-curie-temperature";
+      if(word==test){
+         double Tc=atof(value.c_str());
+         check_for_valid_value(Tc, word, line, prefix, unit, "none", 0.0, 10000.0,"material"," 0 - 10000 K");
+         read_material[super_index].interaction_rescaling_Tc=Tc;
+         return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="interaction-rescaling-temperature-exponent";
+      if(word==test){
+         double a=atof(value.c_str());
+         check_for_valid_value(a, word, line, prefix, unit, "none", 0.01, 10.0,"material"," 0.01 - 10.0");
+         read_material[super_index].interaction_rescaling_temperature_exponent=a;
+         return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="interaction-rescaling-critical-exponent";
+      if(word==test){
+         double b=atof(value.c_str());
+         check_for_valid_value(b, word, line, prefix, unit, "none", 0.01, 10.0,"material"," 0.01 - 10.0");
+         read_material[super_index].interaction_rescaling_critical_exponent=b;
+         return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="exchange-rescaling-exponent";
+      if(word==test){
+         double exponent=atof(value.c_str());
+         check_for_valid_value(exponent, word, line, prefix, unit, "none", 0.0, 10.0,"material"," 0.0 - 10.0");
+         read_material[super_index].exchange_rescaling_exponent=exponent;
+         return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="anisotropy-rescaling-exponent";
+      if(word==test){
+         double exponent=atof(value.c_str());
+         check_for_valid_value(exponent, word, line, prefix, unit, "none", 0.0, 10.0,"material"," 0.0 - 10.0");
+         read_material[super_index].anisotropy_rescaling_exponent=exponent;
+         return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="spin-transfer-torque-efficiency";
+      if(word==test){
+         double eta=atof(value.c_str());
+         check_for_valid_value(eta, word, line, prefix, unit, "none", 0.0, 10.0,"material"," 0.0 - 10.0");
+         read_material[super_index].stt_efficiency=eta;
+         return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="spin-transfer-torque-field-like-ratio";
+      if(word==test){
+         double ratio=atof(value.c_str());
+         check_for_valid_value(ratio, word, line, prefix, unit, "none", -100.0, 100.0,"material"," -100.0 - 100.0");
+         read_material[super_index].stt_field_like_ratio=ratio;
+         return EXIT_SUCCESS;
+      }
+      //--------------------------------------------------------------------
+      else
+      test="spin-transfer-torque-polarization-unit-vector";
+      if(word==test){
+         std::vector<double> u(3);
+         u=DoublesFromString(value);
+         if(u.size()!=3){
+            terminaltextcolor(RED);
+            std::cerr << "Error in input file - material[" << super_index+1 << "]:"<< word << " must have three values." << std::endl;
+            terminaltextcolor(WHITE);
+            zlog << zTs() << "Error in input file - material[" << super_index+1 << "]:"<< word << " must have three values." << std::endl;
+            return EXIT_FAILURE;
+         }
+         double ULength=sqrt(u.at(0)*u.at(0)+u.at(1)*u.at(1)+u.at(2)*u.at(2));
+         if(ULength < 1.0e-9){
+            terminaltextcolor(RED);
+            std::cerr << "Error in input file - material[" << super_index+1 << "]:"<< word << " must be normalisable (possibly all zero)." << std::endl;
+            terminaltextcolor(WHITE);
+            zlog << zTs() << "Error in input file - material[" << super_index+1 << "]:"<< word << " must be normalisable (possibly all zero)." << std::endl;
+            return EXIT_FAILURE;
+         }
+         u.at(0)/=ULength;
+         u.at(1)/=ULength;
+         u.at(2)/=ULength;
+         read_material[super_index].stt_polarization_unit_vector=u;
+         return EXIT_SUCCESS;
       }
 		//--------------------------------------------------------------------
 		// keyword not found
@@ -4127,6 +4658,61 @@ namespace vout{
       stream << stats::material_height_magnetization.output_magnetization();
    }
 
+   // Output Function 47
+   void domain_wall_position(std::ostream& stream){
+      stream << sim::domain_wall_position << "\t";
+   }
+
+   // Output Function 48
+   void topological_charge(std::ostream& stream){
+      stream << stats::topological_charge.output_topological_charge();
+   }
+
+   // Output Function 49
+   void mean_topological_charge(std::ostream& stream){
+      stream << stats::topological_charge.output_mean_topological_charge();
+   }
+
+   // Output Function 50
+   void system_specific_heat(std::ostream& stream){
+      stream << stats::system_energy_statistic.output_specific_heat(sim::temperature);
+   }
+
+   // Output Function 51
+   void material_specific_heat(std::ostream& stream){
+      stream << stats::material_energy_statistic.output_specific_heat(sim::temperature);
+   }
+
+   // Output Function 52
+   void height_specific_heat(std::ostream& stream){
+      stream << stats::height_energy_statistic.output_specific_heat(sim::temperature);
+   }
+
+   // Output Function 53
+   void material_height_specific_heat(std::ostream& stream){
+      stream << stats::material_height_energy_statistic.output_specific_heat(sim::temperature);
+   }
+
+   // Output Function 54
+   void system_mean_energy(std::ostream& stream){
+      stream << stats::system_energy_statistic.output_mean_energy();
+   }
+
+   // Output Function 55
+   void material_mean_energy(std::ostream& stream){
+      stream << stats::material_energy_statistic.output_mean_energy();
+   }
+
+   // Output Function 56
+   void height_mean_energy(std::ostream& stream){
+      stream << stats::height_energy_statistic.output_mean_energy();
+   }
+
+   // Output Function 57
+   void material_height_mean_energy(std::ostream& stream){
+      stream << stats::material_height_energy_statistic.output_mean_energy();
+   }
+
    // Output Function 60
 	void MPITimings(std::ostream& stream){
 
@@ -4144,19 +4730,8 @@ namespace vout{
 		#ifdef MPICF
 		if(vmpi::DetailedMPITiming){
 
-			// Calculate Average times
-			MPI_Reduce (&vmpi::TotalComputeTime,&vmpi::AverageComputeTime,1,MPI_DOUBLE,MPI_SUM,0,MPI_COMM_WORLD); 
-			MPI_Reduce (&vmpi::TotalWaitTime,&vmpi::AverageWaitTime,1,MPI_DOUBLE,MPI_SUM,0,MPI_COMM_WORLD);
-			vmpi::AverageComputeTime/=double(vmpi::num_processors);
-			vmpi::AverageWaitTime/=double(vmpi::num_processors);
-			
-			// Calculate Maximum times
-			MPI_Reduce (&vmpi::TotalComputeTime,&vmpi::MaximumComputeTime,1,MPI_DOUBLE,MPI_MAX,0,MPI_COMM_WORLD);
-			MPI_Reduce (&vmpi::TotalWaitTime,&vmpi::MaximumWaitTime,1,MPI_DOUBLE,MPI_MAX,0,MPI_COMM_WORLD);
-
-			// Save times for timing matrix
-			vmpi::ComputeTimeArray.push_back(vmpi::TotalComputeTime);
-			vmpi::WaitTimeArray.push_back(vmpi::TotalWaitTime);
+			// Calculate average and maximum times and update timing statistics
+			vmpi::update_timing_statistics();
 
 			// reset until next data output
 			vmpi::TotalComputeTime=0.0;
@@ -4315,6 +4890,39 @@ namespace vout{
             case 46:
                vout::material_height_mvec_actual(zmag);
                break;
+            case 47:
+               vout::domain_wall_position(zmag);
+               break;
+            case 48:
+               vout::topological_charge(zmag);
+               break;
+            case 49:
+               vout::mean_topological_charge(zmag);
+               break;
+            case 50:
+               vout::system_specific_heat(zmag);
+               break;
+            case 51:
+               vout::material_specific_heat(zmag);
+               break;
+            case 52:
+               vout::height_specific_heat(zmag);
+               break;
+            case 53:
+               vout::material_height_specific_heat(zmag);
+               break;
+            case 54:
+               vout::system_mean_energy(zmag);
+               break;
+            case 55:
+               vout::material_mean_energy(zmag);
+               break;
+            case 56:
+               vout::height_mean_energy(zmag);
+               break;
+            case 57:
+               vout::material_height_mean_energy(zmag);
+               break;
             case 60:
 					vout::MPITimings(zmag);
 					break;
@@ -4452,6 +5060,39 @@ namespace vout{
             case 42:
                vout::mean_total_so_anisotropy_energy(std::cout);
                break;
+            case 47:
+               vout::domain_wall_position(std::cout);
+               break;
+            case 48:
+               vout::topological_charge(std::cout);
+               break;
+            case 49:
+               vout::mean_topological_charge(std::cout);
+               break;
+            case 50:
+               vout::system_specific_heat(std::cout);
+               break;
+            case 51:
+               vout::material_specific_heat(std::cout);
+               break;
+            case 52:
+               vout::height_specific_heat(std::cout);
+               break;
+            case 53:
+               vout::material_height_specific_heat(std::cout);
+               break;
+            case 54:
+               vout::system_mean_energy(std::cout);
+               break;
+            case 55:
+               vout::material_mean_energy(std::cout);
+               break;
+            case 56:
+               vout::height_mean_energy(std::cout);
+               break;
+            case 57:
+               vout::material_height_mean_energy(std::cout);
+               break;
             case 60:
 					vout::MPITimings(std::cout);
 					break;
@@ -1,9 +1,16 @@
 /// Program to convert vampire cfg files to rasmol format
 ///
-/// ./cfg2rasmol 
+/// ./cfg2rasmol [--xmin f --xmax f --ymin f --ymax f --zmin f --zmax f --every n]
+///
+/// Coordinate files are streamed in fixed size blocks and parsed with a fast
+/// numeric parser, and output is written in chunks of at most
+/// output_chunk_size bytes. Atoms may be selected by region (fraction of the system) and
+/// decimated to every n-th atom in the region. Without a selection the output
+/// is the same as the original converter.
 
 // Standard Libraries
 #include <cmath>
+#include <cstdio>
 #include <cstdlib>
 #include <ctime>
 #include <iomanip>
@@ -13,112 +20,55 @@
 #include <string>
 #include <vector>
 
+// cfg file reader
+#include "cfg_reader.hpp"
 
-int main(){
-	
-	std::vector <std::string> filenames(0);
-	
-	// open coordinate file
-	std::ifstream coord_file;
-	coord_file.open("atoms-coords.cfg");
-	
-	// check for open file
-	if(!coord_file.is_open()){
-		std::cerr << "Error! Coordinate file atoms-coords.cfg cannot be opened. Exiting" << std::endl;
-      exit(1);
-	}
-	
-	// read in file header
-	std::string dummy;
-	
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;
-
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;
-
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;
-
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;
+// Maximum size of formatted output held in memory before writing
+const size_t output_chunk_size = 1<<22;
 
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;
+int main(int argc, char* argv[]){
 
-	// get number of atoms
-	unsigned int n_atoms;
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;	
-	dummy.erase (dummy.begin(), dummy.begin()+17);
-	n_atoms=atoi(dummy.c_str());
+	// get atom selection from command line
+	cfg::selection_t selection;
+	if(!cfg::parse_selection(argc, argv, selection)) return 1;
 
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;
+	// read coordinates
+	cfg::coordinates_t coords;
+	if(!cfg::read_coordinates(coords)) exit(1);
 
-	// get number of subsidiary files
-	unsigned int n_files;
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;	
-	dummy.erase (dummy.begin(), dummy.begin()+22);
-	n_files=atoi(dummy.c_str());
+	// determine selected atoms
+	std::vector<char> selected;
+	const unsigned int n_selected = cfg::select_atoms(coords, selection, selected);
 
-	for(int file=0; file<n_files; file++){
-		getline(coord_file,dummy);
-		filenames.push_back(dummy);
-		//std::cout << filenames[file] << std::endl;
+	FILE* outfile = fopen("crystal.xyz", "wb");
+	if(outfile==NULL){
+		std::cerr << "Error! Output file crystal.xyz cannot be opened. Exiting" << std::endl;
+		exit(1);
 	}
 
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;
-
-	unsigned int n_local_atoms;
-	getline(coord_file,dummy);
-	//std::cout << dummy << std::endl;	
-	n_local_atoms=atoi(dummy.c_str());
-	
-	// Open output file
-	std::ofstream outfile;
-	outfile.open("crystal.xyz");
-	
 	// Output rasmol file header
-	outfile << n_atoms << std::endl << std::endl;
-	
-	double cx,cy,cz;
-	int mat, cat;
-	
-	std::string atom_type;
-	
-	//std::cout << "Outputting data to rasmol file" << std::endl;
-	
-	// finish reading master file coordinates
-	for(int i=0;i<n_local_atoms;i++){
-		coord_file >> mat >> cat >> cx >> cy >> cz >> atom_type;
-		outfile << atom_type << "\t" << cx << "\t" << cy << "\t" << cz << std::endl;
-	}
-	
-	// close master file
-	coord_file.close();
-	
-	// now read subsidiary files
-	for(int file=0; file<n_files; file++){
-		std::ifstream infile;
-		infile.open(filenames[file].c_str());
-		
-		// read number of atoms in this file
-		getline(infile,dummy);
-		n_local_atoms=atoi(dummy.c_str());
-		for(int i=0;i<n_local_atoms;i++){
-			infile >> mat >> cat >> cx >> cy >> cz >> atom_type;
-			outfile << atom_type << "\t" << cx << "\t" << cy << "\t" << cz << std::endl;
+	std::stringstream header;
+	header << n_selected << std::endl << std::endl;
+	std::string output = header.str();
+	output.reserve(output_chunk_size+512);
+
+	// Output atoms using printf formatting (%g) which matches the default ostream output
+	char line[256];
+	for(unsigned int atom=0; atom<coords.n_atoms; atom++){
+		if(!selected[atom]) continue;
+		int length = snprintf(line, sizeof(line), "%s\t%g\t%g\t%g\n",
+		                      coords.type_names[coords.type[atom]].c_str(), coords.cx[atom], coords.cy[atom], coords.cz[atom]);
+		output.append(line, length);
+		if(output.size()>=output_chunk_size){
+			fwrite(output.data(), 1, output.size(), outfile);
+			output.clear();
 		}
-		// close subsidiary file
-		infile.close();
 	}
-	
-	// close rasmol file
-	outfile.close();
-	
+
+	// write remaining output
+	fwrite(output.data(), 1, output.size(), outfile);
+	fclose(outfile);
+
 	// finished
 	return 0;
 
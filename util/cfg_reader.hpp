@@ -0,0 +1,359 @@
+/// Shared streaming reader for vampire cfg files used by the cfg2povray and
+/// cfg2rasmol converters.
+///
+/// Files are streamed through a fixed size block buffer and parsed with a
+/// light weight cursor using strtod/strtol, which is much faster than token
+/// parsing with ifstream >> for large (10^7 atom) configurations, while the
+/// memory used per open file is independent of the number of atoms. The
+/// reader also handles selection of atoms by region (as a fraction of the
+/// coordinate bounding box) and decimation (every n-th atom) from the command
+/// line:
+///
+///   --xmin f --xmax f --ymin f --ymax f --zmin f --zmax f --every n
+///
+
+#ifndef CFG_READER_H_
+#define CFG_READER_H_
+
+// Standard Libraries
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace cfg{
+
+// Size of file block buffer and maximum length of a line or number
+const size_t block_size = 1<<22;
+const size_t max_token_size = 4096;
+
+//------------------------------------------------------------------------------
+// Function to check if a file exists
+//------------------------------------------------------------------------------
+inline bool file_exists(const std::string& filename){
+
+	FILE* file = fopen(filename.c_str(), "rb");
+	if(file==NULL) return false;
+	fclose(file);
+	return true;
+
+}
+
+//------------------------------------------------------------------------------
+// Cursor for parsing a file streamed through a block buffer. The buffer is
+// refilled before each read so that at least max_token_size characters (or
+// the rest of the file) are available, and is always null terminated.
+//------------------------------------------------------------------------------
+class reader_t{
+
+	FILE* file;
+	std::vector<char> buffer;
+	char* p; // current position
+	char* end; // end of valid data
+
+	// disallow copying
+	reader_t(const reader_t&);
+	reader_t& operator=(const reader_t&);
+
+	void fill(){
+		if(file==NULL || size_t(end-p)>=max_token_size) return;
+		const size_t remaining = end-p;
+		memmove(&buffer[0], p, remaining);
+		const size_t nread = fread(&buffer[remaining], 1, block_size-remaining, file);
+		p = &buffer[0];
+		end = p+remaining+nread;
+		*end = '\0';
+		if(nread==0){
+			fclose(file);
+			file=NULL;
+		}
+	}
+
+public:
+
+	reader_t() : file(NULL), buffer(block_size+1,'\0'), p(&buffer[0]), end(&buffer[0]) {}
+
+	~reader_t(){
+		if(file!=NULL) fclose(file);
+	}
+
+	// open file for reading, returning false if the file cannot be opened
+	bool open(const std::string& filename){
+		if(file!=NULL) fclose(file);
+		file = fopen(filename.c_str(), "rb");
+		p = &buffer[0];
+		end = p;
+		*end = '\0';
+		return file!=NULL;
+	}
+
+	// read remainder of current line (without newline)
+	std::string line(){
+		fill();
+		char* start = p;
+		while(*p!='\0' && *p!='\n') p++;
+		std::string result(start, p);
+		if(*p=='\n') p++;
+		if(result.size()>0 && result[result.size()-1]=='\r') result.erase(result.size()-1);
+		return result;
+	}
+
+	// skip n lines
+	void skip_lines(int n){
+		for(int i=0; i<n; i++){
+			fill();
+			while(*p!='\0' && *p!='\n') p++;
+			if(*p=='\n') p++;
+		}
+	}
+
+	// read integer value after the ':' in a header line
+	int header_int(){
+		std::string l = line();
+		size_t colon = l.find(':');
+		return atoi(l.c_str()+(colon==std::string::npos ? 0 : colon+1));
+	}
+
+	// read whitespace separated values after the ':' in a header line
+	std::vector<double> header_doubles(){
+		std::string l = line();
+		size_t colon = l.find(':');
+		const char* q = l.c_str()+(colon==std::string::npos ? 0 : colon+1);
+		std::vector<double> values;
+		char* next;
+		for(double v=strtod(q,&next); next!=q; v=strtod(q,&next)){
+			values.push_back(v);
+			q = next;
+		}
+		return values;
+	}
+
+	// read next number
+	double get_double(){
+		fill();
+		char* next;
+		double v = strtod(p, &next);
+		p = next;
+		return v;
+	}
+
+	int get_int(){
+		fill();
+		char* next;
+		long v = strtol(p, &next, 10);
+		p = next;
+		return int(v);
+	}
+
+	// read next whitespace separated token
+	std::string get_token(){
+		fill();
+		while(*p==' ' || *p=='\t' || *p=='\n' || *p=='\r') p++;
+		char* start = p;
+		while(*p!='\0' && *p!=' ' && *p!='\t' && *p!='\n' && *p!='\r') p++;
+		return std::string(start, p);
+	}
+
+	// read integer on a line of its own
+	int line_int(){
+		return atoi(line().c_str());
+	}
+
+};
+
+//------------------------------------------------------------------------------
+// Atomic coordinates from atoms-coords*.cfg files
+//------------------------------------------------------------------------------
+struct coordinates_t{
+
+	unsigned int n_atoms;
+	std::vector <int> mat;
+	std::vector <int> cat;
+	std::vector <double> cx;
+	std::vector <double> cy;
+	std::vector <double> cz;
+	std::vector <int> type; // index into type_names
+	std::vector <std::string> type_names;
+
+};
+
+//------------------------------------------------------------------------------
+// Function to read atoms from a coordinate file block
+//------------------------------------------------------------------------------
+inline void read_coordinate_block(reader_t& reader, coordinates_t& coords, unsigned int& counter){
+
+	const int n_local_atoms = reader.line_int();
+
+	for(int i=0; i<n_local_atoms && counter<coords.n_atoms; i++){
+		coords.mat[counter] = reader.get_int();
+		coords.cat[counter] = reader.get_int();
+		coords.cx[counter] = reader.get_double();
+		coords.cy[counter] = reader.get_double();
+		coords.cz[counter] = reader.get_double();
+		const std::string type = reader.get_token();
+		// look up type name (small number of species)
+		unsigned int t=0;
+		while(t<coords.type_names.size() && coords.type_names[t]!=type) t++;
+		if(t==coords.type_names.size()) coords.type_names.push_back(type);
+		coords.type[counter] = t;
+		counter++;
+	}
+
+}
+
+//------------------------------------------------------------------------------
+// Function to read all atomic coordinates
+//------------------------------------------------------------------------------
+inline bool read_coordinates(coordinates_t& coords){
+
+	reader_t reader;
+	if(!reader.open("atoms-coords.cfg")){
+		std::cerr << "Error! Coordinate file atoms-coords.cfg cannot be opened. Exiting" << std::endl;
+		return false;
+	}
+
+	// read in file header
+	reader.skip_lines(5);
+	coords.n_atoms = reader.header_int();
+	reader.skip_lines(1);
+
+	// get names of subsidiary files
+	const int n_files = reader.header_int();
+	std::vector<std::string> filenames(n_files);
+	for(int file=0; file<n_files; file++) filenames[file] = reader.line();
+	reader.skip_lines(1);
+
+	// resize arrays
+	coords.mat.resize(coords.n_atoms);
+	coords.cat.resize(coords.n_atoms);
+	coords.cx.resize(coords.n_atoms);
+	coords.cy.resize(coords.n_atoms);
+	coords.cz.resize(coords.n_atoms);
+	coords.type.resize(coords.n_atoms);
+
+	unsigned int counter=0;
+
+	// read master file coordinates
+	read_coordinate_block(reader, coords, counter);
+
+	// now read subsidiary files
+	for(int file=0; file<n_files; file++){
+		if(!reader.open(filenames[file])){
+			std::cerr << "Error! Coordinate file " << filenames[file] << " cannot be opened. Exiting" << std::endl;
+			return false;
+		}
+		read_coordinate_block(reader, coords, counter);
+	}
+
+	// check for correct read in of coordinates
+	if(counter!=coords.n_atoms) std::cerr << "Error in reading in coordinates" << std::endl;
+
+	return true;
+
+}
+
+//------------------------------------------------------------------------------
+// Atom selection by region and decimation
+//------------------------------------------------------------------------------
+struct selection_t{
+
+	double min[3]; // fraction of coordinate bounding box
+	double max[3];
+	int every; // output every n-th atom
+
+	selection_t(){
+		for(int i=0; i<3; i++){
+			min[i]=0.0;
+			max[i]=1.0;
+		}
+		every=1;
+	}
+
+};
+
+//------------------------------------------------------------------------------
+// Function to parse selection from command line arguments
+//------------------------------------------------------------------------------
+inline bool parse_selection(int argc, char* argv[], selection_t& selection){
+
+	const char* names[6] = {"--xmin","--ymin","--zmin","--xmax","--ymax","--zmax"};
+
+	for(int arg=1; arg<argc; arg++){
+		const std::string option = argv[arg];
+		if(arg+1>=argc){
+			std::cerr << "Error! Missing value for option " << option << std::endl;
+			return false;
+		}
+		const char* value = argv[++arg];
+		bool found=false;
+		for(int i=0; i<6; i++){
+			if(option==names[i]){
+				if(i<3) selection.min[i] = atof(value);
+				else selection.max[i-3] = atof(value);
+				found=true;
+			}
+		}
+		if(option=="--every"){
+			selection.every = atoi(value);
+			if(selection.every<1) selection.every=1;
+			found=true;
+		}
+		if(!found){
+			std::cerr << "Error! Unknown option " << option << std::endl;
+			std::cerr << "Valid options are --xmin --xmax --ymin --ymax --zmin --zmax (fraction of system) and --every n" << std::endl;
+			return false;
+		}
+	}
+
+	return true;
+
+}
+
+//------------------------------------------------------------------------------
+// Function to determine selected atoms. Atoms within the region are numbered
+// in file order and every n-th is kept.
+//------------------------------------------------------------------------------
+inline unsigned int select_atoms(const coordinates_t& coords, const selection_t& selection, std::vector<char>& selected){
+
+	selected.assign(coords.n_atoms, 0);
+	if(coords.n_atoms==0) return 0;
+
+	// determine bounding box
+	double cmin[3] = {coords.cx[0], coords.cy[0], coords.cz[0]};
+	double cmax[3] = {coords.cx[0], coords.cy[0], coords.cz[0]};
+	for(unsigned int atom=0; atom<coords.n_atoms; atom++){
+		const double c[3] = {coords.cx[atom], coords.cy[atom], coords.cz[atom]};
+		for(int i=0; i<3; i++){
+			if(c[i]<cmin[i]) cmin[i]=c[i];
+			if(c[i]>cmax[i]) cmax[i]=c[i];
+		}
+	}
+
+	double lo[3], hi[3];
+	for(int i=0; i<3; i++){
+		lo[i] = cmin[i]+selection.min[i]*(cmax[i]-cmin[i]);
+		hi[i] = cmin[i]+selection.max[i]*(cmax[i]-cmin[i]);
+	}
+
+	unsigned int in_region=0;
+	unsigned int n_selected=0;
+	for(unsigned int atom=0; atom<coords.n_atoms; atom++){
+		const double c[3] = {coords.cx[atom], coords.cy[atom], coords.cz[atom]};
+		if(c[0]>=lo[0] && c[0]<=hi[0] && c[1]>=lo[1] && c[1]<=hi[1] && c[2]>=lo[2] && c[2]<=hi[2]){
+			if(in_region%selection.every==0){
+				selected[atom]=1;
+				n_selected++;
+			}
+			in_region++;
+		}
+	}
+
+	return n_selected;
+
+}
+
+} // end of namespace cfg
+
+#endif /*CFG_READER_H_*/
@@ -6,14 +6,23 @@
 //  creating the neighbourlist and populating atomic 
 //  properties for input into vampire
 //
+//  Interactions are found within a cutoff range using
+//  a cell list over arbitrary periodic image ranges,
+//  classified into symmetry equivalent shells (written
+//  to shells.txt) and assigned distance dependent
+//  exchange constants.
+//
 //  (C) R.F.L.Evans 22/04/2015
 //
 //
 //-------------------------------------------------------
+#include <algorithm>
 #include <string>
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <map>
+#include <utility>
 #include <vector>
 
 class uc_atom_t{
@@ -55,8 +64,223 @@ public:
   int dy;
   int dz;
   double Jij;
+  double r; // interaction distance (Angstroms)
+  int shell; // symmetry shell
 };
 
+enum jij_function_t { constant, shells, exponential, rkky };
+
+// integer division rounding towards minus infinity
+int floor_div(int a, int b){
+  return a>=0 ? a/b : -((-a+b-1)/b);
+}
+
+// ordering of interactions by atom i, image and atom j
+bool nn_order(const nn_t& a, const nn_t& b){
+  if(a.i!=b.i) return a.i<b.i;
+  if(a.dx!=b.dx) return a.dx<b.dx;
+  if(a.dy!=b.dy) return a.dy<b.dy;
+  if(a.dz!=b.dz) return a.dz<b.dz;
+  return a.j<b.j;
+}
+
+// ordering of shells by distance, then by first interaction
+bool shell_order(const std::pair<double,int>& a, const std::pair<double,int>& b){
+  if(fabs(a.first-b.first)>1.0e-6) return a.first<b.first;
+  return a.second<b.second;
+}
+
+// key for looking up interactions
+std::vector<int> interaction_key(int i, int j, int dx, int dy, int dz){
+  std::vector<int> key(5);
+  key[0]=i; key[1]=j; key[2]=dx; key[3]=dy; key[4]=dz;
+  return key;
+}
+
+// root of equivalence class with path compression
+int find_root(std::vector<int>& parent, int a){
+  while(parent[a]!=a){
+    parent[a]=parent[parent[a]];
+    a=parent[a];
+  }
+  return a;
+}
+
+//-----------------------------------------------------------------------
+//
+//  Function to find all interactions within range using a cell list
+//
+//  Atoms in the unit cell are binned into sub-cells no smaller than the
+//  interaction range (or one bin if the range exceeds the unit cell). Each
+//  atom searches the bins within range, with bins outside the unit cell
+//  mapped back to periodic images, so arbitrary image ranges are handled
+//  for long range (multiple shell) interactions.
+//
+//-----------------------------------------------------------------------
+void find_interactions(const std::vector<uc_atom_t>& unit_cell, const double unit_cell_size[3], const double range, std::vector<nn_t>& nn_list){
+
+  const double tolerance=1.0e-6;
+  const double range_sq=(range+tolerance)*(range+tolerance);
+
+  // determine bins
+  int nb[3];
+  int nr[3];
+  for(int d=0;d<3;d++){
+    nb[d]=std::max(1,int(floor(unit_cell_size[d]/range)));
+    nr[d]=int(ceil((range+tolerance)/(unit_cell_size[d]/double(nb[d]))));
+  }
+
+  std::vector<std::vector<int> > bins(nb[0]*nb[1]*nb[2]);
+  std::vector<int> atom_bin(3*unit_cell.size());
+  for(unsigned int a=0;a<unit_cell.size();a++){
+    const double c[3]={unit_cell[a].cx,unit_cell[a].cy,unit_cell[a].cz};
+    for(int d=0;d<3;d++) atom_bin[3*a+d]=std::min(nb[d]-1,std::max(0,int(floor(c[d]*nb[d]))));
+    bins[(atom_bin[3*a+0]*nb[1]+atom_bin[3*a+1])*nb[2]+atom_bin[3*a+2]].push_back(a);
+  }
+
+  // loop over all atoms in unit cell
+  for(unsigned int ai=0;ai<unit_cell.size();ai++){
+    for(int bx=atom_bin[3*ai+0]-nr[0]; bx<=atom_bin[3*ai+0]+nr[0]; bx++){
+      const int dx=floor_div(bx,nb[0]);
+      const int lx=bx-dx*nb[0];
+      for(int by=atom_bin[3*ai+1]-nr[1]; by<=atom_bin[3*ai+1]+nr[1]; by++){
+        const int dy=floor_div(by,nb[1]);
+        const int ly=by-dy*nb[1];
+        for(int bz=atom_bin[3*ai+2]-nr[2]; bz<=atom_bin[3*ai+2]+nr[2]; bz++){
+          const int dz=floor_div(bz,nb[2]);
+          const int lz=bz-dz*nb[2];
+          const std::vector<int>& bin=bins[(lx*nb[1]+ly)*nb[2]+lz];
+          for(unsigned int b=0;b<bin.size();b++){
+            const int aj=bin[b];
+            if(aj==int(ai) && dx==0 && dy==0 && dz==0) continue;
+            const double rx=(unit_cell[aj].cx+double(dx)-unit_cell[ai].cx)*unit_cell_size[0];
+            const double ry=(unit_cell[aj].cy+double(dy)-unit_cell[ai].cy)*unit_cell_size[1];
+            const double rz=(unit_cell[aj].cz+double(dz)-unit_cell[ai].cz)*unit_cell_size[2];
+            const double r_sq=rx*rx+ry*ry+rz*rz;
+            if(r_sq<=range_sq){
+              nn_t temp;
+              temp.i=ai;
+              temp.j=aj;
+              temp.dx=dx;
+              temp.dy=dy;
+              temp.dz=dz;
+              temp.Jij=0.0;
+              temp.r=sqrt(r_sq);
+              temp.shell=-1;
+              nn_list.push_back(temp);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  // sort interactions by atom i and image for reproducible output
+  std::sort(nn_list.begin(),nn_list.end(),nn_order);
+
+}
+
+//-----------------------------------------------------------------------
+//
+//  Function to classify interactions into shells of symmetry equivalent
+//  interactions. The point group operations of the (orthogonal) lattice
+//  are signed permutations of the axes, restricted to axes of equal length.
+//  An operation is a symmetry of the crystal if it maps every atom onto an
+//  atom of the same material (modulo lattice translations). Interactions
+//  mapped onto each other by a symmetry operation belong to the same shell.
+//  Shells are numbered in order of increasing distance.
+//
+//-----------------------------------------------------------------------
+int classify_shells(const std::vector<uc_atom_t>& unit_cell, const double unit_cell_size[3], std::vector<nn_t>& nn_list){
+
+  const double tolerance=1.0e-6;
+  const int num_atoms=unit_cell.size();
+
+  // index interactions by (i,j,dx,dy,dz)
+  std::map<std::vector<int>,int> index;
+  for(unsigned int nn=0; nn<nn_list.size(); nn++){
+    index[interaction_key(nn_list[nn].i,nn_list[nn].j,nn_list[nn].dx,nn_list[nn].dy,nn_list[nn].dz)]=nn;
+  }
+
+  // union-find of equivalent interactions
+  std::vector<int> parent(nn_list.size());
+  for(unsigned int nn=0; nn<nn_list.size(); nn++) parent[nn]=nn;
+
+  // loop over all signed permutations of axes
+  const int permutations[6][3]={{0,1,2},{0,2,1},{1,0,2},{1,2,0},{2,0,1},{2,1,0}};
+  for(int p=0;p<6;p++){
+
+    // permutation must preserve lattice
+    bool valid=true;
+    for(int d=0;d<3;d++) if(fabs(unit_cell_size[permutations[p][d]]-unit_cell_size[d])>tolerance) valid=false;
+    if(!valid) continue;
+
+    for(int signs=0;signs<8;signs++){
+
+      // rotation matrix R: (R r)[d] = sign[d]*r[perm[d]]
+      const int sign[3]={(signs&1) ? -1 : 1, (signs&2) ? -1 : 1, (signs&4) ? -1 : 1};
+
+      // map atoms: R r_k = r_map[k] + t_k
+      std::vector<int> map(num_atoms,-1);
+      std::vector<int> t(3*num_atoms,0);
+      for(int k=0;k<num_atoms && valid;k++){
+        const double r[3]={unit_cell[k].cx,unit_cell[k].cy,unit_cell[k].cz};
+        double rr[3];
+        for(int d=0;d<3;d++) rr[d]=sign[d]*r[permutations[p][d]];
+        for(int m=0;m<num_atoms;m++){
+          if(unit_cell[m].material!=unit_cell[k].material) continue;
+          const double rm[3]={unit_cell[m].cx,unit_cell[m].cy,unit_cell[m].cz};
+          int shift[3];
+          bool match=true;
+          for(int d=0;d<3;d++){
+            const double diff=rr[d]-rm[d];
+            shift[d]=int(floor(diff+0.5));
+            if(fabs(diff-double(shift[d]))>tolerance) match=false;
+          }
+          if(match){
+            map[k]=m;
+            for(int d=0;d<3;d++) t[3*k+d]=shift[d];
+            break;
+          }
+        }
+        if(map[k]<0) valid=false;
+      }
+      if(!valid){
+        valid=true;
+        continue;
+      }
+
+      // map interactions: n' = R n + t_j - t_i
+      for(unsigned int nn=0; nn<nn_list.size(); nn++){
+        const int i=nn_list[nn].i;
+        const int j=nn_list[nn].j;
+        const int n[3]={nn_list[nn].dx,nn_list[nn].dy,nn_list[nn].dz};
+        int np[3];
+        for(int d=0;d<3;d++) np[d]=sign[d]*n[permutations[p][d]]+t[3*j+d]-t[3*i+d];
+        std::map<std::vector<int>,int>::iterator it=index.find(interaction_key(map[i],map[j],np[0],np[1],np[2]));
+        if(it!=index.end()){
+          int a=find_root(parent,nn);
+          int b=find_root(parent,it->second);
+          if(a!=b) parent[std::max(a,b)]=std::min(a,b);
+        }
+      }
+    }
+  }
+
+  // order shells by distance
+  std::vector<std::pair<double,int> > roots;
+  for(unsigned int nn=0; nn<nn_list.size(); nn++){
+    if(find_root(parent,nn)==int(nn)) roots.push_back(std::pair<double,int>(nn_list[nn].r,nn));
+  }
+  std::sort(roots.begin(),roots.end(),shell_order);
+  std::map<int,int> shell_id;
+  for(unsigned int s=0; s<roots.size(); s++) shell_id[roots[s].second]=s;
+  for(unsigned int nn=0; nn<nn_list.size(); nn++) nn_list[nn].shell=shell_id[find_root(parent,nn)];
+
+  return roots.size();
+
+}
+
 int main(){
 
   // system constants
@@ -128,80 +352,80 @@ int main(){
   unit_cell.at(3).hc=1;
   unit_cell.at(3).lc=0;
   
-  // store vector of unit cells
-  std::vector< std::vector < std::vector < std::vector<uc_atom_t > > > >crystal;
-  
-  crystal.resize(3);
-  for(int i=0;i<3;i++){
-    crystal.at(i).resize(3);
-    for(int j=0;j<3;j++){
-      crystal.at(i).at(j).resize(3);
-      for(int k=0;k<3;k++){
-	crystal.at(i).at(j).at(k).resize(unit_cell.size());
-      }
+  //---------------------------------------------------------------------
+  // Interaction parameters
+  //---------------------------------------------------------------------
+  // interaction range (Angstroms) - includes all shells within range
+  const double interaction_range=sqrt(0.5*0.5+0.5*0.5)*unit_cell_size[0];
+
+  // distance dependence of exchange, scaling the material pair constant J0
+  //    constant:    J = J0 for all interactions in range
+  //    shells:      J = J0 * shell_exchange_scaling[shell] for symmetry shell
+  //    exponential: J = J0 * exp(-(r-r_nn)/exchange_decay_length)
+  //    rkky:        J = J0 * (r_nn/r)^3 * cos(2 kF (r - r_nn))
+  const jij_function_t jij_function=constant;
+  std::vector<double> shell_exchange_scaling(1,1.0); // scaling for shells 0,1,2... (missing shells are ignored)
+  const double exchange_decay_length=1.0; // Angstroms
+  const double fermi_wavevector=1.0; // 1/Angstroms
+
+  // create neighbour list within interaction range
+  std::vector<nn_t> nn_list;
+  find_interactions(unit_cell, unit_cell_size, interaction_range, nn_list);
+
+  // classify interactions into symmetry equivalent shells
+  const int num_shells=classify_shells(unit_cell, unit_cell_size, nn_list);
+
+  // nearest neighbour distance
+  double r_nn=interaction_range;
+  for(unsigned int nn=0; nn<nn_list.size(); nn++) r_nn=std::min(r_nn,nn_list[nn].r);
+
+  // set exchange constants
+  std::vector<nn_t> interactions;
+  for(unsigned int nn=0; nn<nn_list.size(); nn++){
+    const int imat=unit_cell.at(nn_list[nn].i).material;
+    const int jmat=unit_cell.at(nn_list[nn].j).material;
+    const double J0=exchange_constants.at(imat).at(jmat);
+    const double r=nn_list[nn].r;
+    double Jij=0.0;
+    switch(jij_function){
+      case constant:
+        Jij=J0;
+        break;
+      case shells:
+        if(nn_list[nn].shell<int(shell_exchange_scaling.size())) Jij=J0*shell_exchange_scaling[nn_list[nn].shell];
+        break;
+      case exponential:
+        Jij=J0*exp(-(r-r_nn)/exchange_decay_length);
+        break;
+      case rkky:
+        Jij=J0*(r_nn/r)*(r_nn/r)*(r_nn/r)*cos(2.0*fermi_wavevector*(r-r_nn));
+        break;
     }
-  }
-    
-  // replicate unit cell
-  for(int i=0;i<3;i++){
-    for(int j=0;j<3;j++){
-      for(int k=0;k<3;k++){
-	for(int a=0;a<unit_cell.size();a++){
-	  crystal.at(i).at(j).at(k).at(a).cx=unit_cell.at(a).cx+double(i);
-          crystal.at(i).at(j).at(k).at(a).cy=unit_cell.at(a).cy+double(j);
-	  crystal.at(i).at(j).at(k).at(a).cz=unit_cell.at(a).cz+double(k);
-	  crystal.at(i).at(j).at(k).at(a).material=unit_cell.at(a).material;
-	  crystal.at(i).at(j).at(k).at(a).hc=unit_cell.at(a).hc+2*k-2;
-          crystal.at(i).at(j).at(k).at(a).lc=unit_cell.at(a).lc;	  
-	}
-      }
+    if(Jij!=0.0){
+      nn_list[nn].Jij=Jij;
+      interactions.push_back(nn_list[nn]);
     }
   }
+  nn_list.swap(interactions);
 
-  // create neighbour list
-  double nn_range=0.5*0.5+0.5*0.5;
-  std::vector<nn_t> nn_list;
-
-  // loop over all atoms in unit cell
-  for(int ai=0;ai<unit_cell.size();ai++){
-    double icx=crystal[1][1][1].at(ai).cx;
-    double icy=crystal[1][1][1].at(ai).cy;
-    double icz=crystal[1][1][1].at(ai).cz;
-    int imat=crystal[1][1][1].at(ai).material;
-    int ihc=crystal[1][1][1].at(ai).hc;
-    int ilc=crystal[1][1][1].at(ai).lc;
-
-    // loop over all other atoms
-    for(int i=0;i<3;i++){
-      for(int j=0;j<3;j++){
-	for(int k=0;k<3;k++){
-	  for(int aj=0;aj<unit_cell.size();aj++){
-	    double jcx=crystal[i][j][k].at(aj).cx;
-	    double jcy=crystal[i][j][k].at(aj).cy;
-	    double jcz=crystal[i][j][k].at(aj).cz;
-	    int jmat=crystal[i][j][k].at(aj).material;
-	    int jhc=crystal[i][j][k].at(aj).hc;
-	    int jlc=crystal[i][j][k].at(aj).lc;
-	    double range_sq=(jcx-icx)*(jcx-icx)+(jcy-icy)*(jcy-icy)+(jcz-icz)*(jcz-icz);
-	    bool same_atom=(ai==aj && i==1 && j==1 && k==1);
-	    if(range_sq<=nn_range && same_atom==false){
-	      nn_t temp;
-	      temp.i=ai;
-	      temp.j=aj;
-	      temp.dx=i-1;
-	      temp.dy=j-1;
-	      temp.dz=k-1;
-	      temp.Jij=exchange_constants.at(imat).at(jmat);
-	      nn_list.push_back(temp);
-	      //std::cout << ai << "\t" << aj << "\t" << i-1 << "\t" << j-1 << "\t" << k-1 << "\t" << sqrt(range_sq) << std::endl;
-	    } 
-	  }
-	}
+  // output shell summary
+  std::ofstream shell_file;
+  shell_file.open ("shells.txt");
+  shell_file << "# shell\tdistance (A)\tnum interactions\trepresentative i j dx dy dz" << std::endl;
+  for(int shell=0; shell<num_shells; shell++){
+    int count=0;
+    int rep=-1;
+    for(unsigned int nn=0; nn<nn_list.size(); nn++){
+      if(nn_list[nn].shell==shell){
+        if(rep<0) rep=nn;
+        count++;
       }
     }
-
+    if(rep<0) continue;
+    shell_file << shell << "\t" << nn_list[rep].r << "\t" << count << "\t" << nn_list[rep].i << "\t" << nn_list[rep].j << "\t";
+    shell_file << nn_list[rep].dx << "\t" << nn_list[rep].dy << "\t" << nn_list[rep].dz << std::endl;
   }
-
+  shell_file.close();
 
   // output to files
   // declare outfile file stream